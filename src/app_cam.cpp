@@ -6,6 +6,8 @@ CLAppCam::CLAppCam() {
 
 
 int CLAppCam::start() {
+    if(!fb_mutex) fb_mutex = xSemaphoreCreateMutex();
+
     // Populate camera config structure with hardware and other defaults
     config.ledc_channel = LEDC_CHANNEL_0;
     config.ledc_timer = LEDC_TIMER_0;
@@ -51,24 +53,25 @@ int CLAppCam::start() {
         sensor = esp_camera_sensor_get();
 
         // Dump camera module, warn for unsupported modules.
+        const char *model;
         switch (sensor->id.PID) {
             case OV9650_PID: 
-                Serial.print("OV9650");  
+                model = "OV9650";  
                 break;
             case OV7725_PID: 
-                Serial.print("OV7725"); 
+                model = "OV7725"; 
                 break;
             case OV2640_PID: 
-                Serial.print("OV2640"); 
+                model = "OV2640"; 
                 break;
             case OV3660_PID: 
-                Serial.print("OV3660"); 
+                model = "OV3660"; 
                 break;
             default: 
-                Serial.print("UNKNOWN");
+                model = "UNKNOWN";
                 break;
         }
-        Serial.println(" camera module detected");
+        Log.info("%s camera module detected", model);
 
     }
 
@@ -76,7 +79,7 @@ int CLAppCam::start() {
 }
 
 int CLAppCam::stop() {
-    Serial.println("Stopping Camera");
+    Log.info("Stopping Camera");
     return esp_camera_deinit();
 }
 
@@ -129,20 +132,21 @@ int CLAppCam::loadPrefs() {
         
     }
     else {
-        Serial.println("Failed to get camera handle. Camera settings skipped");
+        Log.error("Failed to get camera handle. Camera settings skipped");
     }
 
     return ret;
 }
 
 int CLAppCam::savePrefs(){
+    TRACE_SCOPE("prefs_save");
     JsonDocument json;
     char* prefs_file = getPrefsFileName(true); 
 
     if (Storage.exists(prefs_file)) {
-        Serial.printf("Updating %s\r\n", prefs_file); 
+        Log.info("Updating %s", prefs_file); 
     } else {
-        Serial.printf("Creating %s\r\n", prefs_file);
+        Log.info("Creating %s", prefs_file);
     }
 
     dumpStatusToJson(json);
@@ -150,31 +154,42 @@ int CLAppCam::savePrefs(){
     File file = Storage.open(prefs_file, FILE_WRITE);
     if(file) {
         serializeJson(json, file);
-        serializeJsonPretty(json, Serial);
-        Serial.println();
-        
         file.close();
-        Serial.printf("File %s updated\r\n", prefs_file);
+        Log.info("File %s updated", prefs_file);
+        Log.json(LOG_LEVEL_DEBUG, "Config: ", json);
         
         return OK;
     }
     else {
-        Serial.printf("Failed to save camery preferences to file %s\r\n", prefs_file);
+        Log.error("Failed to save camery preferences to file %s", prefs_file);
         return FAIL;
     }
 
 }
 
-int IRAM_ATTR CLAppCam::snapToBuffer() {
+int IRAM_ATTR CLAppCam::snapToBuffer(TickType_t wait) {
+    if(!fb_mutex) return ESP_FAIL;
+    if(xSemaphoreTake(fb_mutex, wait) != pdTRUE) return ESP_ERR_TIMEOUT;
+
+    TRACE_SCOPE("capture");
+    int64_t start = esp_timer_get_time();
     fb = esp_camera_fb_get();
+    Metrics.fb_get_us.observe((uint32_t)(esp_timer_get_time() - start));
+    if(fb) {
+        Metrics.frames_captured.inc();
+        Metrics.jpeg_bytes.observe(fb->len);
+        return ESP_OK;
+    }
 
-    return (fb?ESP_OK:ESP_FAIL);
+    xSemaphoreGive(fb_mutex);
+    return ESP_FAIL;
 }
 
 void IRAM_ATTR CLAppCam::releaseBuffer() {
     if(fb) {
         esp_camera_fb_return(fb);
         fb = NULL;
+        xSemaphoreGive(fb_mutex);
     }
 }
 
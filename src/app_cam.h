@@ -4,12 +4,14 @@
 #define CAM_DUMP_BUFFER_SIZE   1024
 
 #include <esp_camera.h>
+#include <freertos/semphr.h>
 #include <esp_int_wdt.h>
 #include <esp_task_wdt.h>
 #include <ArduinoJson.h>
 
 #include "app_component.h"
 #include "camera_pins.h"
+#include "metrics.h"
 
 
 /**
@@ -39,7 +41,9 @@ class CLAppCam : public CLAppComponent {
         void setRotation(int val) {myRotation = val;};
         int getRotation() {return myRotation;};
 
-        int snapToBuffer();
+        // takes a frame; the snap timer, the still requests and the triggers share the single buffer, so it is
+        // held until releaseBuffer(). Returns ESP_ERR_TIMEOUT if another task still holds it after the wait
+        int snapToBuffer(TickType_t wait = portMAX_DELAY);
         uint8_t * IRAM_ATTR getBuffer() {return (fb?fb->buf:nullptr);};
         size_t IRAM_ATTR getBufferSize() {return (fb?fb->len:0);};
         bool IRAM_ATTR isJPEGinBuffer() {return (fb?fb->format == PIXFORMAT_JPEG:false);};
@@ -77,6 +81,7 @@ class CLAppCam : public CLAppComponent {
 
         // camera buffer pointer
         camera_fb_t * fb = NULL;
+        SemaphoreHandle_t fb_mutex = NULL;
 
         // camera sensor
         sensor_t * sensor;
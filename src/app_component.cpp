@@ -7,7 +7,7 @@ char * CLAppComponent::getPrefsFileName(bool forsave) {
         if(configured || forsave)
             return prefs;
         else {
-            Serial.printf("Pref file %s not found, falling back to default\r\n", prefs);
+            Log.info("Pref file %s not found, falling back to default", prefs);
             if(prefix)
               snprintf(prefs, TAG_LENGTH, "/%s_%s.json", prefix, tag);
             else
@@ -23,10 +23,10 @@ void CLAppComponent::dumpPrefs() {
     char *prefs_file = getPrefsFileName(); 
     String s;
     if(Storage.readFileToString(prefs_file, &s) != OK) {
-        Serial.printf("Preference file %s not found.\r\n", prefs_file);
+        Log.warn("Preference file %s not found.", prefs_file);
         return;
     }
-    Serial.println(s);
+    Log.raw(s.c_str());
 }
 
 int CLAppComponent::readJsonIntVal(jparse_ctx_t *jctx_ptr, const char* token) {
@@ -43,51 +43,51 @@ int CLAppComponent::readJsonIntVal(jparse_ctx_t *jctx_ptr, const char* token) {
 int CLAppComponent::removePrefs() {
   char *prefs_file = getPrefsFileName(true);  
   if (Storage.exists(prefs_file)) {
-    Serial.printf("Removing %s\r\n", prefs_file);
+    Log.info("Removing %s", prefs_file);
     if (!Storage.remove(prefs_file)) {
-      Serial.printf("Error removing %s preferences\r\n", tag);
+      Log.error("Error removing %s preferences", tag);
       return OS_FAIL;
     }
   } else {
-    Serial.printf("No saved %s preferences to remove\r\n", tag);
+    Log.info("No saved %s preferences to remove", tag);
   }
   return OS_SUCCESS;
 }
 
 int CLAppComponent::parsePrefs(JsonDocument& json) {
+  TRACE_SCOPE("prefs_load");
   char* conn_file = getPrefsFileName();
   
   if (Storage.exists(conn_file)) {
     //file exists, reading and loading
-    Serial.printf("Open config file %s \r\n", conn_file);
+    Log.info("Open config file %s", conn_file);
     
     File configFile = Storage.open(conn_file);
     if (configFile) {
-      Serial.printf("Config file %s opened \r\n", conn_file);
-      
       DeserializationError error = deserializeJson(json, configFile);
       
       if (!error) {
-        serializeJsonPretty(json, Serial);
-        Serial.println();
+        if(log_prefs) Log.json(LOG_LEVEL_DEBUG, "Config: ", json);
         return OS_SUCCESS;
       }
+      Log.error("Config file %s could not be parsed: %s", conn_file, error.c_str());
     } else {
-      Serial.printf("Failed to open the connection settings from %s \r\n", conn_file);
+      Log.error("Failed to open the connection settings from %s", conn_file);
     }
   } else {
-    Serial.printf("Preference file %s not exists.\r\n", conn_file);
+    Log.warn("Preference file %s not exists.", conn_file);
   }
   return OS_FAIL;
 }
 
 int CLAppComponent::parsePrefs(jparse_ctx_t *jctx) {
+  TRACE_SCOPE("prefs_load");
   char *conn_file = getPrefsFileName(); 
 
   String conn_json;
 
   if(Storage.readFileToString(conn_file, &conn_json) != OK) {
-      Serial.printf("Failed to open the connection settings from %s \r\n", conn_file);
+      Log.error("Failed to open the connection settings from %s", conn_file);
       return OS_FAIL;
   }
 
@@ -95,7 +95,7 @@ int CLAppComponent::parsePrefs(jparse_ctx_t *jctx) {
 
   int ret = json_parse_start(jctx, cn_ptr, conn_json.length());
   if(ret != OS_SUCCESS) {
-      Serial.printf("Preference file %s could not be parsed; using system defaults.\r\n", conn_file);
+      Log.error("Preference file %s could not be parsed; using system defaults.", conn_file);
       return OS_FAIL;
   }
 
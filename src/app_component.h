@@ -12,6 +12,8 @@
 #endif
 
 #include "storage.h"
+#include "trace.h"
+#include "logger.h"
 
 #define TAG_LENGTH 32
 
@@ -43,6 +45,9 @@ class CLAppComponent {
         void setTag(const char *t) {tag = t;};
         void setPrefix(const char *p) {prefix = p;};
 
+        /// @brief whether the loaded preferences are written to the log (disable if they contain secrets)
+        void setLogPrefs(bool val) {log_prefs = val;};
+
         void setErr(int err_code) {last_err = err_code;};
 
         /// @brief reads the Int value from JSON context by token. 
@@ -71,6 +76,8 @@ class CLAppComponent {
 
         bool debug_mode = false;
 
+        bool log_prefs = true;
+
         // error code of the last error
         int last_err = 0;
 
@@ -25,6 +25,13 @@
 // Uncomment to disable the notification LED on the module
 // #define LED_DISABLE
 
+// Uncomment to record a timeline of the frames and requests into a PSRAM ring buffer. 
+// The timeline can be downloaded from /trace and opened in chrome://tracing or Perfetto.
+// #define ENABLE_TRACE
+
+// Number of events kept by the tracer
+#define TRACE_BUFFER_EVENTS 4096
+
 // Uncomment this line to use LittleFS instead of SD. 
 // --> to defined in platformio.ini
 
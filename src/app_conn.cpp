@@ -2,17 +2,30 @@
 
 CLAppConn::CLAppConn() {
     setTag("conn");
+    // the connection settings contain the WiFi passwords
+    setLogPrefs(false);
 }
 
+// last good connection; survives the software resets, but not the power cycles (then the copy in NVS is used)
+RTC_NOINIT_ATTR WiFiCache rtc_wifi_cache;
+
+static const char * conn_state_names[CONN_STATE_COUNT] = {"idle", "scanning", "connecting", "connected", 
+                                                           "access_point", "wait_retry", "roaming"};
+
 int CLAppConn::start() {
 
-    stationList = new Station[MAX_KNOWN_STATIONS];
+    if(!stationList) stationList = new Station[MAX_KNOWN_STATIONS];
 
     if(loadPrefs() != OK) {
         return WiFi.status();
     }
     
-    Serial.println("Starting WiFi");
+    Log.info("Starting WiFi");
+
+    if(!events_registered) {
+        WiFi.onEvent(onWiFiEvent);
+        events_registered = true;
+    }
 
     WiFi.setHostname(this->mdnsName.c_str());
     
@@ -24,151 +37,474 @@ int CLAppConn::start() {
     
     byte mac[6] = {0,0,0,0,0,0};
     WiFi.macAddress(mac);
-    Serial.printf("MAC address: %02X:%02X:%02X:%02X:%02X:%02X\r\n", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-
-    int bestStation = -1;
-    long bestRSSI = -1024;
-    char bestSSID[65] = "";
-    uint8_t bestBSSID[6];
+    Log.info("MAC address: %02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
 
     accesspoint = load_as_ap;
 
-    if (!accesspoint) {
-        if(stationCount > 0) {
-            // We have a list to scan
-            Serial.println("Scanning local Wifi Networks");
-            int stationsFound = WiFi.scanNetworks();
-            Serial.printf("%i networks found\r\n", stationsFound);
-            if (stationsFound > 0) {
-                for (int i = 0; i < stationsFound; ++i) {
-                    // Print SSID and RSSI for each network found
-                    String thisSSID = WiFi.SSID(i);
-                    int thisRSSI = WiFi.RSSI(i);
-                    String thisBSSID = WiFi.BSSIDstr(i);
-                    Serial.printf("%3i : [%s] %s (%i)", i + 1, thisBSSID.c_str(), thisSSID.c_str(), thisRSSI);
-                    // Scan our list of known external stations
-                    for (int sta = 0; sta < stationCount; sta++) {
-                        if (stationList[sta].ssid == thisSSID ||
-                        stationList[sta].ssid == thisBSSID) {
-                            Serial.print("  -  Known!");
-                            // Chose the strongest RSSI seen
-                            if (thisRSSI > bestRSSI) {
-                                bestStation = sta;
-                                strncpy(bestSSID, thisSSID.c_str(), 64);
-                                // Convert char bssid[] to a byte array
-                                parseBytes(thisBSSID.c_str(), ':', bestBSSID, 6, 16);
-                                bestRSSI = thisRSSI;
-                            }
-                        }
-                    }
-                    Serial.println();
-                }
-            }
-        } 
+    if (accesspoint || stationCount == 0) 
+        startAP();
+    else 
+        startConnect();
 
-        if (bestStation == -1 ) {
-            Serial.println("No known networks found, entering AccessPoint fallback mode");
-            accesspoint = true;
-        } 
-        else {
-            Serial.printf("Connecting to Wifi Network %d: [%02X:%02X:%02X:%02X:%02X:%02X] %s \r\n",
-                        bestStation, bestBSSID[0], bestBSSID[1], bestBSSID[2], bestBSSID[3],
-                        bestBSSID[4], bestBSSID[5], bestSSID);
-            // Apply static settings if necesscary
-            if (dhcp == false) {
-
-                if(staticIP.ip && staticIP.gateway  && staticIP.netmask) {
-                    Serial.println("Applying static IP settings");
-                    dhcp = false;
-                    WiFi.config(*staticIP.ip, *staticIP.gateway, *staticIP.netmask, *staticIP.dns1, *staticIP.dns2);
-                }
-                else {
-                    dhcp = true;
-                    Serial.println("Static IP settings requested but not defined properly in config, falling back to dhcp");
-                }    
-            }
-
-            // WiFi.setHostname(mdnsName);
+    return wifiStatus();
+}
 
-            // Initiate network connection request (3rd argument, channel = 0 is 'auto')
-            //WiFi.begin(bestBSSID, stationList[bestStation]->password.c_str(), 0, bestBSSID);
-            WiFi.begin(stationList[bestStation].ssid.c_str(), stationList[bestStation].password.c_str());
+void CLAppConn::startConnect() {
+    connect_start = millis();
+    if(!fast_failed && loadCache() && startFastConnect()) return;
+    startScan();
+}
 
-            // Wait to connect, or timeout
-            unsigned long start = millis();
-            while ((millis() - start <= WIFI_WATCHDOG) && (WiFi.status() != WL_CONNECTED)) {
-                delay(500);
-                Serial.print('.');
+void CLAppConn::handle() {
+    switch(state) {
+        case CONN_SCANNING: {
+            int stationsFound = WiFi.scanComplete();
+            if(stationsFound == WIFI_SCAN_RUNNING) 
+                break;
+            if(stationsFound == WIFI_SCAN_FAILED) {
+                Log.warn("WiFi scan failed");
+                retryLater(WIFI_RETRY_DELAY);
+                break;
+            }
+            connectToBest(stationsFound);
+            WiFi.scanDelete();
+            break;
+        }
+        case CONN_CONNECTING:
+            if(got_ip) {
+                got_ip = false;
+                onConnected();
+            }
+            else if(fast_path && millis() - state_since > WIFI_FAST_CONNECT_TIMEOUT) {
+                // the cached access point did not answer; do it the slow way
+                Log.warn("Fast connect failed, scanning");
+                fast_failed = true;
+                WiFi.disconnect();
+                if(dhcp && reuse_lease) WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+                startScan();
             }
-            // If we have connected, inform user
-            if (WiFi.status() == WL_CONNECTED) {
-                setSSID(WiFi.SSID().c_str());
-                setPassword(stationList[bestStation].password);
-                Serial.println();
-                // Print IP details
-                Serial.printf("IP address: %s\r\n",WiFi.localIP().toString());
-                Serial.printf("Netmask   : %s\r\n",WiFi.subnetMask().toString());
-                Serial.printf("Gateway   : %s\r\n",WiFi.gatewayIP().toString());
-
-            } else {
-                Serial.println("WiFi connection failed");
+            else if(millis() - state_since > WIFI_WATCHDOG) {
+                Log.error("WiFi connection failed");
                 WiFi.disconnect();   // (resets the WiFi scan)
-                return wifiStatus();
+                retryLater(WIFI_RETRY_DELAY);
+            }
+            break;
+        case CONN_CONNECTED:
+            if(disconnected) {
+                Log.warn("WiFi connection lost");
+                Metrics.wifi_reconnects.inc();
+                if(on_disconnect) on_disconnect();
+                roam_scanning = false;
+                WiFi.scanDelete();
+                WiFi.disconnect();
+                retryLater(0);
+            }
+            else if(roam_scanning)
+                checkRoamScan();
+            else if(millis() - last_roam_check >= roam_interval * 1000UL)
+                startRoamScan();
+            break;
+        case CONN_ROAMING:
+            if(got_ip) {
+                got_ip = false;
+                onConnected();
+            }
+            else if(millis() - state_since > ROAM_TIMEOUT) {
+                // the new access point did not take us; reconnect the usual way
+                Log.warn("Roaming failed");
+                if(on_disconnect) on_disconnect();
+                WiFi.disconnect();
+                retryLater(0);
+            }
+            break;
+        case CONN_WAIT_RETRY:
+            if(millis() - state_since >= retry_delay)
+                startConnect();
+            break;
+        default:
+            break;
+    }
+}
+
+void CLAppConn::startScan() {
+    Log.info("Scanning local Wifi Networks");
+    disconnected = false;
+    got_ip = false;
+    // the scan runs in the background, its result is picked up by handle()
+    if(WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) {
+        Log.warn("Failed to start the WiFi scan");
+        retryLater(WIFI_RETRY_DELAY);
+        return;
+    }
+    setState(CONN_SCANNING);
+}
+
+void CLAppConn::connectToBest(int stationsFound) {
+    int bestStation = -1;
+    long bestRSSI = -1024;
+    char bestSSID[65] = "";
+    uint8_t bestBSSID[6];
+    int bestChannel = 0;
+
+    Log.info("%i networks found", stationsFound);
+    for (int i = 0; i < stationsFound; ++i) {
+        // Print SSID and RSSI for each network found
+        String thisSSID = WiFi.SSID(i);
+        int thisRSSI = WiFi.RSSI(i);
+        String thisBSSID = WiFi.BSSIDstr(i);
+        bool known = false;
+        // Scan our list of known external stations
+        for (int sta = 0; sta < stationCount; sta++) {
+            if (stationList[sta].ssid == thisSSID ||
+            stationList[sta].ssid == thisBSSID) {
+                known = true;
+                // Chose the strongest RSSI seen
+                if (thisRSSI > bestRSSI) {
+                    bestStation = sta;
+                    strncpy(bestSSID, thisSSID.c_str(), 64);
+                    // Convert char bssid[] to a byte array
+                    parseBytes(thisBSSID.c_str(), ':', bestBSSID, 6, 16);
+                    bestRSSI = thisRSSI;
+                    bestChannel = WiFi.channel(i);
+                }
             }
         }
+        Log.info("%3i : [%s] %s (%i)%s", i + 1, thisBSSID.c_str(), thisSSID.c_str(), thisRSSI, 
+                 (known?"  -  Known!":""));
     }
 
-    if (accesspoint && (WiFi.status() != WL_CONNECTED)) {
-        // The accesspoint has been enabled, and we have not connected to any existing networks
-        WiFi.softAPsetHostname(this->mdnsName.c_str());
-        
-        WiFi.mode(WIFI_AP);
-        // reset ap_status
-        ap_status = WL_DISCONNECTED;
-
-        Serial.printf("Setting up Access Point (channel=%d)\r\n", ap_channel);
-        Serial.print("  SSID     : ");
-        Serial.println(apName);
-        Serial.print("  Password : ");
-        Serial.println(apPass);
-
-        // User has specified the AP details; apply them after a short delay
-        // (https://github.com/espressif/arduino-esp32/issues/985#issuecomment-359157428)
-        if(WiFi.softAPConfig(*apIP.ip, *apIP.ip, *apIP.netmask)) {
-            Serial.printf("IP address: %s\r\n",WiFi.softAPIP().toString());
+    if (bestStation == -1 ) {
+        Log.warn("No known networks found, entering AccessPoint fallback mode");
+        accesspoint = true;
+        startAP();
+        return;
+    } 
+
+    Log.info("Connecting to Wifi Network %d: [%02X:%02X:%02X:%02X:%02X:%02X] %s (channel %d)",
+             bestStation, bestBSSID[0], bestBSSID[1], bestBSSID[2], bestBSSID[3],
+             bestBSSID[4], bestBSSID[5], bestSSID, bestChannel);
+    // Apply static settings if necesscary
+    if (dhcp == false) {
+
+        if(staticIP.ip && staticIP.gateway  && staticIP.netmask) {
+            Log.info("Applying static IP settings");
+            dhcp = false;
+            WiFi.config(*staticIP.ip, *staticIP.gateway, *staticIP.netmask, *staticIP.dns1, *staticIP.dns2);
         }
         else {
-            Serial.println("softAPConfig failed");
-            ap_status = WL_CONNECT_FAILED;
-            return wifiStatus();
-        }
+            dhcp = true;
+            Log.warn("Static IP settings requested but not defined properly in config, falling back to dhcp");
+        }    
+    }
 
-        // WiFi.softAPsetHostname(mdnsName);
+    // Connect to the access point found by the scan, so the driver does not need to scan again
+    got_ip = false;
+    disconnected = false;
+    fast_path = false;
+    connecting_station = bestStation;
+    WiFi.begin(stationList[bestStation].ssid.c_str(), stationList[bestStation].password.c_str(), 
+               bestChannel, bestBSSID);
+    setState(CONN_CONNECTING);
+}
 
-        if(!WiFi.softAP(this->apName.c_str(), this->apPass.c_str(), this->ap_channel)) {
-            Serial.println("Access Point init failed!");
-            ap_status = WL_CONNECT_FAILED;
-            return wifiStatus();
-        }       
-        
-        ap_status = WL_CONNECTED;
-        Serial.println("Access Point init successful");
-
-        // Start the DNS captive portal if requested
-        if (ap_dhcp) {
-            Serial.println("Starting Captive Portal");
-            dnsServer.start(DNS_PORT, "*", *apIP.ip);
-            captivePortal = true;
+bool CLAppConn::startFastConnect() {
+    int station = -1;
+    for(int i=0; i < stationCount; i++)
+        if(stationList[i].ssid == cache.ssid) station = i;
+    if(station < 0) return false;
+
+    Log.info("Connecting to the last access point [%02X:%02X:%02X:%02X:%02X:%02X] %s (channel %d)", 
+             cache.bssid[0], cache.bssid[1], cache.bssid[2], cache.bssid[3], cache.bssid[4], cache.bssid[5], 
+             cache.ssid, cache.channel);
+
+    if(!dhcp && staticIP.ip && staticIP.gateway && staticIP.netmask) 
+        WiFi.config(*staticIP.ip, *staticIP.gateway, *staticIP.netmask, *staticIP.dns1, *staticIP.dns2);
+    else if(reuse_lease && cache.ip) {
+        // skip the DHCP handshake; the lease is renewed on the next slow connect
+        Log.info("Reusing the last IP address");
+        WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.netmask), IPAddress(cache.dns));
+    }
+
+    got_ip = false;
+    disconnected = false;
+    fast_path = true;
+    connecting_station = station;
+    WiFi.begin(stationList[station].ssid.c_str(), stationList[station].password.c_str(), cache.channel, cache.bssid);
+    setState(CONN_CONNECTING);
+    return true;
+}
+
+uint32_t CLAppConn::cacheChecksum(const WiFiCache &c) {
+    // FNV-1a over everything but the checksum itself
+    const uint8_t *p = (const uint8_t*)&c;
+    uint32_t hash = 2166136261UL;
+    for(size_t i=0; i < offsetof(WiFiCache, checksum); i++) 
+        hash = (hash ^ p[i]) * 16777619UL;
+    return hash;
+}
+
+bool CLAppConn::loadCache() {
+    if(rtc_wifi_cache.magic == WIFI_CACHE_MAGIC && rtc_wifi_cache.checksum == cacheChecksum(rtc_wifi_cache)) {
+        cache = rtc_wifi_cache;
+        return true;
+    }
+
+    // cold boot: the RTC memory is garbage, try the copy in NVS
+    Preferences nvs;
+    bool ok = false;
+    if(nvs.begin(WIFI_CACHE_NVS_NAMESPACE, true)) {
+        ok = (nvs.getBytes("cache", &cache, sizeof(cache)) == sizeof(cache) && 
+              cache.magic == WIFI_CACHE_MAGIC && cache.checksum == cacheChecksum(cache));
+        nvs.end();
+    }
+    if(ok) rtc_wifi_cache = cache;
+    return ok;
+}
+
+void CLAppConn::saveCache() {
+    WiFiCache c;
+    memset(&c, 0, sizeof(c));
+    c.magic = WIFI_CACHE_MAGIC;
+    strncpy(c.ssid, WiFi.SSID().c_str(), sizeof(c.ssid) - 1);
+    memcpy(c.bssid, WiFi.BSSID(), sizeof(c.bssid));
+    c.channel = WiFi.channel();
+    c.ip = (uint32_t)WiFi.localIP();
+    c.gateway = (uint32_t)WiFi.gatewayIP();
+    c.netmask = (uint32_t)WiFi.subnetMask();
+    c.dns = (uint32_t)WiFi.dnsIP(0);
+    c.checksum = cacheChecksum(c);
+
+    rtc_wifi_cache = c;
+
+    // write the flash only if the access point or the address has changed
+    if(memcmp(&c, &cache, sizeof(c)) != 0) {
+        Preferences nvs;
+        if(nvs.begin(WIFI_CACHE_NVS_NAMESPACE, false)) {
+            nvs.putBytes("cache", &c, sizeof(c));
+            nvs.end();
         }
+        cache = c;
+    }
+}
+
+void CLAppConn::startRoamScan() {
+    last_roam_check = millis();
+    if(roam_threshold == 0 || WiFi.RSSI() >= roam_threshold) return;
+
+    // the scan leaves the channel for a while, so it is deferred while the video is streaming,
+    // unless the deferral has lasted too long
+    if(is_busy && is_busy() && millis() - last_roam_scan < roam_interval * 1000UL * ROAM_BUSY_FACTOR) return;
+
+    Log.info("Weak signal (%d dBm), looking for a better access point", WiFi.RSSI());
+    if(WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) return;
+    last_roam_scan = millis();
+    roam_scanning = true;
+}
+
+void CLAppConn::checkRoamScan() {
+    int stationsFound = WiFi.scanComplete();
+    if(stationsFound == WIFI_SCAN_RUNNING) return;
+    roam_scanning = false;
+
+    int current_rssi = WiFi.RSSI();
+    String current_bssid = WiFi.BSSIDstr();
+    int bestStation = -1, bestIndex = -1;
+    int bestRSSI = current_rssi + roam_hysteresis - 1;
+
+    for(int i = 0; i < stationsFound; i++) {
+        if(WiFi.BSSIDstr(i) == current_bssid || WiFi.RSSI(i) <= bestRSSI) continue;
+        for(int sta = 0; sta < stationCount; sta++)
+            if(stationList[sta].ssid == WiFi.SSID(i) || stationList[sta].ssid == WiFi.BSSIDstr(i)) {
+                bestStation = sta;
+                bestIndex = i;
+                bestRSSI = WiFi.RSSI(i);
+                break;
+            }
+    }
+
+    if(bestStation < 0) {
+        Log.info("No better access point found");
+        WiFi.scanDelete();
+        return;
+    }
+
+    Log.info("Roaming from [%s] (%d dBm) to [%s] %s (%d dBm, channel %d)", current_bssid.c_str(), current_rssi,
+             WiFi.BSSIDstr(bestIndex).c_str(), WiFi.SSID(bestIndex).c_str(), bestRSSI, (int)WiFi.channel(bestIndex));
+
+    uint8_t bssid[6];
+    memcpy(bssid, WiFi.BSSID(bestIndex), sizeof(bssid));
+    int channel = WiFi.channel(bestIndex);
+    WiFi.scanDelete();
+
+    got_ip = false;
+    disconnected = false;
+    fast_path = true;
+    connecting_station = bestStation;
+    roam_start = millis();
+    WiFi.begin(stationList[bestStation].ssid.c_str(), stationList[bestStation].password.c_str(), channel, bssid);
+    setState(CONN_ROAMING);
+}
+
+void CLAppConn::onConnected() {
+    bool roamed = (state == CONN_ROAMING);
+    setSSID(WiFi.SSID().c_str());
+    setPassword(stationList[connecting_station].password);
+
+    if(roamed) {
+        last_roam_gap = millis() - roam_start;
+        roams++;
+        Log.info("Roamed in %lu ms, RSSI %d dBm", (unsigned long)last_roam_gap, WiFi.RSSI());
+        fast_failed = false;
+        saveCache();
+        setState(CONN_CONNECTED);
+        last_roam_check = millis();
+        return;
+    }
+
+    connect_ms = millis() - connect_start;
+    connect_fast = fast_path;
+    if(fast_path) fast_connects++; else scan_connects++;
+    fast_failed = false;
+    Log.info("Connected in %lu ms (%s)", (unsigned long)connect_ms, (fast_path?"fast path":"scan"));
+    saveCache();
+
+    // Print IP details
+    Log.info("IP address: %s", WiFi.localIP().toString().c_str());
+    Log.info("Netmask   : %s", WiFi.subnetMask().toString().c_str());
+    Log.info("Gateway   : %s", WiFi.gatewayIP().toString().c_str());
+
+    setState(CONN_CONNECTED);
+    startServices();
+    if(on_connect) on_connect();
+}
+
+void CLAppConn::startAP() {
+    // The accesspoint has been enabled, and we have not connected to any existing networks
+    WiFi.softAPsetHostname(this->mdnsName.c_str());
+    
+    WiFi.mode(WIFI_AP);
+    // reset ap_status
+    ap_status = WL_DISCONNECTED;
+
+    Log.info("Setting up Access Point (channel=%d)", ap_channel);
+    Log.info("  SSID     : %s", apName.c_str());
+    Log.info("  Password : %s", apPass.c_str());
+
+    // User has specified the AP details; apply them after a short delay
+    // (https://github.com/espressif/arduino-esp32/issues/985#issuecomment-359157428)
+    if(WiFi.softAPConfig(*apIP.ip, *apIP.ip, *apIP.netmask)) {
+        Log.info("IP address: %s", WiFi.softAPIP().toString().c_str());
+    }
+    else {
+        Log.error("softAPConfig failed");
+        ap_status = WL_CONNECT_FAILED;
+        retryLater(WIFI_RETRY_DELAY);
+        return;
     }
 
+    // WiFi.softAPsetHostname(mdnsName);
+
+    if(!WiFi.softAP(this->apName.c_str(), this->apPass.c_str(), this->ap_channel)) {
+        Log.error("Access Point init failed!");
+        ap_status = WL_CONNECT_FAILED;
+        retryLater(WIFI_RETRY_DELAY);
+        return;
+    }       
+    
+    ap_status = WL_CONNECTED;
+    Log.info("Access Point init successful");
+    setState(CONN_AP);
+
+    // Start the DNS captive portal if requested
+    if (ap_dhcp) {
+        Log.info("Starting Captive Portal");
+        dnsServer.start(DNS_PORT, "*", *apIP.ip);
+        captivePortal = true;
+    }
+
+    startServices();
+    if(on_connect) on_connect();
+}
+
+void CLAppConn::startServices() {
     calcURLs();
 
+    // the responders follow the IP changes on their own, so they are started only once
+    if(services_started) return;
+
     startOTA();
     // http service attached to port
     configMDNS();
+    services_started = true;
+}
 
-    return wifiStatus();
+void CLAppConn::retryLater(uint32_t delay_ms) {
+    retry_delay = delay_ms;
+    setState(CONN_WAIT_RETRY);
+}
+
+void CLAppConn::setState(ConnStateEnum new_state) {
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&transitions_mux);
+    ConnTransition &t = transitions[transition_count % CONN_TRANSITION_HISTORY];
+    t.from = state;
+    t.to = new_state;
+    t.at = now;
+    t.duration = now - state_since;
+    transition_count++;
+    portEXIT_CRITICAL(&transitions_mux);
+
+    Log.info("WiFi: %s -> %s after %lu ms", conn_state_names[state], conn_state_names[new_state], 
+             (unsigned long)(now - state_since));
+    state = new_state;
+    state_since = now;
+}
+
+void CLAppConn::dumpStateToJson(JsonObject json) {
+    ConnTransition copy[CONN_TRANSITION_HISTORY];
+    uint32_t count;
+
+    portENTER_CRITICAL(&transitions_mux);
+    memcpy(copy, transitions, sizeof(copy));
+    count = transition_count;
+    portEXIT_CRITICAL(&transitions_mux);
+
+    json["state"] = conn_state_names[state];
+    json["since"] = state_since;
+    json["reconnects"] = Metrics.wifi_reconnects.get();
+    json["connect_ms"] = connect_ms;
+    json["connect_path"] = (connect_fast?"fast":"scan");
+    json["fast_connects"] = fast_connects;
+    json["scan_connects"] = scan_connects;
+    json["roams"] = roams;
+    json["roam_gap_ms"] = last_roam_gap;
+
+    JsonArray history = json["transitions"].to<JsonArray>();
+    uint32_t first = (count > CONN_TRANSITION_HISTORY?count - CONN_TRANSITION_HISTORY:0);
+    for(uint32_t i = first; i < count; i++) {
+        ConnTransition &t = copy[i % CONN_TRANSITION_HISTORY];
+        JsonObject item = history.add<JsonObject>();
+        item["from"] = conn_state_names[t.from];
+        item["to"] = conn_state_names[t.to];
+        item["at"] = t.at;
+        item["ms"] = t.duration;
+    }
+}
+
+void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    // runs in the event task; the state machine picks the flags up in handle()
+    switch(event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            AppConn.setGotIP();
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+            AppConn.setDisconnected();
+            break;
+        default:
+            break;
+    }
 }
 
 void CLAppConn::calcURLs() {
@@ -215,7 +551,7 @@ int CLAppConn::loadPrefs() {
         this->httpPort  = json["http_port"].as<int>();
         this->dhcp      = json["dhcp"].as<bool>();
     } else {
-        Serial.println("MDNS Name is not defined!");
+        Log.error("MDNS Name is not defined!");
     }
 
     char sbuf[64];
@@ -224,7 +560,6 @@ int CLAppConn::loadPrefs() {
     stationCount = 0;
 
     if (this->mdnsName && json["stations"]) {
-        Serial.print("Known external SSIDs: ");
         count = json["stations"].as<JsonArray>().size();
         if(count > 0)
             for(int i=0; i < count && i < MAX_KNOWN_STATIONS; i++) {
@@ -235,7 +570,7 @@ int CLAppConn::loadPrefs() {
                         Station s;
                         s.ssid = json["stations"].as<JsonArray>()[i]["ssid"].as<String>();
                         this->urlDecode(s.password, json["stations"].as<JsonArray>()[i]["pass"].as<String>().c_str());
-                        Serial.println(s.ssid);
+                        Log.info("Known external SSID: %s", s.ssid.c_str());
                         stationList[i] = s;
                         stationCount++;
                     } 
@@ -243,7 +578,7 @@ int CLAppConn::loadPrefs() {
                 
             }
         else
-            Serial.println("None");
+            Log.info("Known external SSIDs: None");
     }
         
     // read static IP
@@ -256,6 +591,10 @@ int CLAppConn::loadPrefs() {
     }
 
     load_as_ap = json["accesspoint"].as<bool>();
+    reuse_lease = json["reuse_lease"].as<bool>();
+    if(json["roam_threshold"].is<int>()) roam_threshold = json["roam_threshold"].as<int>();
+    if(json["roam_hysteresis"].is<int>()) roam_hysteresis = json["roam_hysteresis"].as<int>();
+    if(json["roam_interval"].is<int>()) roam_interval = json["roam_interval"].as<int>();
     this->apName = json["ap_ssid"].as<String>().c_str();
 
     String apPassStr = json["ap_pass"].as<String>();
@@ -297,7 +636,7 @@ int CLAppConn::loadPrefs() {
 void CLAppConn::setStaticIP (IPAddress ** ip_address, const char * strval) {
     if(!*ip_address) *ip_address = new IPAddress();
     if(!(*ip_address)->fromString(strval)) {
-            Serial.print(strval); Serial.println(" is invalid IP address");
+            Log.warn("%s is invalid IP address", strval);
     }
 }
 
@@ -309,15 +648,16 @@ void CLAppConn::readIPFromJSON (jparse_ctx_t * context, IPAddress ** ip_address,
 }
 
 int CLAppConn::savePrefs() {
+  TRACE_SCOPE("prefs_save");
   JsonDocument json;
   char ebuf[254]; 
 
   char * prefs_file = getPrefsFileName(true); 
 
   if (Storage.exists(prefs_file)) {
-    Serial.printf("Updating %s\r\n", prefs_file);
+    Log.info("Updating %s", prefs_file);
   } else {
-    Serial.printf("Creating %s\r\n", prefs_file);
+    Log.info("Creating %s", prefs_file);
   }
 
   json["mdns_name"] = this->mdnsName;
@@ -354,6 +694,10 @@ int CLAppConn::savePrefs() {
   }
 
   json["dhcp"] = this->dhcp;
+  json["reuse_lease"] = this->reuse_lease;
+  json["roam_threshold"] = this->roam_threshold;
+  json["roam_hysteresis"] = this->roam_hysteresis;
+  json["roam_interval"] = this->roam_interval;
   json["static_ip"].to<JsonObject>();
   if(staticIP.ip) json["static_ip"]["ip"] = staticIP.ip->toString();
   if (staticIP.netmask) json["static_ip"]["netmask"] = staticIP.netmask->toString();
@@ -390,13 +734,12 @@ int CLAppConn::savePrefs() {
   if(file) {
     serializeJson(json, file);
     file.close();
-    Serial.printf("File %s updated\r\n", prefs_file);
-    serializeJsonPretty(json, Serial);
-    Serial.println();
+    // the connection settings contain the WiFi passwords, so they are not dumped to the log
+    Log.info("File %s updated", prefs_file);
     return OK;
   }
   else {
-    Serial.printf("Failed to save connection preferences to file %s\r\n", prefs_file);
+    Log.error("Failed to save connection preferences to file %s", prefs_file);
     return FAIL;
   }
   return OS_SUCCESS;
@@ -406,7 +749,7 @@ void CLAppConn::startOTA() {
     // Set up OTA
 
     if(otaEnabled) {
-        Serial.println("Setting up OTA");
+        Log.info("Setting up OTA");
         // Port defaults to 3232
         // ArduinoOTA.setPort(3232);
         // Hostname defaults to esp3232-[MAC]
@@ -414,10 +757,10 @@ void CLAppConn::startOTA() {
 
         if (otaPassword.length() > 0) {
             ArduinoOTA.setPassword(this->otaPassword.c_str());
-            Serial.printf("OTA Password: %s\n\r", this->otaPassword.c_str());
+            Log.info("OTA password is set");
         } 
         else {
-            Serial.printf("\r\nNo OTA password has been set! (insecure)\r\n\r\n");
+            Log.warn("No OTA password has been set! (insecure)");
         }
         
         ArduinoOTA
@@ -428,7 +771,7 @@ void CLAppConn::startOTA() {
                 else // U_SPIFFS
                     // NOTE: if updating SPIFFS this would be the place to unmount SPIFFS using SPIFFS.end()
                     type = "filesystem";
-                Serial.println("Start updating " + type);
+                Log.info("Start updating %s", type.c_str());
 
                 // Stop the camera since OTA will crash the module if it is running.
                 // the unit will need rebooting to restart it, either by OTA on success, or manually by the user
@@ -438,26 +781,27 @@ void CLAppConn::startOTA() {
                 // critERR += "<p>Wait for OTA to finish and reboot, or <a href=\"control?var=reboot&val=0\" title=\"Reboot Now (may interrupt OTA)\">reboot manually</a> to recover</p>";
             })
             .onEnd([]() {
-                Serial.println("End");
+                Log.info("End");
             })
             .onProgress([](unsigned int progress, unsigned int total) {
-                Serial.printf("Progress: %u%%\r", (progress / (total / 100)));
+                Log.debug("Progress: %u%%", (progress / (total / 100)));
             })
             .onError([](ota_error_t error) {
-                Serial.printf("Error[%u]: ", error);
-                if (error == OTA_AUTH_ERROR) Serial.println("Auth Failed");
-                else if (error == OTA_BEGIN_ERROR) Serial.println("Begin Failed");
-                else if (error == OTA_CONNECT_ERROR) Serial.println("Connect Failed");
-                else if (error == OTA_RECEIVE_ERROR) Serial.println("Receive Failed");
-                else if (error == OTA_END_ERROR) Serial.println("End Failed");
+                const char *reason = "";
+                if (error == OTA_AUTH_ERROR) reason = "Auth Failed";
+                else if (error == OTA_BEGIN_ERROR) reason = "Begin Failed";
+                else if (error == OTA_CONNECT_ERROR) reason = "Connect Failed";
+                else if (error == OTA_RECEIVE_ERROR) reason = "Receive Failed";
+                else if (error == OTA_END_ERROR) reason = "End Failed";
+                Log.error("Error[%u]: %s", error, reason);
             });
 
         ArduinoOTA.begin();
-        Serial.println("OTA is enabled");
+        Log.info("OTA is enabled");
     }
     else {
         ArduinoOTA.end();
-        Serial.println("OTA is disabled");
+        Log.info("OTA is disabled");
     }
 
 }
@@ -466,14 +810,14 @@ void CLAppConn::configMDNS() {
 
     // if(!otaEnabled) {
     if (!MDNS.begin(this->mdnsName.c_str())) {
-        Serial.println("Error setting up MDNS responder!");
+        Log.error("Error setting up MDNS responder!");
     }
     else
-        Serial.println("mDNS responder started");
+        Log.info("mDNS responder started");
     // }
     //MDNS Config -- note that if OTA is NOT enabled this needs prior steps!
     MDNS.addService("http", "tcp", this->httpPort);
-    Serial.println("Added HTTP service to MDNS server");
+    Log.info("Added HTTP service to MDNS server");
 
 }
 
@@ -483,10 +827,10 @@ void CLAppConn::configNTP() {
 
 void CLAppConn::printLocalTime(bool extraData) {
     updateTimeStr();
-    Serial.println(localTimeString);
+    Log.info("Time: %s", localTimeString.c_str());
     if (extraData) {
-        Serial.printf("NTP Server: %s, GMT Offset: %li(s), DST Offset: %i(s)\r\n", 
-                      ntpServer, gmtOffset_sec , daylightOffset_sec);
+        Log.info("NTP Server: %s, GMT Offset: %li(s), DST Offset: %i(s)", 
+                 ntpServer.c_str(), gmtOffset_sec , daylightOffset_sec);
     }
 }
 
@@ -8,6 +8,7 @@
 #include <ESPmDNS.h>
 #include <time.h>
 #include <ArduinoJson.h>
+#include <Preferences.h>
 
 #include "parsebytes.h"
 #include "app_component.h"
@@ -17,6 +18,17 @@
 
 #define CREDENTIALS_SIZE                32
 
+#define WIFI_RETRY_DELAY                5000    // ms before retrying a failed connection
+#define CONN_TRANSITION_HISTORY         8       // state transitions kept for /system
+#define WIFI_FAST_CONNECT_TIMEOUT       3000    // ms to wait for the cached access point before scanning
+#define ROAM_THRESHOLD                  -75     // dBm; below this, look for a better access point (0 = never)
+#define ROAM_HYSTERESIS                 8       // dB the new access point has to be stronger by
+#define ROAM_INTERVAL                   60      // s between two signal checks
+#define ROAM_BUSY_FACTOR                5       // while streaming, scan at most every ROAM_BUSY_FACTOR intervals
+#define ROAM_TIMEOUT                    5000    // ms to get the IP address from the new access point
+#define WIFI_CACHE_MAGIC                0x57434331
+#define WIFI_CACHE_NVS_NAMESPACE        "wifi_cache"
+
 /**
  * @brief WiFi connectivity details (SSID/password).
  * 
@@ -31,9 +43,43 @@ struct StaticIP { IPAddress *ip; IPAddress *netmask; IPAddress *gateway; IPAddre
 
 enum StaticIPField {IP, NETMASK, GATEWAY, DNS1, DNS2};
 
+/**
+ * @brief States of the WiFi connection
+ * 
+ */
+enum ConnStateEnum {CONN_IDLE, CONN_SCANNING, CONN_CONNECTING, CONN_CONNECTED, CONN_AP, CONN_WAIT_RETRY, 
+                    CONN_ROAMING, CONN_STATE_COUNT};
+
+/**
+ * @brief Transition between two connection states. The duration is the time spent in the previous state.
+ * 
+ */
+struct ConnTransition {ConnStateEnum from; ConnStateEnum to; uint32_t at; uint32_t duration;};
+
+/**
+ * @brief Last good connection: the access point and the address leased by DHCP
+ * 
+ */
+struct WiFiCache {
+    uint32_t magic;
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t netmask;
+    uint32_t dns;
+    uint32_t checksum;
+};
+
+void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info);
+
 /**
  * @brief Connection Manager
  * This class manages everything related to connectivity of the application: WiFi, OTA etc.
+ * The WiFi connection is a state machine: start() only initiates the connection, the scan, the connection
+ * and the reconnects are driven by the WiFi events and by handle(), which has to be called from the loop. 
+ * None of the steps blocks the caller.
  * 
  */
 class CLAppConn : public CLAppComponent {
@@ -45,6 +91,28 @@ class CLAppConn : public CLAppComponent {
         int start();
         bool stop() {return WiFi.disconnect();};
 
+        /// @brief advances the connection state machine; to be called from the loop
+        void handle();
+
+        ConnStateEnum getState() {return state;};
+        /// @brief true if connected to a station, or the access point is up
+        bool isConnected() {return state == CONN_CONNECTED || state == CONN_AP;};
+        void dumpStateToJson(JsonObject json);
+
+        /// @brief callbacks fired when the connection (or the access point) is up, and when it is lost
+        void setOnConnect(void (*cb)()) {on_connect = cb;};
+        void setOnDisconnect(void (*cb)()) {on_disconnect = cb;};
+        /// @brief callback telling whether a background scan would disturb the clients (e.g. video is streaming)
+        void setBusyCheck(bool (*cb)()) {is_busy = cb;};
+
+        // called from the WiFi event task
+        void setGotIP() {disconnected = false; got_ip = true; wakeUp();};
+        void setDisconnected() {disconnected = true; wakeUp();};
+
+        /// @brief task running handle(), which is woken up by the WiFi events
+        void setNotifyTask(TaskHandle_t task) {notify_task = task;};
+        void wakeUp() {if(notify_task) xTaskNotifyGive(notify_task);};
+
         void startOTA();
         void handleOTA() {if(otaEnabled) ArduinoOTA.handle();};
         bool isOTAEnabled() {return otaEnabled;};        
@@ -109,10 +177,27 @@ class CLAppConn : public CLAppComponent {
     private:
         int getSSIDIndex();
         void calcURLs();
+
+        void startConnect();
+        bool startFastConnect();
+        void startScan();
+        void connectToBest(int stationsFound);
+        void onConnected();
+        void startAP();
+        void startServices();
+        void retryLater(uint32_t delay_ms);
+        void setState(ConnStateEnum new_state);
+
+        void startRoamScan();
+        void checkRoamScan();
+
+        bool loadCache();
+        void saveCache();
+        static uint32_t cacheChecksum(const WiFiCache &c);
         void readIPFromJSON(jparse_ctx_t * context, IPAddress ** ip_address, char * token);
 
         // Known networks structure. Max number of known stations limited for memory considerations
-        Station* stationList; 
+        Station* stationList = nullptr; 
         // number of known stations
         int stationCount = 0;
 
@@ -120,6 +205,8 @@ class CLAppConn : public CLAppComponent {
         StaticIP staticIP;
 
         bool dhcp=false;
+        // on the fast path, configure the address of the last DHCP lease instead of asking for a new one
+        bool reuse_lease = false;
 
         String ssid;
         String password;
@@ -167,6 +254,46 @@ class CLAppConn : public CLAppComponent {
         String localTimeString;
         String upTimeString;
 
+        // connection state machine
+        ConnStateEnum state = CONN_IDLE;
+        uint32_t state_since = 0;
+        uint32_t retry_delay = 0;
+        int connecting_station = 0;
+        bool events_registered = false;
+        bool services_started = false;
+        volatile bool got_ip = false;
+        volatile bool disconnected = false;
+
+        // fast reconnect to the last access point
+        WiFiCache cache;
+        bool fast_path = false;
+        bool fast_failed = false;
+        uint32_t connect_start = 0;
+        uint32_t connect_ms = 0;
+        bool connect_fast = false;
+        uint32_t fast_connects = 0;
+        uint32_t scan_connects = 0;
+
+        void (*on_connect)() = NULL;
+        void (*on_disconnect)() = NULL;
+        bool (*is_busy)() = NULL;
+        TaskHandle_t notify_task = NULL;
+
+        // roaming to a stronger known access point
+        int roam_threshold = ROAM_THRESHOLD;
+        int roam_hysteresis = ROAM_HYSTERESIS;
+        int roam_interval = ROAM_INTERVAL;
+        bool roam_scanning = false;
+        uint32_t last_roam_check = 0;
+        uint32_t last_roam_scan = 0;
+        uint32_t roam_start = 0;
+        uint32_t last_roam_gap = 0;
+        uint32_t roams = 0;
+
+        ConnTransition transitions[CONN_TRANSITION_HISTORY];
+        uint32_t transition_count = 0;
+        portMUX_TYPE transitions_mux = portMUX_INITIALIZER_UNLOCKED;
+
 };
 
 extern CLAppConn AppConn;
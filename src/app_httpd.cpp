@@ -1,30 +1,88 @@
 #include "app_httpd.h"
 
+static const char * request_class_names[REQUEST_CLASS_COUNT] = {"stream", "control", "static", "status"};
+#ifdef ENABLE_TRACE
+static const char * request_trace_names[REQUEST_CLASS_COUNT] = {"http_stream", "http_control", "http_static", "http_status"};
+#endif
+
 CLAppHttpd::CLAppHttpd() {
     // Gather static values used when dumping status; these are slow functions, so just do them once during startup
     sketchSize = ESP.getSketchSize();;
     sketchSpace = ESP.getFreeSketchSpace();
     sketchMD5 = ESP.getSketchMD5();
     setTag("httpd");
+    memset(pwmIndex, -1, sizeof(pwmIndex));
 #ifdef CAMERA_MODEL_AI_THINKER
     setPrefix("ai_thinker");
 #endif
 }
 
 void IRAM_ATTR onSnapTimer(TimerHandle_t pxTimer){
-    AppHttpd.snapToStream();
+    AppHttpd.snapToStream(false, 0);
+}
+
+void statusSamplerTask(void *pvParameters) {
+    TickType_t last_wake = xTaskGetTickCount();
+    unsigned long last_storage = millis();
+
+    while(true) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(STATUS_SAMPLE_INTERVAL));
+
+        bool with_storage = (millis() - last_storage >= STATUS_STORAGE_INTERVAL);
+        if(with_storage) last_storage = millis();
+
+        AppHttpd.sampleStatus(with_storage);
+        Multicast.expireLeases();
+        AppHttpd.pingControlClient();
+    }
 }
 
 int CLAppHttpd::start() {
     
     loadPrefs();
 
+    JsonPool.begin();
+
+    Session.begin();
+
     server = new AsyncWebServer(AppConn.getPort());
     ws = new AsyncWebSocket("/ws");
-    
-    server->on("/", HTTP_GET, [](AsyncWebServerRequest *request){
+
+    // admission control goes first, so a rejected request does not cost anything else
+    server->addMiddleware([](AsyncWebServerRequest *request, ArMiddlewareNext next) {
+        RequestClassEnum cls = CLAppHttpd::classifyRequest(request);
+        // the websocket outlives its upgrade request; its streams are admitted by startStream()
+        bool track = (request->url() != "/ws");
+        if(!AppHttpd.admitRequest(cls, track)) {
+            AsyncWebServerResponse *response = request->beginResponse(503, "text/plain", "Server busy");
+            response->addHeader("Retry-After", ADMISSION_RETRY_AFTER);
+            request->send(response);
+            return;
+        }
+        if(track)
+            request->onDisconnect([cls](){ AppHttpd.releaseRequest(cls); });
+        TRACE_BEGIN(request_trace_names[cls]);
+        next();
+        TRACE_END(request_trace_names[cls]);
+    });
+
+    // all requests, including the websocket upgrade, need a valid session or valid credentials
+    server->addMiddleware([](AsyncWebServerRequest *request, ArMiddlewareNext next) {
+        if(AppHttpd.hasValidSession(request)) {
+            next();
+            return;
+        }
         if(!request->authenticate(AppConn.getUser().c_str(), AppConn.getPwd().c_str()))
             return request->requestAuthentication();
+        next();
+        // the credentials are fine; issue a session so they do not need to be verified again
+        if(request->url() != "/login")
+            AppHttpd.attachSessionCookie(request->getResponse());
+    });
+
+    server->on("/login", HTTP_GET, onLogin);
+    
+    server->on("/", HTTP_GET, [](AsyncWebServerRequest *request){
         if(AppConn.isConfigured())
             request->send(Storage.getFS(), "/www/camera.html", "", false, processor);
         else
@@ -32,26 +90,18 @@ int CLAppHttpd::start() {
     });
 
     server->on("/camera", HTTP_GET, [](AsyncWebServerRequest *request){
-        if(!request->authenticate(AppConn.getUser().c_str(), AppConn.getPwd().c_str()))
-            return request->requestAuthentication();
         request->send(Storage.getFS(), "/www/camera.html", "", false, processor);
     });  
 
     server->on("/setup", HTTP_GET, [](AsyncWebServerRequest *request){
-        if(!request->authenticate(AppConn.getUser().c_str(), AppConn.getPwd().c_str()))
-            return request->requestAuthentication();
         request->send(Storage.getFS(), "/www/setup.html", "", false, processor);
     });    
 
     server->on("/dump", HTTP_GET, [](AsyncWebServerRequest *request){
-        if(!request->authenticate(AppConn.getUser().c_str(), AppConn.getPwd().c_str()))
-            return request->requestAuthentication();
         request->send(Storage.getFS(), "/www/dump.html", "", false, processor);
     });    
 
     server->on("/view", HTTP_GET, [](AsyncWebServerRequest *request){
-        if(!request->authenticate(AppConn.getUser().c_str(), AppConn.getPwd().c_str()))
-            return request->requestAuthentication();
         if(request->arg("mode") == "stream" || 
             request->arg("mode") == "still") {
             if(!AppCam.getLastErr()) {
@@ -67,13 +117,19 @@ int CLAppHttpd::start() {
 
     // adding fixed mappigs
     for(int i=0; i<mappingCount; i++) {
-        server->serveStatic(mappingList[i]->uri, Storage.getFS(), mappingList[i]->path).setAuthentication(AppConn.getUser(), AppConn.getPwd());
+        server->serveStatic(mappingList[i]->uri, Storage.getFS(), mappingList[i]->path);
     }
 
-    server->on("/control", HTTP_GET, onControl).setAuthentication(AppConn.getUser(), AppConn.getPwd());
-    server->on("/status", HTTP_GET, onStatus).setAuthentication(AppConn.getUser(), AppConn.getPwd());
-    server->on("/system", HTTP_GET, onSystemStatus).setAuthentication(AppConn.getUser(), AppConn.getPwd());
-    server->on("/info", HTTP_GET, onInfo).setAuthentication(AppConn.getUser(), AppConn.getPwd());
+    server->on("/control", HTTP_GET, onControl);
+    server->on("/status", HTTP_GET, onStatus);
+    server->on("/system", HTTP_GET, onSystemStatus);
+    server->on("/info", HTTP_GET, onInfo);
+    server->on("/stream.sdp", HTTP_GET, onStreamSDP);
+    server->on("/metrics", HTTP_GET, onMetrics);
+    server->on("/log", HTTP_GET, onLog);
+#ifdef ENABLE_TRACE
+    server->on("/trace", HTTP_GET, onTrace);
+#endif
 
     // make a snapshot and send it to the client
     server->on("/capture", HTTP_GET, [](AsyncWebServerRequest *request){
@@ -89,7 +145,7 @@ int CLAppHttpd::start() {
         else {
             request->send(500, "text/plain", "Camera not configured");
         }
-    }).setAuthentication(AppConn.getUser(), AppConn.getPwd());
+    });
     
     // adding WebSocket handler
     ws->onEvent(onWsEvent);
@@ -97,17 +153,44 @@ int CLAppHttpd::start() {
 
     snap_timer = xTimerCreate("SnapTimer", 1000/AppCam.getFrameRate()/portTICK_PERIOD_MS, pdTRUE, 0, onSnapTimer);
 
+    if(!RtpStreamer.begin())
+        Log.error("Failed to initialize the RTP streamer");
+    else if(rtsp_port > 0 && RtspServer.begin(rtsp_port) != OS_SUCCESS)
+        Log.error("Failed to start the RTSP server");
+
+    if(!Multicast.begin())
+        Log.error("Failed to initialize the multicast stream");
+
+    if(!ServoMotion.begin())
+        Log.error("Failed to start the servo motion task");
+
+    if(!PwmFader.begin())
+        Log.error("Failed to start the PWM fader");
+
+    if(!Triggers.begin())
+        Log.error("Failed to start the trigger inputs");
+
+    Metrics.beginCpuLoad();
+
+    // take the first status sample right away, then keep it fresh in the background
+    boot_id = esp_random();
+    sampleStatus(true);
+    if(xTaskCreate(statusSamplerTask, "StatusSampler", STATUS_SAMPLER_STACK_SIZE, NULL, 
+                   STATUS_SAMPLER_PRIORITY, &sampler_task) != pdPASS)
+        Log.error("Failed to start the status sampler!");
+
     DefaultHeaders::Instance().addHeader("Access-Control-Allow-Origin", "*");
     // TODO: if WiFi is not up, server->begin() produces a crash 
     server->begin();
 
     if(isDebugMode()) {
-        Serial.printf("\r\nUse '%s' to connect\r\n", AppConn.getHTTPUrl());
-        Serial.printf("Stream viewer available at '%sview?mode=stream'\r\n", AppConn.getHTTPUrl());
-        // Serial.printf("Raw stream URL is '%s'\r\n", AppConn.getStreamUrl());
+        Log.info("Use '%s' to connect", AppConn.getHTTPUrl());
+        Log.info("Stream viewer available at '%sview?mode=stream'", AppConn.getHTTPUrl());
+        // Log.info("Raw stream URL is '%s'", AppConn.getStreamUrl());
     }
     
-    Serial.println("HTTP server started");
+    Log.setTailCallback(onLogTail);
+    Log.info("HTTP server started");
     return OK;
 }
 
@@ -115,11 +198,13 @@ void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventT
     
 
     if(type == WS_EVT_CONNECT){
-        Serial.printf("ws[%s][%u] connect\n", server->url(), client->id());
+        Log.info("ws[%s][%u] connect", server->url(), client->id());
     }
     else if(type == WS_EVT_DISCONNECT){
-        Serial.printf("ws[%s][%u] disconnect\n", server->url(), client->id());
+        Log.info("ws[%s][%u] disconnect", server->url(), client->id());
         AppHttpd.stopStream(client->id());        
+        if(AppHttpd.getLogClient() == client->id())
+            AppHttpd.setLogClient(0);
         if(AppHttpd.getControlClient() == client->id()) {
             AppHttpd.setControlClient(0);
             AppHttpd.resetPWM(RESET_ALL_PWM);
@@ -127,10 +212,11 @@ void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventT
         }
     }
     else if(type == WS_EVT_ERROR){
-        Serial.printf("ws[%s][%u] error(%u): %s\n", server->url(), client->id(), *((uint16_t*)arg), (char*)data);
+        Log.warn("ws[%s][%u] error(%u): %.*s", server->url(), client->id(), *((uint16_t*)arg), (int)len, (char*)data);
     }
     else if(type == WS_EVT_PONG){
-        Serial.printf("ws[%s][%u] pong[%u]: %s\n", server->url(), client->id(), len, (len)?(char*)data:"");
+        Log.debug("ws[%s][%u] pong[%u]", server->url(), client->id(), len);
+        AppHttpd.onControlPong(client->id(), data, len);
     }
     else if(type == WS_EVT_DATA){
         AwsFrameInfo * info = (AwsFrameInfo*)arg;
@@ -153,6 +239,7 @@ void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventT
             case (uint8_t)'w':  // write PWM value
                 if(AppHttpd.getControlClient())
                     if(len > 4) {
+                        AppHttpd.touchControl();
                         uint8_t pin = *(msg+1);
                         int nparams = *(msg+2);
                         int vlen = *(msg+3);
@@ -164,7 +251,7 @@ void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventT
                             value = *(msg+4);
 
                         if(AppHttpd.isDebugMode())
-                            Serial.printf("vlen %d nparams %d value %d\r\n", vlen, nparams, value);
+                            Log.debug("vlen %d nparams %d value %d", vlen, nparams, value);
 
                         if(nparams == 1)
                             AppHttpd.writePWM(pin, value); // write to servo
@@ -172,17 +259,58 @@ void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventT
                             AppHttpd.writePWM(pin, value, 0); // write to raw PWM
                     }
                 break;
+            case (uint8_t)'m':  // move a servo with a motion profile
+                if(AppHttpd.getControlClient())
+                    if(len >= 4) {
+                        AppHttpd.touchControl();
+                        uint8_t pin = *(msg+1);
+                        int target = *(msg+2) + *(msg+3)*256;
+                        int velocity = (len >= 6?*(msg+4) + *(msg+5)*256:0);
+                        int acceleration = (len >= 8?*(msg+6) + *(msg+7)*256:0);
+
+                        if(ServoMotion.moveTo(pin, target, velocity, acceleration) != OS_SUCCESS)
+                            Log.warn("Servo move failed: pin %d is not attached", pin);
+                    }
+                break;
+            case (uint8_t)'W': { // PWM writes, binary protocol v2
+                uint16_t seq = 0;
+                PwmAckStatusEnum status;
+                if(client->id() != AppHttpd.getControlClient())
+                    status = PWM_ACK_NOT_CONTROL;
+                else if(!info->final || info->index != 0 || info->len != len)
+                    status = PWM_ACK_MALFORMED;     // fragmented frames are not supported
+                else {
+                    AppHttpd.touchControl();
+                    status = ServoMotion.stageFrame(msg, len, seq);
+                }
+
+                // the accepted frames are acknowledged once applied, by the servo tick
+                if(status != PWM_ACK_OK) {
+                    uint8_t nack[PWM_ACK_SIZE];
+                    CLServoMotion::formatAck(nack, status, seq);
+                    client->binary(nack, sizeof(nack));
+                }
+                break;
+            }
             case (uint8_t)'t':  // terminate stream
                 AppHttpd.stopStream(client->id());
                 break;
+            case (uint8_t)'i':  // compact status, encoded as MessagePack
+                AppHttpd.sendStatusMsgPack(client->id());
+                break;
+            case (uint8_t)'l':  // tail the log
+                AppHttpd.setLogClient(client->id());
+                break;
             default:
-                Serial.printf("ws[%s] client[%u] frame[%u] %u %s[%llu - %llu]: ", server->url(), client->id(), info->num,
-                    info->message_opcode, (info->message_opcode == WS_TEXT)?"text":"binary", info->index, info->index + len);
-                for(int i=0; i< len; i++) {
-                    Serial.printf("%d,", *msg);
-                    msg++;
+                if(AppHttpd.isDebugMode()) {
+                    char dump[LOG_LINE_LENGTH];
+                    size_t pos = 0;
+                    for(int i=0; i < len && pos < sizeof(dump) - 5; i++) 
+                        pos += snprintf(dump + pos, sizeof(dump) - pos, "%d,", msg[i]);
+                    dump[pos] = '\0';
+                    Log.debug("ws[%s] client[%u] frame[%u] %u %s[%llu - %llu]: %s", server->url(), client->id(), info->num,
+                        info->message_opcode, (info->message_opcode == WS_TEXT)?"text":"binary", info->index, info->index + len, dump);
                 }
-                Serial.println();
                 break;
         }
 
@@ -207,15 +335,47 @@ String processor(const String& var) {
 }
 
 
-int IRAM_ATTR CLAppHttpd::snapToStream(bool debug) {
-    if (ws->availableForWriteAll()) {
-        int res = AppCam.snapToBuffer();
+int IRAM_ATTR CLAppHttpd::snapToStream(bool debug, TickType_t wait) {
+    TRACE_SCOPE("frame");
+    // the websocket clients only get frames while streaming or waiting for a still image
+    bool ws_ready = (streamCount > 0 || stillPending) && ws->availableForWriteAll();
+    bool rtp_active = (RtpStreamer.getDestinationCount() > 0);
+    bool push_wanted = AppPush.isFrameWanted();
+    bool mqtt_wanted = AppMqtt.isFrameWanted();
+    bool trigger_wanted = Triggers.isFrameWanted();
+
+    if (ws_ready || rtp_active || push_wanted || mqtt_wanted || trigger_wanted) {
+        int res = AppCam.snapToBuffer(wait);
+        // a still or a trigger holds the buffer; the frame it takes goes to these clients as well
+        if(res == ESP_ERR_TIMEOUT) {
+            Metrics.frames_dropped.inc();
+            return ESP_OK;
+        }
+        // a flash for a still image is not needed any longer
+        PwmFader.endStrobe();
 
         if(!res) {
 
             if(AppCam.isJPEGinBuffer()){
+                int64_t capture_us = esp_timer_get_time();
+
+                if(ws_ready) {
+                    int64_t enqueue_start = esp_timer_get_time();
+                    TRACE_BEGIN("ws_enqueue");
+                    sendFrame(AppCam.getBuffer(), AppCam.getBufferSize());
+                    stillPending = false;
+                    TRACE_END("ws_enqueue");
+                    Metrics.ws_enqueue_us.observe((uint32_t)(esp_timer_get_time() - enqueue_start));
+                }
+
+                if(rtp_active) {
+                    TRACE_SCOPE("rtp_send");
+                    RtpStreamer.sendFrame(AppCam.getBuffer(), AppCam.getBufferSize(), capture_us);
+                }
 
-                ws->binaryAll( AppCam.getBuffer(), AppCam.getBufferSize());
+                if(push_wanted) AppPush.offerFrame(AppCam.getBuffer(), AppCam.getBufferSize());
+                if(mqtt_wanted) AppMqtt.offerFrame(AppCam.getBuffer(), AppCam.getBufferSize());
+                if(trigger_wanted) Triggers.offerFrame(AppCam.getBuffer(), AppCam.getBufferSize(), capture_us);
 
             } else {
 
@@ -227,14 +387,146 @@ int IRAM_ATTR CLAppHttpd::snapToStream(bool debug) {
         return res;
     }
 
+    // the clients are still busy with the previous frame
+    Metrics.frames_dropped.inc();
     return ESP_OK;
 }
 
+bool CLAppHttpd::isControlLaneBusy() {
+    return esp_timer_get_time() - last_control_us < CONTROL_ACTIVE_WINDOW * 1000LL ||
+           control_rtt_us > (uint32_t)control_budget_ms * 1000;
+}
+
+void CLAppHttpd::sendFrame(const uint8_t *buf, size_t len) {
+    uint32_t ctrl = control_client;
+    if(!ctrl) {
+        ws->binaryAll(buf, len);
+        return;
+    }
+
+    // Control and status messages queue behind the frames of the same websocket, and all sockets share 
+    // the air time. A client which has not taken the previous frame yet skips this one: always on the 
+    // control socket, on all the sockets while the control is busy.
+    bool busy = isControlLaneBusy();
+    AsyncWebSocketSharedBuffer frame;
+    for(AsyncWebSocketClient &c : ws->getClients()) {
+        if(c.status() != WS_CONNECTED) continue;
+        if(c.queueLen() > 0 && (busy || c.id() == ctrl)) {
+            control_lane_drops++;
+            Metrics.control_lane_drops.inc();
+            continue;
+        }
+        if(!frame) frame = std::make_shared<std::vector<uint8_t>>(buf, buf + len);
+        c.binary(frame);
+    }
+}
+
+void CLAppHttpd::pingControlClient() {
+    uint32_t ctrl = control_client;
+    if(!ctrl || !ws) return;
+    AsyncWebSocketClient *c = ws->client(ctrl);
+    if(!c || c->status() != WS_CONNECTED) return;
+
+    // the pong echoes the payload; the ping waits behind the frame being sent, like a control message
+    int64_t now = esp_timer_get_time();
+    c->ping((const uint8_t*)&now, sizeof(now));
+    control_pings++;
+}
+
+void CLAppHttpd::onControlPong(uint32_t client_id, const uint8_t *data, size_t len) {
+    if(client_id != control_client || len != sizeof(int64_t)) return;
+
+    int64_t sent;
+    memcpy(&sent, data, sizeof(sent));
+    int64_t rtt = esp_timer_get_time() - sent;
+    if(rtt < 0 || rtt > 60000000LL) return;
+
+    control_rtt_us = (uint32_t)rtt;
+    if(control_rtt_us > control_rtt_max_us) control_rtt_max_us = control_rtt_us;
+    control_pongs++;
+    Metrics.control_rtt_us.observe(control_rtt_us);
+}
+
+void CLAppHttpd::dumpControlToJson(JsonObject json) {
+    json["client"] = (uint32_t)control_client;
+    json["budget_ms"] = control_budget_ms;
+    json["busy"] = isControlLaneBusy();
+    json["rtt_ms"] = control_rtt_us / 1000.0;
+    json["rtt_max_ms"] = control_rtt_max_us / 1000.0;
+    json["pings"] = control_pings;
+    json["pongs"] = control_pongs;
+    json["video_dropped"] = control_lane_drops;
+}
+
+void CLAppHttpd::startCapture() {
+    if(!snap_timer) return;
+
+    // the consumers come and go in the AsyncTCP and the status sampler tasks
+    portENTER_CRITICAL(&capture_mux);
+    bool first = (captureConsumers++ == 0);
+    portEXIT_CRITICAL(&capture_mux);
+
+    // the first consumer starts the capture loop
+    if(first) {
+        if(lampVal>=0 && autoLamp){
+            setLamp(flashLamp);
+            delay(LAMP_SETTLE_TIME); // coupled with the status led flash this gives ~150ms for lamp to settle.
+        }
+        vTimerSetReloadMode(snap_timer, pdTRUE);
+        if(xTimerStart(snap_timer, 0) == pdPASS)
+            Log.info("Stream timer started");
+        else
+            Log.error("Failed to start the Stream timer!");
+    }
+}
+
+void CLAppHttpd::stopCapture() {
+    if(!snap_timer) return;
+
+    portENTER_CRITICAL(&capture_mux);
+    bool last = (captureConsumers > 0 && --captureConsumers == 0);
+    portEXIT_CRITICAL(&capture_mux);
+
+    // the last consumer stops the capture loop
+    if(last) {
+        vTimerSetReloadMode(snap_timer, pdFALSE);
+        if(xTimerStop(snap_timer, 0) == pdPASS)
+            Log.info("Stop sent to Stream timer");
+        else
+            Log.error("Failed to post the stop command to the Stream timer!");
+
+        if(lampVal>0 and autoLamp) setLamp(0);
+    }
+}
+
+int CLAppHttpd::snapStill() {
+    // the lamp goes back to its level as soon as the frame is captured
+    bool strobe = true;
+    if(lampVal>=0 && autoLamp){
+        strobe = (strobeLamp() == OS_SUCCESS);
+        delay(LAMP_SETTLE_TIME);
+    }
+
+    int res = snapToStream(isDebugMode());
+    PwmFader.endStrobe();
+    if(!strobe) setLamp(lampVal, false);
+    return res;
+}
+
 StreamResponseEnum CLAppHttpd::startStream(uint32_t id, CaptureModeEnum streammode) {
     
     // if video stream requested, check if we can add extra
     if(streammode == CAPTURE_STREAM) {
-        if(streamCount+1 > max_streams) return STREAM_NUM_EXCEEDED;
+        // the RTSP sessions share the limit
+        if(streamCount + RtspServer.getPlayingCount() + 1 > max_streams) {
+            admission[REQUEST_STREAM].rejected++;
+            Metrics.streams_rejected.inc();
+            return STREAM_NUM_EXCEEDED;
+        }
+        if(!admitRequest(REQUEST_STREAM, false)) {
+            Metrics.streams_rejected.inc();
+            return STREAM_REJECTED_LOW_HEAP;
+        }
         if(addStreamClient(id) != OS_SUCCESS) return STREAM_CLIENT_REGISTER_FAILED;
     }
 
@@ -243,51 +535,32 @@ StreamResponseEnum CLAppHttpd::startStream(uint32_t id, CaptureModeEnum streammo
     if(streammode == CAPTURE_STREAM) {
 
 
-        Serial.print("Stream start, frame period = "); Serial.println(xTimerGetPeriod(snap_timer));
+        Log.info("Stream start, frame period = %u", (unsigned)xTimerGetPeriod(snap_timer));
         
-        // if stream is not started, start 
-        if(xTimerIsTimerActive(snap_timer) == pdFALSE) {
-            if(lampVal>=0 && autoLamp){
-                setLamp(flashLamp);
-                delay(75); // coupled with the status led flash this gives ~150ms for lamp to settle.
-            }
-            vTimerSetReloadMode(snap_timer, pdTRUE);
-            if(xTimerStart(snap_timer, 0) == pdPASS)
-                Serial.println("Stream timer started");
-            else
-                Serial.println("Failed to start the Stream timer!");
-        }
-
+        startCapture();
         streamCount++;
 
     }
     else if(streammode == CAPTURE_STILL) {
-        Serial.println("Still image requested");
+        Log.info("Still image requested");
+        stillPending = true;
         // if video stream is not active, take the picture as usual
         if(xTimerIsTimerActive(snap_timer) == pdFALSE) {
-            if(lampVal>=0 && autoLamp){
-                setLamp(flashLamp);
-                delay(75); // coupled with the status led flash this gives ~150ms for lamp to settle.
-            }
-
             int64_t fr_start = esp_timer_get_time();
         
-            if (snapToStream(isDebugMode()) != OS_SUCCESS) {
-                if(autoLamp) setLamp(0);
+            if (snapStill() != OS_SUCCESS)
                 return STREAM_IMAGE_CAPTURE_FAILED;
-            }
             
             if (isDebugMode()) {
                 int64_t fr_end = esp_timer_get_time();
-                Serial.printf("B %ums\r\n", (uint32_t)((fr_end - fr_start)/1000));
+                Log.debug("B %ums", (unsigned)((fr_end - fr_start)/1000));
             }
 
-            if(autoLamp) setLamp(0);
             imagesServed++;
             
         }
         else {
-            Serial.println("Image to be taken from the parallel video stream");
+            Log.info("Image to be taken from the parallel video stream");
         }
         
     }
@@ -303,21 +576,12 @@ StreamResponseEnum CLAppHttpd::stopStream(uint32_t id) {
 
     if(!snap_timer) return STREAM_TIMER_NOT_INITIALIZED;
     
-    // if the stream is the last one active, stop the timer
-    if(xTimerIsTimerActive(snap_timer) != pdFALSE && streamCount == 1) {
-        vTimerSetReloadMode(snap_timer, pdFALSE);
-        if(xTimerStop(snap_timer, 0) == pdPASS)
-            Serial.println("Stop sent to Stream timer");
-        else
-            Serial.println("Failed to post the stop command to the Stream timer!");
-
-        if(lampVal>0 and autoLamp) setLamp(0);     
-    }
+    stopCapture();
     
     streamsServed++;
     streamCount--;
     
-    Serial.println("Stream stopped");
+    Log.info("Stream stopped");
     return STREAM_SUCCESS;
 }
 
@@ -337,19 +601,17 @@ void onControl(AsyncWebServerRequest *request) {
     String value = request->arg("val");
 
     if(AppHttpd.isDebugMode()) {
-        Serial.print("Command: var="); Serial.print(variable); 
-        Serial.print(", val="); Serial.println(value);
+        // do not keep the credentials in the log history
+        bool secret = (variable == "password" || variable == "ap_pass" || variable == "pwd" || variable == "ota_password");
+        Log.debug("Command: var=%s, val=%s", variable.c_str(), (secret?"***":value.c_str()));
     }
 
     int res = 0;
     long val = value.toInt();
-    sensor_t * s = AppCam.getSensor();
 
     if(variable == "cmdout") {
-        if(AppHttpd.isDebugMode()) {
-            Serial.print("cmdout=");
-            Serial.println(value.c_str());
-        }
+        if(AppHttpd.isDebugMode()) 
+            Log.debug("cmdout=%s", value.c_str());
         AppHttpd.serialSendCommand(value.c_str());
         request->send(200);
         return;
@@ -359,6 +621,10 @@ void onControl(AsyncWebServerRequest *request) {
             res = AppConn.savePrefs();
         else if(value == "cam") 
             res = AppCam.savePrefs() + AppHttpd.savePrefs(); 
+        else if(value == "push")
+            res = AppPush.savePrefs();
+        else if(value == "mqtt")
+            res = AppMqtt.savePrefs();
         else {
             request->send(400);
             return;
@@ -374,6 +640,10 @@ void onControl(AsyncWebServerRequest *request) {
             res = AppConn.removePrefs(); 
         else if(value == "cam")
             res = AppCam.removePrefs();
+        else if(value == "push")
+            res = AppPush.removePrefs();
+        else if(value == "mqtt")
+            res = AppMqtt.removePrefs();
         else {
             request->send(400);
             return;
@@ -387,7 +657,7 @@ void onControl(AsyncWebServerRequest *request) {
     }
     else if(variable == "reboot") {
         request->send(200);
-        if (AppHttpd.getLamp() != -1) AppHttpd.setLamp(0); // kill the lamp; otherwise it can remain on during the soft-reboot
+        if (AppHttpd.getLamp() != -1) AppHttpd.setLamp(0, false); // kill the lamp; otherwise it can remain on during the soft-reboot
         Storage.getFS().end();      // close file storage
         esp_task_wdt_init(3,true);  // schedule a a watchdog panic event for 3 seconds in the future
         esp_task_wdt_add(NULL);
@@ -395,13 +665,32 @@ void onControl(AsyncWebServerRequest *request) {
         periph_module_disable(PERIPH_I2C1_MODULE);
         periph_module_reset(PERIPH_I2C0_MODULE);
         periph_module_reset(PERIPH_I2C1_MODULE);
-        Serial.print("REBOOT requested");
+        Log.warn("REBOOT requested");
         while(true) {
           delay(200);
-          Serial.print('.');
         }
     }
-    else if(variable == "ssid") {AppConn.setSSID(value.c_str());AppConn.setPassword("");}
+    else if(variable == "mc_join") {
+        if(val) res = Multicast.join(request->client()->remoteIP());
+        else Multicast.leave(request->client()->remoteIP());
+        AppHttpd.touchStatus();
+    }
+    else
+        res = AppHttpd.setControl(variable, value);
+
+    if(res){
+        request->send(400);
+        return;
+    }
+    request->send(200);
+}
+
+int CLAppHttpd::setControl(const String &variable, const String &value) {
+    int res = 0;
+    long val = value.toInt();
+    sensor_t * s = AppCam.getSensor();
+
+    if(variable == "ssid") {AppConn.setSSID(value.c_str());AppConn.setPassword("");}
     else if(variable == "password") AppConn.setPassword(value.c_str());
     else if(variable == "st_ip") AppConn.setStaticIP(&(AppConn.getStaticIP()->ip), value.c_str());
     else if(variable == "st_subnet") AppConn.setStaticIP(&(AppConn.getStaticIP()->netmask), value.c_str());
@@ -414,9 +703,18 @@ void onControl(AsyncWebServerRequest *request) {
     else if(variable == "ap_pass") AppConn.setApPass(value.c_str());
     else if(variable == "mdns_name") AppConn.setMDNSName(value.c_str());
     else if(variable == "ntp_server") AppConn.setNTPServer(value.c_str());
-    else if(variable == "user") AppConn.setUser(value.c_str());
-    else if(variable == "pwd") AppConn.setPwd(value.c_str());
+    else if(variable == "user") {AppConn.setUser(value.c_str()); Session.rotateKey();}
+    else if(variable == "pwd") {AppConn.setPwd(value.c_str()); Session.rotateKey();}
     else if(variable == "ota_password") AppConn.setOTAPassword(value.c_str());
+    else if(variable == "rtp_dest") {
+        res = RtpStreamer.addDestination(value.c_str());
+        if(res == OS_SUCCESS) AppHttpd.startCapture();
+    }
+    else if(variable == "rtp_stop") {
+        int removed = RtpStreamer.removeDestination(value.c_str());
+        if(!removed) res = OS_FAIL;
+        while(removed-- > 0) AppHttpd.stopCapture();
+    }
     else if(variable == "framesize") {
         if(s->pixformat == PIXFORMAT_JPEG) res = s->set_framesize(s, (framesize_t)val);
     }
@@ -447,6 +745,7 @@ void onControl(AsyncWebServerRequest *request) {
     else if(variable ==  "wb_mode") res = s->set_wb_mode(s, val);
     else if(variable ==  "ae_level") res = s->set_ae_level(s, val);
     else if(variable ==  "rotate") AppCam.setRotation(val);
+    else if(variable ==  "log_level") Log.setLevel(val);
     else if(variable ==  "frame_rate") {
         AppCam.setFrameRate(val);
         AppHttpd.updateSnapTimer(val);
@@ -471,11 +770,8 @@ void onControl(AsyncWebServerRequest *request) {
     else {
         res = -1;
     }
-    if(res){
-        request->send(400);
-        return;
-    }
-    request->send(200);
+    if(res == OS_SUCCESS) touchStatus();
+    return res;
 }
 
 void CLAppHttpd::updateSnapTimer(int tps) {
@@ -483,59 +779,220 @@ void CLAppHttpd::updateSnapTimer(int tps) {
         xTimerChangePeriod(snap_timer, 1000/tps/portTICK_PERIOD_MS, 100);
 }
 
-void onInfo(AsyncWebServerRequest *request) {
+bool acceptsMsgPack(AsyncWebServerRequest *request) {
+    return request->hasHeader("Accept") && request->header("Accept").indexOf(MIME_MSGPACK) >= 0;
+}
+
+AsyncResponseStream * beginStatusResponse(AsyncWebServerRequest *request, bool msgpack) {
+    AsyncResponseStream *response = request->beginResponseStream(msgpack?MIME_MSGPACK:"application/json");
+    response->addHeader("Vary", "Accept");
+    return response;
+}
+
+void serializeStatus(JsonDocument &json, AsyncResponseStream *response, bool msgpack) {
+    if(msgpack)
+        serializeMsgPack(json, *response);
+    else
+        serializeJson(json, *response);
+}
+
+void onMetrics(AsyncWebServerRequest *request) {
+    AsyncResponseStream *response = request->beginResponseStream("text/plain; version=0.0.4");
+    Metrics.print(*response);
+    AppHttpd.printMetrics(*response);
+    request->send(response);
+}
+
+void onLog(AsyncWebServerRequest *request) {
+    AsyncResponseStream *response = request->beginResponseStream("text/plain");
+    Log.printHistory(*response);
+    request->send(response);
+}
+
+void onLogTail(const char *line, size_t len) {
+    AppHttpd.sendLogLine(line, len);
+}
+
+#ifdef ENABLE_TRACE
+/**
+ * @brief State of a running trace export. Recording is paused until the export is complete.
+ * 
+ */
+struct TraceExport {
+    enum {HEADER, TASKS, EVENTS, FOOTER, DONE} stage = HEADER;
+    uint32_t next;
+    uint32_t end;
+    bool first_item = true;
+    uint32_t tasks[TRACE_MAX_TASKS];
+    int ntasks = 0;
+
+    TraceExport() {Trace.pause(true); next = Trace.first(); end = Trace.last();};
+    ~TraceExport() {Trace.pause(false);};
+};
+
+void onTrace(AsyncWebServerRequest *request) {
+    if(!Trace.isEnabled()) {
+        request->send(503, "text/plain", "Trace buffer not available");
+        return;
+    }
+
+    std::shared_ptr<TraceExport> state = std::make_shared<TraceExport>();
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/json", 
+        [state](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            char *out = (char*)buffer;
+            size_t written = 0;
+            char item[192];
+
+            while(state->stage != TraceExport::DONE) {
+                int len = 0;
+                switch(state->stage) {
+                    case TraceExport::HEADER:
+                        len = snprintf(item, sizeof(item), "{\"traceEvents\":[");
+                        break;
+                    case TraceExport::TASKS:
+                    case TraceExport::EVENTS:
+                        if(state->next == state->end) break;
+                        item[0] = (state->first_item?' ':',');
+                        if(state->stage == TraceExport::TASKS)
+                            len = Trace.formatTask(state->next, item + 1, sizeof(item) - 1, state->tasks, state->ntasks, TRACE_MAX_TASKS);
+                        else 
+                            len = Trace.format(state->next, item + 1, sizeof(item) - 1);
+                        if(len > 0) len++;
+                        break;
+                    case TraceExport::FOOTER:
+                        len = snprintf(item, sizeof(item), "]}");
+                        break;
+                    default:
+                        break;
+                }
+
+                if(len >= (int)sizeof(item)) len = 0; // truncated; skip it
+                if(written + len > maxLen) break; // continue in the next chunk
+
+                memcpy(out + written, item, len);
+                written += len;
+                if(len > 0 && (state->stage == TraceExport::TASKS || state->stage == TraceExport::EVENTS))
+                    state->first_item = false;
+                // the task is known only once its name is in the output, not when it did not fit in the chunk
+                if(len > 0 && state->stage == TraceExport::TASKS)
+                    state->tasks[state->ntasks++] = Trace.getTid(state->next);
+
+                // advance
+                if(state->stage == TraceExport::TASKS || state->stage == TraceExport::EVENTS) {
+                    if(state->next != state->end) {
+                        state->next++;
+                        continue;
+                    }
+                    if(state->stage == TraceExport::TASKS) {
+                        state->stage = TraceExport::EVENTS;
+                        state->next = Trace.first();
+                        continue;
+                    }
+                }
+                state->stage = (state->stage == TraceExport::HEADER?TraceExport::TASKS:
+                                (state->stage == TraceExport::EVENTS?TraceExport::FOOTER:TraceExport::DONE));
+            }
+            return written;
+        });
+    request->send(response);
+}
+#endif
+
+void onLogin(AsyncWebServerRequest *request) {
+    char token[SESSION_TOKEN_LENGTH + 1];
+    if(!Session.issue(token, sizeof(token))) {
+        request->send(500);
+        return;
+    }
+
     AsyncResponseStream *response = request->beginResponseStream("application/json");
+    response->printf("{\"token\":\"%s\",\"expires_in\":%d}", token, SESSION_LIFETIME);
+    AppHttpd.attachSessionCookie(response, token);
+    request->send(response);
+}
 
-    JsonDocument json;
-    String jsonStr;
+void onInfo(AsyncWebServerRequest *request) {
+    bool msgpack = acceptsMsgPack(request);
+    AsyncResponseStream *response = beginStatusResponse(request, msgpack);
+
+    JsonDocument *json = JsonPool.acquire();
+
+    AppHttpd.dumpCameraStatusToJson(*json);
+    // the viewers find the multicast stream here
+    if(Multicast.isConfigured())
+        Multicast.dumpToJson((*json)["multicast"].to<JsonObject>());
+    serializeStatus(*json, response, msgpack);
+    JsonPool.release(json);
 
-    AppHttpd.dumpCameraStatusToJson(json);
-    serializeJson(json, jsonStr);
-    response->print(jsonStr);
     request->send(response);
 }
 
+void onStreamSDP(AsyncWebServerRequest *request) {
+    if(!Multicast.isConfigured()) {
+        request->send(404, "text/plain", "Multicast not configured");
+        return;
+    }
+    char sdp[320];
+    Multicast.printSDP(sdp, sizeof(sdp));
+    request->send(200, "application/sdp", sdp);
+}
+
 void onStatus(AsyncWebServerRequest *request) {
-    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    bool msgpack = acceptsMsgPack(request);
+
+    // each representation has its own ETag
+    char etag[28];
+    AppHttpd.getStatusETag(etag, sizeof(etag), msgpack);
+
+    // nothing changed since the client has seen the status last time
+    if(request->hasHeader("If-None-Match") && request->header("If-None-Match") == etag) {
+        AsyncWebServerResponse *response = request->beginResponse(304);
+        response->addHeader("ETag", etag);
+        request->send(response);
+        return;
+    }
+
+    AsyncResponseStream *response = beginStatusResponse(request, msgpack);
+    response->addHeader("ETag", etag);
     // Do not get attempt to get sensor when in error; causes a panic..
     
-    JsonDocument json;
-    String jsonStr;
+    JsonDocument *json = JsonPool.acquire();
+
+    AppHttpd.dumpCameraStatusToJson(*json);
+    serializeStatus(*json, response, msgpack);
+    JsonPool.release(json);
 
-    AppHttpd.dumpCameraStatusToJson(json);
-    serializeJson(json, jsonStr);
-    response->print(jsonStr);
     request->send(response);
 }
 
 void onSystemStatus(AsyncWebServerRequest *request) {
-    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    bool msgpack = acceptsMsgPack(request);
+    AsyncResponseStream *response = beginStatusResponse(request, msgpack);
 
-    JsonDocument json;
-    String jsonStr;
+    JsonDocument *json = JsonPool.acquire();
 
-    AppHttpd.dumpSystemStatusToJson(json);
-    serializeJson(json, jsonStr);
-    response->print(jsonStr);
+    AppHttpd.dumpSystemStatusToJson(*json);
+    serializeStatus(*json, response, msgpack);
 
-    if(AppHttpd.isDebugMode()) {
-        Serial.println();
-        Serial.println("Dump requested through web");
-        serializeJsonPretty(json, Serial);
-    }
+    if(AppHttpd.isDebugMode()) 
+        Log.json(LOG_LEVEL_DEBUG, "Dump requested through web: ", *json);
+    JsonPool.release(json);
 
     request->send(response);
 }
 
 void CLAppHttpd::dumpCameraStatusToJson(JsonDocument& json, bool full_status) {
     
+    StatusSnapshot snapshot;
+    getStatusSnapshot(snapshot);
+
     json["cam_name"] = this->getName();
     // json["stream_url"] = this->AppConn.getStreamUrl();
-    AppConn.updateTimeStr();
-    json["local_time"] = AppConn.getLocalTimeStr();
-    json["up_time"] = AppConn.getUpTimeStr();   
-    json["rssi"] = (!AppConn.isAccessPoint()?WiFi.RSSI():(uint8_t)0);
-    json["esp_temp"] = this->getTemp();
+    json["local_time"] = snapshot.local_time;
+    json["up_time"] = snapshot.up_time;   
+    json["rssi"] = snapshot.rssi;
+    json["esp_temp"] = snapshot.temp;
     json["serial_buf"] = this->getSerialBuffer();    
 
     AppCam.dumpStatusToJson(json, full_status);
@@ -552,6 +1009,9 @@ void CLAppHttpd::dumpCameraStatusToJson(JsonDocument& json, bool full_status) {
 
 void CLAppHttpd::dumpSystemStatusToJson(JsonDocument& json) {
     
+    StatusSnapshot snapshot;
+    getStatusSnapshot(snapshot);
+
     json["cam_name"] = this->getName();
     json["code_ver"] = this->getVersion();
     json["base_version"] = BASE_VERSION;
@@ -565,8 +1025,8 @@ void CLAppHttpd::dumpSystemStatusToJson(JsonDocument& json) {
     json["ap_name"] = AppConn.getApName();
     json["ssid"] = AppConn.getSSID();
 
-    json["rssi"] = (!AppConn.isAccessPoint()?WiFi.RSSI():(uint8_t)0);
-    json["bssid"] = (!AppConn.isAccessPoint()?WiFi.BSSIDstr():"");
+    json["rssi"] = snapshot.rssi;
+    json["bssid"] = snapshot.bssid;
     json["dhcp"] = AppConn.isDHCPEnabled();
     
     json["ip_address"] = (AppConn.isAccessPoint()?WiFi.softAPIP().toString():WiFi.localIP().toString());
@@ -596,13 +1056,14 @@ void CLAppHttpd::dumpSystemStatusToJson(JsonDocument& json) {
     snprintf(mac_buf, sizeof(mac_buf), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
     json["mac_address"] = mac_buf;
 
-    AppConn.updateTimeStr();
-    json["local_time"] = AppConn.getLocalTimeStr();
-    json["up_time"] = AppConn.getUpTimeStr();
+    json["local_time"] = snapshot.local_time;
+    json["up_time"] = snapshot.up_time;
     json["ntp_server"] = AppConn.getNTPServer();
     json["gmt_offset"] = AppConn.getGmtOffset_sec();
     json["dst_offset"] = AppConn.getDaylightOffset_sec();
     
+    dumpAdmissionToJson(json["admission"].to<JsonObject>());
+
     json["active_streams"] = AppHttpd.getStreamCount();
     json["prev_streams"] = AppHttpd.getStreamsServed();
     json["img_captured"] = AppHttpd.getImagesServed();
@@ -611,31 +1072,222 @@ void CLAppHttpd::dumpSystemStatusToJson(JsonDocument& json) {
 
     json["cpu_freq"] = ESP.getCpuFreqMHz();
     json["num_cores"] = ESP.getChipCores();
-    json["esp_temp"] = this->getTemp(); // Celsius
+    json["esp_temp"] = snapshot.temp; // Celsius
     json["heap_avail"] = ESP.getHeapSize();
-    json["heap_free"] = ESP.getFreeHeap();
-    json["heap_min_free"] = ESP.getMinFreeHeap();
-    json["heap_max_bloc"] = ESP.getMaxAllocHeap();
+    json["heap_free"] = snapshot.heap_free;
+    json["heap_min_free"] = snapshot.heap_min_free;
+    json["heap_max_bloc"] = snapshot.heap_max_bloc;
+    json["json_pool_peak"] = JsonPool.getPeak();
+    JsonArray cpu_idle = json["cpu_idle"].to<JsonArray>();
+    for(int i=0; i < portNUM_PROCESSORS; i++) cpu_idle.add(snapshot.cpu_idle[i]);
+    json["log_level"] = Log.getLevel();
+    json["log_dropped"] = Log.getDropped();
+    BootProfile.dumpToJson(json["boot"].to<JsonObject>());
+    AppConn.dumpStateToJson(json["wifi"].to<JsonObject>());
+    RtpStreamer.dumpToJson(json["rtp"].to<JsonObject>());
+    RtspServer.dumpToJson(json["rtsp"].to<JsonObject>());
+    AppPush.dumpStatusToJson(json["push"].to<JsonObject>());
+    AppMqtt.dumpStatusToJson(json["mqtt"].to<JsonObject>());
+    ServoMotion.dumpToJson(json["servo"].to<JsonObject>());
+    LedcPlanner.dumpToJson(json["ledc"].to<JsonObject>());
+    PwmFader.dumpToJson(json["fade"].to<JsonObject>());
+    if(Triggers.getCount() > 0)
+        Triggers.dumpToJson(json["triggers"].to<JsonObject>());
+    dumpControlToJson(json["control"].to<JsonObject>());
 
     json["psram_found"] = psramFound();
     json["psram_size"] = (psramFound()?ESP.getPsramSize():0);
-    json["psram_free"] = (psramFound()?ESP.getFreePsram():0);
-    json["psram_min_free"] = (psramFound()?ESP.getMinFreePsram():0);
-    json["psram_max_bloc"] = (psramFound()?ESP.getMaxAllocPsram():0);
+    json["psram_free"] = snapshot.psram_free;
+    json["psram_min_free"] = snapshot.psram_min_free;
+    json["psram_max_bloc"] = snapshot.psram_max_bloc;
 
     json["xclk"] = AppCam.getXclk();
 
     json["storage_size"] = Storage.getSize();
-    json["storage_used"] = Storage.getUsed();
+    json["storage_used"] = snapshot.storage_used;
     json["storage_units"] = (Storage.capacityUnits()==STORAGE_UNITS_MB?(char*)"MB":(char*)"");
 
     json["serial_buf"] = getSerialBuffer();
 
 }
 
+void CLAppHttpd::sampleStatus(bool with_storage) {
+    StatusSnapshot s;
+    // start from the previous sample, so the values which are not refreshed this time are kept
+    getStatusSnapshot(s);
+
+    Metrics.sampleCpuLoad();
+    for(int i=0; i < portNUM_PROCESSORS; i++) s.cpu_idle[i] = Metrics.getCpuIdle(i);
+
+    bool sta = !AppConn.isAccessPoint();
+    s.rssi = (sta?WiFi.RSSI():0);
+    s.temp = getTemp();
+    snprintf(s.bssid, sizeof(s.bssid), "%s", (sta?WiFi.BSSIDstr().c_str():""));
+
+    s.heap_free = ESP.getFreeHeap();
+    s.heap_min_free = ESP.getMinFreeHeap();
+    s.heap_max_bloc = ESP.getMaxAllocHeap();
+
+    bool psram = psramFound();
+    s.psram_free = (psram?ESP.getFreePsram():0);
+    s.psram_min_free = (psram?ESP.getMinFreePsram():0);
+    s.psram_max_bloc = (psram?ESP.getMaxAllocPsram():0);
+
+    if(with_storage) s.storage_used = Storage.getUsed();
+
+    AppConn.updateTimeStr();
+    snprintf(s.local_time, sizeof(s.local_time), "%s", AppConn.getLocalTimeStr().c_str());
+    snprintf(s.up_time, sizeof(s.up_time), "%s", AppConn.getUpTimeStr().c_str());
+
+    portENTER_CRITICAL(&status_mux);
+    // only the values reported by /status are relevant for its ETag; the clock is ignored
+    if(s.rssi != status.rssi || s.temp != status.temp) 
+        s.generation = status.generation + 1;
+    else
+        s.generation = status.generation;
+    status = s;
+    portEXIT_CRITICAL(&status_mux);
+}
+
+void CLAppHttpd::getStatusSnapshot(StatusSnapshot &snapshot) {
+    portENTER_CRITICAL(&status_mux);
+    snapshot = status;
+    portEXIT_CRITICAL(&status_mux);
+}
+
+void CLAppHttpd::touchStatus() {
+    portENTER_CRITICAL(&status_mux);
+    status.generation++;
+    portEXIT_CRITICAL(&status_mux);
+}
+
+void CLAppHttpd::getStatusETag(char *buf, size_t len, bool msgpack) {
+    portENTER_CRITICAL(&status_mux);
+    uint32_t generation = status.generation;
+    portEXIT_CRITICAL(&status_mux);
+    snprintf(buf, len, "\"%08x-%u%s\"", (unsigned)boot_id, (unsigned)generation, (msgpack?"-m":""));
+}
+
+int CLAppHttpd::sendStatusMsgPack(uint32_t client_id) {
+    JsonDocument *json = JsonPool.acquire();
+    dumpCameraStatusToJson(*json, false);
+
+    size_t len = measureMsgPack(*json);
+    uint8_t *buf = (uint8_t*)malloc(len);
+    if(!buf) {
+        JsonPool.release(json);
+        return OS_FAIL;
+    }
+    serializeMsgPack(*json, buf, len);
+    JsonPool.release(json);
+
+    ws->binary(client_id, buf, len);
+    free(buf);
+    return OS_SUCCESS;
+}
+
+RequestClassEnum CLAppHttpd::classifyRequest(AsyncWebServerRequest *request) {
+    const String& url = request->url();
+    if(url == "/control" || url == "/ws" || url == "/login")
+        return REQUEST_CONTROL;
+    if(url == "/status" || url == "/system" || url == "/info" || url == "/metrics" || url == "/trace" || url == "/log" ||
+       url == "/stream.sdp")
+        return REQUEST_STATUS;
+    if(url == "/capture")
+        return REQUEST_STREAM;
+    return REQUEST_STATIC;
+}
+
+bool CLAppHttpd::admitRequest(RequestClassEnum cls, bool track) {
+    AdmissionClass &ac = admission[cls];
+    if((track && ac.active >= ac.max_active) || ESP.getFreeHeap() < ac.min_heap) {
+        ac.rejected++;
+        return false;
+    }
+    if(track) ac.active++;
+    return true;
+}
+
+void CLAppHttpd::releaseRequest(RequestClassEnum cls) {
+    if(admission[cls].active > 0) admission[cls].active--;
+}
+
+void CLAppHttpd::dumpAdmissionToJson(JsonObject json) {
+    for(int i=0; i < REQUEST_CLASS_COUNT; i++) {
+        JsonObject ac = json[request_class_names[i]].to<JsonObject>();
+        ac["max"] = admission[i].max_active;
+        ac["min_heap"] = admission[i].min_heap;
+        ac["active"] = admission[i].active;
+        ac["rejected"] = admission[i].rejected;
+    }
+}
+
+void CLAppHttpd::printMetrics(Print &out) {
+    out.printf("# HELP esp32cam_active_streams Video streams currently served\n"
+               "# TYPE esp32cam_active_streams gauge\nesp32cam_active_streams %d\n", streamCount);
+
+    out.print("# HELP esp32cam_requests_rejected_total Requests rejected by the admission control\n"
+              "# TYPE esp32cam_requests_rejected_total counter\n");
+    for(int i=0; i < REQUEST_CLASS_COUNT; i++)
+        out.printf("esp32cam_requests_rejected_total{class=\"%s\"} %u\n", 
+                   request_class_names[i], (unsigned)admission[i].rejected);
+}
+
+bool CLAppHttpd::hasValidSession(AsyncWebServerRequest *request) {
+    size_t len = 0;
+    const char *token = NULL;
+
+    const String& auth = request->header("Authorization");
+    if(auth.startsWith("Bearer ")) {
+        token = auth.c_str() + 7;
+        len = auth.length() - 7;
+    }
+    else if(request->hasParam("token")) {
+        // websocket clients outside of the browser can not always set headers
+        const String& t = request->getParam("token")->value();
+        token = t.c_str();
+        len = t.length();
+    }
+    else if(request->hasHeader("Cookie")) {
+        token = CLSession::findCookie(request->header("Cookie").c_str(), &len);
+    }
+
+    return Session.validate(token, len);
+}
+
+void CLAppHttpd::attachSessionCookie(AsyncWebServerResponse *response, const char *token) {
+    if(!response) return;
+
+    char buf[SESSION_TOKEN_LENGTH + 1];
+    if(!token) {
+        if(!Session.issue(buf, sizeof(buf))) return;
+        token = buf;
+    }
+
+    char cookie[SESSION_TOKEN_LENGTH + 80];
+    snprintf(cookie, sizeof(cookie), SESSION_COOKIE "=%s; Path=/; Max-Age=%d; HttpOnly; SameSite=Strict", 
+             token, SESSION_LIFETIME);
+    response->addHeader("Set-Cookie", cookie);
+}
+
 void CLAppHttpd::serialSendCommand(const char *cmd) {
-    Serial.print("^");
-    Serial.println(cmd);
+    // goes through the logger to keep the order with the log messages on Serial
+    Log.raw(cmd, "^");
+}
+
+void CLAppHttpd::sendLogLine(const char *line, size_t len) {
+    uint32_t id = log_client;
+    if(id && ws) ws->text(id, line, len);
+}
+
+void CLAppHttpd::sendControlEvent(const char *msg, size_t len) {
+    uint32_t id = control_client;
+    if(id && ws) ws->text(id, msg, len);
+}
+
+void CLAppHttpd::sendControlFrame(const uint8_t *buf, size_t len) {
+    uint32_t id = control_client;
+    if(id && ws) ws->binary(id, buf, len);
 }
 
 int CLAppHttpd::loadPrefs() {
@@ -648,33 +1300,99 @@ int CLAppHttpd::loadPrefs() {
     json_obj_get_int(&jctx, (char*)"lamp", &lampVal);
     json_obj_get_bool(&jctx, (char*)"autolamp", &autoLamp);
     json_obj_get_int(&jctx, (char*)"flashlamp", &flashLamp);
+    float gamma;
+    if(json_obj_get_float(&jctx, (char*)"lamp_gamma", &gamma) == OS_SUCCESS)
+        PwmFader.setGamma(gamma);
     json_obj_get_int(&jctx, (char*)"max_streams", &max_streams);
+    json_obj_get_int(&jctx, (char*)"rtsp_port", &rtsp_port);
+    json_obj_get_int(&jctx, (char*)"control_budget_ms", &control_budget_ms);
+
+    int log_level;
+    if(json_obj_get_int(&jctx, (char*)"log_level", &log_level) == OS_SUCCESS)
+        Log.setLevel(log_level);
+
+    if(json_obj_get_object(&jctx, (char*)"admission") == OS_SUCCESS) {
+        for(int i=0; i < REQUEST_CLASS_COUNT; i++) {
+            if(json_obj_get_object(&jctx, (char*)request_class_names[i]) == OS_SUCCESS) {
+                int min_heap;
+                json_obj_get_int(&jctx, (char*)"max", &admission[i].max_active);
+                if(json_obj_get_int(&jctx, (char*)"min_heap", &min_heap) == OS_SUCCESS)
+                    admission[i].min_heap = min_heap;
+                json_obj_leave_object(&jctx);
+            }
+        }
+        json_obj_leave_object(&jctx);
+    }
+
+    if(json_obj_get_object(&jctx, (char*)"multicast") == OS_SUCCESS) {
+        char group[16] = "";
+        int port = MULTICAST_DEFAULT_PORT, fec = MULTICAST_DEFAULT_FEC;
+        bool always_on = false;
+        json_obj_get_string(&jctx, (char*)"group", group, sizeof(group));
+        json_obj_get_int(&jctx, (char*)"port", &port);
+        json_obj_get_int(&jctx, (char*)"fec", &fec);
+        json_obj_get_bool(&jctx, (char*)"always_on", &always_on);
+        Multicast.setConfig(group, port, fec, always_on);
+        json_obj_leave_object(&jctx);
+    }
 
     int count = 0, pin = 0, freq = 0, resolution = 0, def_val = 0;
 
+    // the camera clock (XCLK) runs on LEDC timer 0
+    LedcPlanner.reserveTimer(LEDC_CAMERA_TIMER);
+
     if(json_obj_get_array(&jctx, (char*)"pwm", &count) == OS_SUCCESS) {
 
+        // plan the LEDC channels of all outputs before attaching any of them
+        int request[NUM_PWM];
+        for(int i=0; i < count && i < NUM_PWM; i++) {
+            request[i] = -1;
+            if(json_arr_get_object(&jctx, i) == OS_SUCCESS) {
+                if(json_obj_get_int(&jctx, (char*)"frequency", &freq) == OS_SUCCESS &&
+                    json_obj_get_int(&jctx, (char*)"resolution", &resolution) == OS_SUCCESS) {
+                    request[i] = LedcPlanner.add(freq, resolution);
+                    if(request[i] < 0)
+                        Log.error("PWM entry %d: %d Hz with %d bits is not possible", i, freq, resolution);
+                }
+                json_arr_leave_object(&jctx);
+            }
+        }
+        int unplaced = LedcPlanner.plan();
+        if(unplaced > 0)
+            Log.error("%d PWM output(s) do not fit in the free LEDC timers", unplaced);
+
         for(int i=0; i < count && i < NUM_PWM; i++) 
             if(json_arr_get_object(&jctx, i) == OS_SUCCESS) {
                 if(json_obj_get_int(&jctx, (char*)"pin", &pin) == OS_SUCCESS &&
                     json_obj_get_int(&jctx, (char*)"frequency", &freq) == OS_SUCCESS &&
                     json_obj_get_int(&jctx, (char*)"resolution", &resolution) == OS_SUCCESS) {
-                    int index = attachPWM(pin, freq, resolution);
+                    int channel = LedcPlanner.getChannel(request[i]);
+                    int index = (channel >= 0?attachPWM(pin, freq, resolution, channel):OS_FAIL);
                     delay(75); // let the PWM settle
                     if(index >= 0) {
                         if(lampVal >= 0 && i == 0) {
                             lamppin = pin;
                             pwmMax = pow(2, resolution)-1;
-                            Serial.printf("Flash lamp activated on pin %d\r\n", lamppin);
+                            Log.info("Flash lamp activated on pin %d", lamppin);
                         }
 
                         if(json_obj_get_int(&jctx, (char*)"default", &def_val) == OS_SUCCESS)  {
                             pwm[index]->setDefaultDuty(def_val);
                             pwm[index]->reset();
                         }
+
+                        int fade = 0;
+                        if(json_obj_get_int(&jctx, (char*)"fade", &fade) == OS_SUCCESS)
+                            PwmFader.setFadeTime(pin, fade);
+
+                        int velocity = 0, acceleration = 0;
+                        json_obj_get_int(&jctx, (char*)"velocity", &velocity);
+                        json_obj_get_int(&jctx, (char*)"acceleration", &acceleration);
+                        if(velocity > 0 || acceleration > 0)
+                            ServoMotion.setLimits(pin, velocity, acceleration);
                     }
                     else
-                        Serial.printf("Failed to attach PWM to pin %d\r\n", pin);
+                        Log.error("Failed to attach PWM to pin %d", pin);
                 }
                 json_arr_leave_object(&jctx);
             }
@@ -683,6 +1401,32 @@ int CLAppHttpd::loadPrefs() {
     }
     
 
+    if(json_obj_get_array(&jctx, (char*)"triggers", &count) == OS_SUCCESS) {
+
+        for(int i=0; i < count && i < TRIGGER_MAX_INPUTS; i++) 
+            if(json_arr_get_object(&jctx, i) == OS_SUCCESS) {
+                char edge[16] = "rising", pull[16] = "none", action[16] = "still";
+                int debounce = TRIGGER_DEFAULT_DEBOUNCE, frames = TRIGGER_DEFAULT_BURST, duration = TRIGGER_DEFAULT_DURATION;
+                json_obj_get_string(&jctx, (char*)"edge", edge, sizeof(edge));
+                json_obj_get_string(&jctx, (char*)"pull", pull, sizeof(pull));
+                json_obj_get_string(&jctx, (char*)"action", action, sizeof(action));
+                json_obj_get_int(&jctx, (char*)"debounce", &debounce);
+                json_obj_get_int(&jctx, (char*)"count", &frames);
+                json_obj_get_int(&jctx, (char*)"duration", &duration);
+
+                int e = CLTriggers::parseEdge(edge), p = CLTriggers::parsePull(pull), a = CLTriggers::parseAction(action);
+                if(json_obj_get_int(&jctx, (char*)"pin", &pin) != OS_SUCCESS || e < 0 || p < 0 || a < 0)
+                    Log.error("Trigger %d is not valid", i);
+                else if(getPWM(pin))
+                    Log.error("Trigger pin %d is used by a PWM", pin);
+                else if(Triggers.add(pin, e, p, (TriggerActionEnum)a, debounce, frames, duration) != OS_SUCCESS)
+                    Log.error("Failed to add the trigger on pin %d", pin);
+                json_arr_leave_object(&jctx);
+            }
+
+        json_obj_leave_array(&jctx);
+    }
+
     if (json_obj_get_array(&jctx, (char*)"mapping", &mappingCount) == OS_SUCCESS) {
 
         for(int i=0; i < mappingCount && i < MAX_URI_MAPPINGS; i++) {
@@ -711,13 +1455,14 @@ int CLAppHttpd::loadPrefs() {
 }
 
 int CLAppHttpd::savePrefs() {
+    TRACE_SCOPE("prefs_save");
     JsonDocument json;
     char* prefs_file = getPrefsFileName(true); 
     
     if (Storage.exists(prefs_file)) {
-        Serial.printf("Updating %s\r\n", prefs_file);
+        Log.info("Updating %s", prefs_file);
     } else {
-        Serial.printf("Creating %s\r\n", prefs_file);
+        Log.info("Creating %s", prefs_file);
     }
 
     json["my_name"] = myName;
@@ -725,7 +1470,18 @@ int CLAppHttpd::savePrefs() {
     json["lamp"] = lampVal;
     json["autolamp"] = autoLamp;
     json["flashlamp"] = flashLamp;
+    json["lamp_gamma"] = PwmFader.getGamma();
     json["max_streams"] = max_streams;
+    json["rtsp_port"] = rtsp_port;
+    json["control_budget_ms"] = control_budget_ms;
+    if(Multicast.isConfigured())
+        Multicast.dumpPrefsToJson(json["multicast"].to<JsonObject>());
+    json["log_level"] = Log.getLevel();
+
+    for(int i=0; i < REQUEST_CLASS_COUNT; i++) {
+        json["admission"][request_class_names[i]]["max"] = admission[i].max_active;
+        json["admission"][request_class_names[i]]["min_heap"] = admission[i].min_heap;
+    }
 
     if(pwmCount > 0) {
         json["pwm"].as<JsonArray>();
@@ -736,9 +1492,14 @@ int CLAppHttpd::savePrefs() {
                 json["pwm"][i]["resolution"] = pwm[i]->getResolutionBits();
                 if(pwm[i]->getDefaultDuty())
                   json["pwm"][i]["default"] = pwm[i]->getDefaultDuty();
+                if(PwmFader.getFadeTime(pwm[i]->getPin()))
+                  json["pwm"][i]["fade"] = PwmFader.getFadeTime(pwm[i]->getPin());
             }
     }
 
+    if(Triggers.getCount() > 0)
+        Triggers.dumpPrefsToJson(json["triggers"].to<JsonArray>());
+
     if(mappingCount > 0) {
         json["mapping"].as<JsonArray>();
         for(int i=0; i < mappingCount; i++) {
@@ -750,53 +1511,64 @@ int CLAppHttpd::savePrefs() {
 
     File file = Storage.open(prefs_file, FILE_WRITE);
     if(file) {
-        serializeJsonPretty(json, Serial);
-        Serial.println();
-
         serializeJson(json, file);
         file.close();
         
-        Serial.printf("File %s updated\r\n", prefs_file);
+        Log.info("File %s updated", prefs_file);
+        Log.json(LOG_LEVEL_DEBUG, "Config: ", json);
         return OK;
     }
     else {
-        Serial.printf("Failed to save web server preferences to file %s\r\n", prefs_file);
+        Log.error("Failed to save web server preferences to file %s", prefs_file);
         return FAIL;
     }
 }
 
-int CLAppHttpd::attachPWM(uint8_t pin, double freq, uint8_t resolution_bits) {
+int CLAppHttpd::attachPWM(uint8_t pin, double freq, uint8_t resolution_bits, int channel) {
 
     if(pwmCount >= NUM_PWM) {
-        Serial.println("Number of available PWM channels exceeded");
+        Log.error("Number of available PWM channels exceeded");
         return OS_FAIL;
     }
 
-    for(int i=0; i<pwmCount; i++) 
-        if(pwm[i]->getPin() == pin) {
-            Serial.printf("Pin %d already utilized\r\n");
-            return OS_FAIL; // pin already used
-        }
+    if(pin >= SOC_GPIO_PIN_COUNT) {
+        Log.error("Pin %d is not valid", pin);
+        return OS_FAIL;
+    }
+
+    if(pwmIndex[pin] >= 0) {
+        Log.error("Pin %d already utilized", pin);
+        return OS_FAIL; // pin already used
+    }
+
+    if(channel < 0) 
+        channel = LedcPlanner.allocate(freq, resolution_bits);
+
+    if(channel < 0) {
+        Log.error("No LEDC channel left for %.2f Hz with %d bits", freq, resolution_bits);
+        return OS_FAIL;
+    }
 
     ESP32PWM * newpwm = new ESP32PWM();
     if(!newpwm) {
-        Serial.println("Failed to create PWM"); 
+        Log.error("Failed to create PWM"); 
         delete newpwm;
         return OS_FAIL;
     }
     
-    newpwm->attachPin(pin, freq, resolution_bits);
+    newpwm->attachPin(pin, freq, resolution_bits, channel);
 
     if(!newpwm->attached()) {
-        Serial.print("Failed to attach PWM on pin "); Serial.println(pin);
+        Log.error("Failed to attach PWM on pin %d", pin);
         delete newpwm;
         return OS_FAIL;
     }
 
-    Serial.printf("Created a new PWM channel %d on pin %d (freq=%.2f, bits=%d)\r\n", 
+    Log.info("Created a new PWM channel %d on pin %d (freq=%.2f, bits=%d)", 
         newpwm->getChannel(), pin, freq, resolution_bits);
 
     pwm[pwmCount] = newpwm;
+    pwmIndex[pin] = pwmCount;
 
     pwmCount++;
 
@@ -804,72 +1576,102 @@ int CLAppHttpd::attachPWM(uint8_t pin, double freq, uint8_t resolution_bits) {
 }
 
 int CLAppHttpd::writePWM(uint8_t pin, int value, int min_v, int max_v) {
-    for(int i=0; i<pwmCount; i++) {
-        if(pwm[i] && pwm[i]->getPin() == pin) {
-            if(pwm[i]->attached()) {
-                if(min_v > 0) {
-                    // treat values less than MIN_PULSE_WIDTH (500) as angles in degrees 
-                    // (valid values in microseconds are handled as microseconds)
-                    if (value < MIN_PULSE_WIDTH)
-                    {
-                        if (value < 0)
-                            value = 0;
-                        else if (value > 180)
-                            value = 180;
-
-                        value = map(value, 0, 180, min_v, max_v);
+    ESP32PWM *p = getPWM(pin);
+    if(!p) {
+        Log.warn("PWM write failed: pin %d is not found", pin);
+        return OS_FAIL;
+    }
+    if(!p->attached()) {
+        Log.warn("PWM write failed: pin %d is not attached", pin);
+        return OS_FAIL;    
+    }
 
-                    }
-                    if (value < min_v)          // ensure pulse width is valid
-                        value = min_v;
-                    else if (value > max_v)
-                        value = max_v;
+    if(min_v > 0) {
+        // treat values less than MIN_PULSE_WIDTH (500) as angles in degrees 
+        // (valid values in microseconds are handled as microseconds)
+        if (value < MIN_PULSE_WIDTH)
+        {
+            if (value < 0)
+                value = 0;
+            else if (value > 180)
+                value = 180;
 
-                    value = pwm[i]->usToTicks(value);  // convert to ticks
+            value = map(value, 0, 180, min_v, max_v);
 
-                }
-                // do the actual write
-                if(isDebugMode())
-                    Serial.printf("Write %d to PWM channel %d pin %d min %d max %d\r\n", 
-                                  value, pwm[i]->getChannel(), pwm[i]->getPin(), min_v, max_v);
-                pwm[i]->write(value);
-                return OS_SUCCESS;
-            }
-            else {
-                Serial.printf("PWM write failed: pin %d is not attached", pin);
-                return OS_FAIL;    
-            }
         }
+        if (value < min_v)          // ensure pulse width is valid
+            value = min_v;
+        else if (value > max_v)
+            value = max_v;
+
+        // a direct write overrides a move in progress; the interpolator waits until it is written
+        ServoMotion.lockWrites();
+        ServoMotion.setPosition(pin, value);
+
+        value = p->usToTicks(value);  // convert to ticks
+
     }
-    
-    Serial.printf("PWM write failed: pin %d is not found", pin);
-    return OS_FAIL;
+    // do the actual write
+    if(isDebugMode())
+        Log.debug("Write %d to PWM channel %d pin %d min %d max %d", 
+                      value, p->getChannel(), p->getPin(), min_v, max_v);
+    // a dimmable output ramps to the new duty in hardware
+    if(min_v <= 0 && PwmFader.getFadeTime(pin) > 0 &&
+       PwmFader.fadeTo(p, value, PwmFader.getFadeTime(pin)) == OS_SUCCESS) {
+        touchStatus();
+        return OS_SUCCESS;
+    }
+    p->write(value);
+    if(min_v > 0) ServoMotion.unlockWrites();
+    touchStatus();
+    return OS_SUCCESS;
 }
 
 void CLAppHttpd::resetPWM(uint8_t pin) {
+    ServoMotion.lockWrites();
+    ServoMotion.stop(pin);
     for(int i=0; i<pwmCount; i++) {
         if(pwm[i]->getPin() == pin || pin == RESET_ALL_PWM)
             pwm[i]->reset();
     }
+    ServoMotion.unlockWrites();
+    touchStatus();
 }
 
 
 // Lamp Control
-void CLAppHttpd::setLamp(int newVal) {
+void CLAppHttpd::setLamp(int newVal, bool fade) {
+    TRACE_SCOPE("lamp");
 
     if(newVal == DEFAULT_FLASH) {
         newVal = flashLamp;
     }
     lampVal = newVal;
+    touchStatus();
     
-    // Apply a logarithmic function to the scale.
-    if(lamppin) {
-        int brightness = round(lampVal * pwmMax/100.00);
-        writePWM(lamppin, brightness,0);
+    // Apply the gamma curve to the scale, the brightness then looks linear.
+    ESP32PWM *p = (lamppin?getPWM(lamppin):NULL);
+    if(p) {
+        uint32_t brightness = PwmFader.percentToDuty(lampVal, pwmMax);
+        if(PwmFader.fadeTo(p, brightness, fade?PwmFader.getFadeTime(lamppin):0) != OS_SUCCESS)
+            writePWM(lamppin, brightness, 0);
     }
 
 }
 
+int CLAppHttpd::strobeLamp() {
+    TRACE_SCOPE("lamp");
+
+    ESP32PWM *p = (lamppin?getPWM(lamppin):NULL);
+    if(!p) return OS_SUCCESS;
+
+    uint32_t flash = PwmFader.percentToDuty(flashLamp, pwmMax);
+    if(PwmFader.strobe(p, flash, PwmFader.percentToDuty(lampVal, pwmMax)) == OS_SUCCESS)
+        return OS_SUCCESS;
+    writePWM(lamppin, flash, 0);
+    return OS_FAIL;
+}
+
 int CLAppHttpd::addStreamClient(uint32_t client_id) {
     for(int i=0; i < max_streams; i++) {
         if(!stream_clients[i]) {
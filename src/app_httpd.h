@@ -4,6 +4,7 @@
 #include <esp_int_wdt.h>
 #include <esp_task_wdt.h>
 #include <freertos/timers.h>
+#include <soc/soc_caps.h>
 
 #include <esp32pwm.h>
 #include <ESPAsyncWebServer.h>
@@ -11,6 +12,19 @@
 #include <app_conn.h>
 #include <app_cam.h>
 #include <ArduinoJson.h>
+#include <json_pool.h>
+#include <session.h>
+#include <logger.h>
+#include <boot_profile.h>
+#include <rtp.h>
+#include <rtsp.h>
+#include <multicast.h>
+#include <app_push.h>
+#include <app_mqtt.h>
+#include <servo_motion.h>
+#include <ledc_plan.h>
+#include <pwm_fade.h>
+#include <trigger.h>
 
 #define MAX_URI_MAPPINGS                32
 
@@ -28,6 +42,34 @@
 
 #define MAX_VIDEO_STREAMS               5
 
+// Admission control defaults. Control requests get the lowest heap reserve, so they still pass when 
+// static assets and status polls are already rejected; there is no other precedence between the classes.
+// A browser loads a page with up to 6 parallel connections per host and does not retry the subresources
+// on Retry-After, so the static class admits at least as many.
+#define ADMISSION_RETRY_AFTER           "2"     // seconds
+#define ADMISSION_STREAM_MAX            2
+#define ADMISSION_STREAM_MIN_HEAP       24000
+#define ADMISSION_CONTROL_MAX           4
+#define ADMISSION_CONTROL_MIN_HEAP      8000
+#define ADMISSION_STATIC_MAX            8
+#define ADMISSION_STATIC_MIN_HEAP       32000
+#define ADMISSION_STATUS_MAX            2
+#define ADMISSION_STATUS_MIN_HEAP       16000
+
+#define TRACE_MAX_TASKS                 24      // tasks named in a trace export
+
+#define MIME_MSGPACK                    "application/msgpack"
+
+#define STATUS_SAMPLE_INTERVAL          1000    // ms between two status samples
+#define STATUS_STORAGE_INTERVAL         30000   // ms between two storage usage samples (slow on SD cards)
+#define STATUS_SAMPLER_STACK_SIZE       4096
+#define STATUS_SAMPLER_PRIORITY         1
+
+// Control priority lane. While the control client is active, or if its round trip exceeds the budget,
+// a client gets no new video frame as long as the previous one is still queued.
+#define CONTROL_LATENCY_BUDGET          100     // ms
+#define CONTROL_ACTIVE_WINDOW           1000    // ms after a control command
+
 
 enum CaptureModeEnum {CAPTURE_STILL, CAPTURE_STREAM};
 enum StreamResponseEnum {STREAM_SUCCESS, 
@@ -36,15 +78,29 @@ enum StreamResponseEnum {STREAM_SUCCESS,
                          STREAM_TIMER_NOT_INITIALIZED,
                          STREAM_MODE_NOT_SUPPORTED, 
                          STREAM_IMAGE_CAPTURE_FAILED,
-                         STREAM_CLIENT_NOT_FOUND};
+                         STREAM_CLIENT_NOT_FOUND,
+                         STREAM_REJECTED_LOW_HEAP};
+
+/**
+ * @brief Classes of requests, which are subject of the admission control
+ * 
+ */
+enum RequestClassEnum {REQUEST_STREAM, REQUEST_CONTROL, REQUEST_STATIC, REQUEST_STATUS, REQUEST_CLASS_COUNT};
 
 String processor(const String& var);
 void onSystemStatus(AsyncWebServerRequest *request);
 void onStatus(AsyncWebServerRequest *request);
 void onInfo(AsyncWebServerRequest *request);
+void onStreamSDP(AsyncWebServerRequest *request);
+void onLogin(AsyncWebServerRequest *request);
+void onMetrics(AsyncWebServerRequest *request);
+void onLog(AsyncWebServerRequest *request);
+void onLogTail(const char *line, size_t len);
+void onTrace(AsyncWebServerRequest *request);
 void onControl(AsyncWebServerRequest *request);
 void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len);
 void onSnapTimer(TimerHandle_t pxTimer);
+void statusSamplerTask(void *pvParameters);
 
 
 
@@ -54,6 +110,35 @@ void onSnapTimer(TimerHandle_t pxTimer);
  */
 struct UriMapping { char uri[32]; char path[32];};
 
+/**
+ * @brief Admission limits and counters of one request class
+ * 
+ */
+struct AdmissionClass { int max_active; uint32_t min_heap; int active; uint32_t rejected; };
+
+/**
+ * @brief Snapshot of the volatile values reported by /status and /system. 
+ * It is refreshed by the status sampler task on a fixed cadence, so the request handlers only 
+ * need to serialize it instead of querying WiFi, sensors, heap and storage on every request.
+ * 
+ */
+struct StatusSnapshot {
+    uint32_t generation;        // incremented each time the sampled values change
+    int rssi;
+    uint8_t temp;
+    char bssid[18];
+    uint32_t heap_free;
+    uint32_t heap_min_free;
+    uint32_t heap_max_bloc;
+    uint32_t psram_free;
+    uint32_t psram_min_free;
+    uint32_t psram_max_bloc;
+    uint8_t cpu_idle[portNUM_PROCESSORS];   // percent
+    int storage_used;
+    char local_time[64];
+    char up_time[48];
+};
+
 
 /** 
  * @brief WebServer Manager
@@ -75,25 +160,64 @@ class CLAppHttpd : public CLAppComponent {
         int removeStreamClient(uint32_t client_id);
 
         uint32_t getControlClient() {return control_client;};
-        void setControlClient(uint32_t id) {control_client = id;};
+        void setControlClient(uint32_t id) {control_client = id; control_rtt_us = 0;};
+
+        // client receiving the log messages over the websocket
+        uint32_t getLogClient() {return log_client;};
+        void setLogClient(uint32_t id) {log_client = id;};
 
         int8_t getStreamCount() {return streamCount;};
+        int getMaxStreams() {return max_streams;};
         long getStreamsServed() {return streamsServed;};
         unsigned long getImagesServed() {return imagesServed;};
         int getPwmCount() {return pwmCount;};
         void incImagesServed(){imagesServed++;};
         
-        // capture image and send it to the clients
-        int snapToStream(bool debug = false);
+        // capture image and send it to the clients; the snap timer does not wait for a frame taken by another task
+        int snapToStream(bool debug = false, TickType_t wait = portMAX_DELAY);
+        // capture a still image outside of the capture loop, flashing the lamp if autolamp is set
+        int snapStill();
         // start stream
         StreamResponseEnum startStream(uint32_t id, CaptureModeEnum stream_mode);
         //terminate stream
         StreamResponseEnum stopStream(uint32_t id);
 
+        // register/unregister a consumer of the captured frames (video stream, RTP destination).
+        // The capture loop runs as long as there is at least one consumer.
+        void startCapture();
+        void stopCapture();
+        bool isCapturing() {return captureConsumers > 0;};
+
         void updateSnapTimer(int frameRate);
 
+        /**
+         * @brief Sets a control variable (see /control in API.md). Commands which need the request
+         * (save_prefs, reboot etc.) are handled by onControl() only.
+         * 
+         * @param variable name of the variable
+         * @param value new value
+         * @return int OS_SUCCESS, or an error code if the variable is unknown or the value was rejected
+         */
+        int setControl(const String &variable, const String &value);
+
         void serialSendCommand(const char * cmd);
 
+        // sends a log line to the client tailing the log; called by the log drain task
+        void sendLogLine(const char *line, size_t len);
+
+        // sends an event (servo position, arrival) as a text frame to the control client
+        void sendControlEvent(const char *msg, size_t len);
+        // sends a binary frame (v2 acknowledgement) to the control client
+        void sendControlFrame(const uint8_t *buf, size_t len);
+
+        // marks the arrival of a control command; video yields to the control messages for a while
+        void touchControl() {last_control_us = esp_timer_get_time();};
+        // sends a ping carrying its timestamp to the control client; called once per status sample
+        void pingControlClient();
+        // measures the round trip from the pong of the control client
+        void onControlPong(uint32_t client_id, const uint8_t *data, size_t len);
+        void dumpControlToJson(JsonObject json);
+
         int getSketchSize(){ return sketchSize;};
         int getSketchSpace() {return sketchSpace;};
         
@@ -110,21 +234,64 @@ class CLAppHttpd : public CLAppComponent {
         int getFlashLamp() {return flashLamp;}; 
         void setFlashLamp(int newVal) {flashLamp = newVal;};
 
-        void setLamp(int newVal = DEFAULT_FLASH);
+        /// @brief sets the lamp brightness in percent, in a hardware fade if the lamp has a fade time
+        void setLamp(int newVal = DEFAULT_FLASH, bool fade = true);
+        /// @brief flashes the lamp for a still image; the capture of the frame ends the flash
+        /// @return OS_SUCCESS, or OS_FAIL if the lamp was switched on without the strobe
+        int strobeLamp();
         int getLamp() {return lampVal;};    
 
         void dumpSystemStatusToJson(JsonDocument& json);
         void dumpCameraStatusToJson(JsonDocument& json, bool full = true);
 
+        /**
+         * @brief Refreshes the status snapshot. Called periodically by the status sampler task.
+         * 
+         * @param with_storage if true, the (slow) storage usage is sampled as well
+         */
+        void sampleStatus(bool with_storage = false);
+
+        /**
+         * @brief Copies the latest status snapshot
+         * 
+         * @param snapshot destination
+         */
+        void getStatusSnapshot(StatusSnapshot &snapshot);
+
+        /**
+         * @brief Marks the status as changed, so the clients holding an old ETag will receive a new copy.
+         * Should be called after the camera or server settings have been modified.
+         */
+        void touchStatus();
+
+        /**
+         * @brief Formats the ETag of the current status generation
+         * 
+         * @param buf destination buffer
+         * @param len size of the buffer
+         * @param msgpack true if the ETag is for the MessagePack representation
+         */
+        void getStatusETag(char *buf, size_t len, bool msgpack = false);
+
+        /**
+         * @brief Sends the short camera status to the websocket client as a MessagePack binary frame
+         * 
+         * @param client_id websocket client
+         * @return int OS_SUCCESS or OS_FAIL
+         */
+        int sendStatusMsgPack(uint32_t client_id);
+
         /**
          * @brief attaches a new PWM/servo and returns its ID in case of success, or OS_FAIL otherwise
          * 
          * @param pin 
          * @param freq
          * @param resolution_bits
+         * @param channel LEDC channel assigned by LedcPlanner.plan(), or -1 to take a free one
          * @return int 
          */
-        int attachPWM(uint8_t pin, double freq = PWM_DEFAULT_FREQ, uint8_t resolution_bits = PWM_DEFAULT_RESOLUTION_BITS);
+        int attachPWM(uint8_t pin, double freq = PWM_DEFAULT_FREQ, uint8_t resolution_bits = PWM_DEFAULT_RESOLUTION_BITS,
+                      int channel = -1);
         
         /**
          * @brief writes an angle value to PWM/Servo.
@@ -137,6 +304,14 @@ class CLAppHttpd : public CLAppComponent {
          */
         int writePWM(uint8_t pin, int value, int min_v = DEFAULT_uS_LOW, int max_v = DEFAULT_uS_HIGH);
 
+        /**
+         * @brief returns the PWM attached to the pin, or NULL
+         * 
+         * @param pin 
+         * @return ESP32PWM* 
+         */
+        ESP32PWM *getPWM(uint8_t pin) {return (pin < SOC_GPIO_PIN_COUNT && pwmIndex[pin] >= 0?pwm[pwmIndex[pin]]:NULL);};
+
         /**
          * @brief Set all PWM to its default value. If the default was not defined, it will be reset to 0
          * 
@@ -145,6 +320,56 @@ class CLAppHttpd : public CLAppComponent {
         void resetPWM(uint8_t pin = RESET_ALL_PWM);
 
         uint8_t getTemp() {return temperatureRead();};
+
+        /**
+         * @brief Maps the request to its admission class by the URL
+         * 
+         * @param request 
+         * @return RequestClassEnum 
+         */
+        static RequestClassEnum classifyRequest(AsyncWebServerRequest *request);
+
+        /**
+         * @brief Admits a request of the given class, if the number of active requests of the class and
+         * the free heap allow it. Otherwise the rejection is counted.
+         * 
+         * @param cls request class
+         * @param track if true, the request is counted as active until releaseRequest() is called
+         * @return true if the request is admitted
+         */
+        bool admitRequest(RequestClassEnum cls, bool track = true);
+        void releaseRequest(RequestClassEnum cls);
+
+        /**
+         * @brief Reports the admission limits and counters
+         * 
+         * @param json 
+         */
+        void dumpAdmissionToJson(JsonObject json);
+
+        /**
+         * @brief Writes the web server metrics (streams, admission) in the Prometheus text format
+         * 
+         * @param out 
+         */
+        void printMetrics(Print &out);
+
+        /**
+         * @brief Checks if the request carries a valid session token, either in the session cookie,
+         * in the 'Authorization: Bearer' header or in the 'token' query parameter.
+         * 
+         * @param request 
+         * @return true if the session is valid
+         */
+        bool hasValidSession(AsyncWebServerRequest *request);
+
+        /**
+         * @brief Adds the session cookie to the response.
+         * 
+         * @param response may be NULL, then nothing happens
+         * @param token session token. If NULL, a new token is issued.
+         */
+        void attachSessionCookie(AsyncWebServerResponse *response, const char *token = NULL);
         
     private:
 
@@ -155,6 +380,9 @@ class CLAppHttpd : public CLAppComponent {
 
         int pwmCount = 0;
 
+        // index into pwm[] by GPIO number, -1 if no PWM is attached to the pin
+        int8_t pwmIndex[SOC_GPIO_PIN_COUNT];
+
         // Name of the application used in web interface
         // Can be re-defined in the httpd.json file
         char myName[32] = CAM_NAME;
@@ -167,9 +395,30 @@ class CLAppHttpd : public CLAppComponent {
         // array of clients currently streaming video 
         uint32_t stream_clients[MAX_VIDEO_STREAMS];
 
-        uint32_t control_client;
+        volatile uint32_t control_client = 0;
+
+        volatile uint32_t log_client = 0;
+
+        // control priority lane
+        int control_budget_ms = CONTROL_LATENCY_BUDGET;
+        volatile int64_t last_control_us = 0;
+        volatile uint32_t control_rtt_us = 0;      // last measured round trip
+        uint32_t control_rtt_max_us = 0;
+        uint32_t control_pings = 0;
+        uint32_t control_pongs = 0;
+        uint32_t control_lane_drops = 0;
+
+        bool isControlLaneBusy();
+        void sendFrame(const uint8_t *buf, size_t len);
         
         TimerHandle_t snap_timer = NULL;
+
+        // status sampler
+        TaskHandle_t sampler_task = NULL;
+        StatusSnapshot status;
+        portMUX_TYPE status_mux = portMUX_INITIALIZER_UNLOCKED;
+        // distinguishes the status generations across reboots 
+        uint32_t boot_id = 0;
         
         // Flash LED lamp parameters.
         // should be defined in the 1st line of the pwm collection in the httpd prefs (httpd.json)
@@ -180,12 +429,25 @@ class CLAppHttpd : public CLAppComponent {
         int pwmMax = 1;                // pwmMax = pow(2,pwmresolution)-1;
 
         int8_t streamCount=0;
+        int captureConsumers=0;
+        portMUX_TYPE capture_mux = portMUX_INITIALIZER_UNLOCKED;
+        volatile bool stillPending=false;
 
         long streamsServed=0;
         long imagesServed=0;
 
         // maximum number of parallel video streams supported. This number can range from 1 to MAX_VIDEO_STREAMS
         int max_streams=2;
+
+        // RTSP server port, 0 = disabled
+        int rtsp_port=RTSP_DEFAULT_PORT;
+
+        // admission control. Only updated from the AsyncTCP task.
+        AdmissionClass admission[REQUEST_CLASS_COUNT] = {
+            {ADMISSION_STREAM_MAX, ADMISSION_STREAM_MIN_HEAP, 0, 0},
+            {ADMISSION_CONTROL_MAX, ADMISSION_CONTROL_MIN_HEAP, 0, 0},
+            {ADMISSION_STATIC_MAX, ADMISSION_STATIC_MIN_HEAP, 0, 0},
+            {ADMISSION_STATUS_MAX, ADMISSION_STATUS_MIN_HEAP, 0, 0}};
         
         // Sketch Info
         int sketchSize ;
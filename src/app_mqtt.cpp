@@ -0,0 +1,363 @@
+#include "app_mqtt.h"
+#include "app_httpd.h"
+
+static void onMqttEvent(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data) {
+    AppMqtt.onEvent((esp_mqtt_event_handle_t)event_data);
+}
+
+CLAppMqtt::CLAppMqtt() {
+    setTag("mqtt");
+    // the prefs contain the broker password
+    setLogPrefs(false);
+}
+
+int CLAppMqtt::loadPrefs() {
+    JsonDocument json;
+    int ret = parsePrefs(json);
+    if(ret != OS_SUCCESS) return ret;
+
+    enabled = json["enabled"] | false;
+    strlcpy(uri, json["uri"] | "", sizeof(uri));
+    strlcpy(user, json["user"] | "", sizeof(user));
+    strlcpy(pass, json["pass"] | "", sizeof(pass));
+    strlcpy(topic, json["topic"] | MQTT_DEFAULT_TOPIC, sizeof(topic));
+    qos = constrain(json["qos"] | 0, 0, 1);
+    status_interval = max(1, json["status_interval"] | MQTT_DEFAULT_STATUS_INTERVAL);
+    return OS_SUCCESS;
+}
+
+int CLAppMqtt::savePrefs() {
+    TRACE_SCOPE("prefs_save");
+    JsonDocument json;
+    char* prefs_file = getPrefsFileName(true);
+
+    if (Storage.exists(prefs_file)) {
+        Log.info("Updating %s", prefs_file);
+    } else {
+        Log.info("Creating %s", prefs_file);
+    }
+
+    json["enabled"] = enabled;
+    json["uri"] = uri;
+    json["user"] = user;
+    json["pass"] = pass;
+    json["topic"] = topic;
+    json["qos"] = qos;
+    json["status_interval"] = status_interval;
+
+    File file = Storage.open(prefs_file, FILE_WRITE);
+    if(file) {
+        serializeJson(json, file);
+        file.close();
+        Log.info("File %s updated", prefs_file);
+        return OS_SUCCESS;
+    }
+    Log.error("Failed to open %s for writing", prefs_file);
+    return OS_FAIL;
+}
+
+int CLAppMqtt::start() {
+    loadPrefs();
+    if(!enabled) return OS_SUCCESS;
+
+    static char lwt_topic[MQTT_TOPIC_LENGTH + 16];
+    snprintf(lwt_topic, sizeof(lwt_topic), "%s/availability", topic);
+
+    esp_mqtt_client_config_t cfg = {};
+    cfg.uri = uri;
+    if(user[0]) cfg.username = user;
+    if(pass[0]) cfg.password = pass;
+    cfg.lwt_topic = lwt_topic;
+    cfg.lwt_msg = "offline";
+    cfg.lwt_qos = 1;
+    cfg.lwt_retain = 1;
+
+    queue = xQueueCreate(MQTT_QUEUE_LENGTH, sizeof(MqttMessage));
+    client = esp_mqtt_client_init(&cfg);
+    if(!queue || !client ||
+       xTaskCreate(mqttTask, "mqtt", MQTT_TASK_STACK_SIZE, NULL, MQTT_TASK_PRIORITY, &task) != pdPASS) {
+        Log.error("Failed to start the MQTT client");
+        return OS_FAIL;
+    }
+
+    esp_mqtt_client_register_event(client, (esp_mqtt_event_id_t)ESP_EVENT_ANY_ID, onMqttEvent, NULL);
+    if(esp_mqtt_client_start(client) != ESP_OK) {
+        Log.error("Failed to start the MQTT client");
+        return OS_FAIL;
+    }
+    Log.info("MQTT client started, topic %s", topic);
+    return OS_SUCCESS;
+}
+
+void CLAppMqtt::onEvent(esp_mqtt_event_handle_t event) {
+    char sub[MQTT_TOPIC_LENGTH + 16];
+
+    switch(event->event_id) {
+        case MQTT_EVENT_CONNECTED:
+            connected = true;
+            connects++;
+            snprintf(sub, sizeof(sub), "%s/control/#", topic);
+            esp_mqtt_client_subscribe(client, sub, qos);
+            snprintf(sub, sizeof(sub), "%s/snapshot", topic);
+            esp_mqtt_client_subscribe(client, sub, qos);
+            full_status = true;
+            wakeUp();
+            Log.info("MQTT connected");
+            break;
+
+        case MQTT_EVENT_DISCONNECTED:
+            if(connected) Log.warn("MQTT disconnected");
+            connected = false;
+            break;
+
+        case MQTT_EVENT_DATA: {
+            // fragments of long messages are not expected on the command topics
+            if(event->current_data_offset != 0 || event->data_len != event->total_data_len) break;
+
+            size_t prefix = strlen(topic);
+            if(event->topic_len <= (int)prefix || strncmp(event->topic, topic, prefix) != 0) break;
+            const char *rest = event->topic + prefix;
+            size_t rest_len = event->topic_len - prefix;
+
+            if(rest_len > 9 && strncmp(rest, "/control/", 9) == 0)
+                queueControl(rest + 9, rest_len - 9, event->data, event->data_len);
+            else if(rest_len == 9 && strncmp(rest, "/snapshot", 9) == 0) {
+                snapshot_requested = true;
+                wakeUp();
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void CLAppMqtt::queueControl(const char *var, size_t var_len, const char *value, size_t value_len) {
+    // the controls are applied by the publisher task, the MQTT client goes on with its traffic
+    MqttMessage msg = {"", nullptr, value_len, false, false, true};
+    if(var_len >= sizeof(msg.subtopic)) return;
+    memcpy(msg.subtopic, var, var_len);
+    msg.subtopic[var_len] = '\0';
+
+    msg.payload = (char*)malloc(value_len + 1);
+    if(!msg.payload) {
+        dropped++;
+        return;
+    }
+    memcpy(msg.payload, value, value_len);
+    msg.payload[value_len] = '\0';
+
+    if(!queue || xQueueSend(queue, &msg, 0) != pdTRUE) {
+        dropped++;
+        msg.release();
+    }
+}
+
+void CLAppMqtt::onControl(MqttMessage &msg) {
+    String variable(msg.subtopic), val(msg.payload);
+    msg.release();
+    controls++;
+
+    int res = OS_FAIL;
+    if(isMqttControl(variable.c_str()) && !AppCam.getLastErr()) res = AppHttpd.setControl(variable, val);
+    Log.debug("MQTT control %s: %s", variable.c_str(), (res == OS_SUCCESS?"ok":"rejected"));
+
+    JsonDocument json;
+    json["var"] = variable;
+    json["ok"] = (res == OS_SUCCESS);
+    size_t len = measureJson(json);
+    char *payload = (char*)malloc(len + 1);
+    if(!payload) return;
+    serializeJson(json, payload, len + 1);
+    MqttMessage ack = {"ack", payload, len, false, false, false};
+    publish(ack);
+}
+
+int CLAppMqtt::enqueue(const char *subtopic, char *payload, size_t len, bool retain, bool frame) {
+    MqttMessage msg;
+    strlcpy(msg.subtopic, subtopic, sizeof(msg.subtopic));
+    msg.payload = payload;
+    msg.len = len;
+    msg.retain = retain;
+    msg.frame = frame;
+    msg.control = false;
+    msg.shared = nullptr;
+
+    if(!queue || xQueueSend(queue, &msg, 0) != pdTRUE) {
+        dropped++;
+        msg.release();
+        return OS_FAIL;
+    }
+    return OS_SUCCESS;
+}
+
+void CLAppMqtt::wakeUp() {
+    // an empty message; if the queue is full, the task is busy anyway
+    MqttMessage msg = {"", nullptr, 0, false, false, false};
+    if(queue) xQueueSend(queue, &msg, 0);
+}
+
+bool CLAppMqtt::isOutboxFull(bool frame) {
+    // the client keeps the QoS 1 messages until the broker acknowledges them; a frame waits for all of them
+    int outbox = esp_mqtt_client_get_outbox_size(client);
+    return (frame?outbox > 0:outbox > MQTT_OUTBOX_LIMIT);
+}
+
+int CLAppMqtt::publishEvent(const char *name, JsonVariantConst data) {
+    if(!enabled || !connected) return OS_FAIL;
+
+    char subtopic[MQTT_SUBTOPIC_LENGTH];
+    snprintf(subtopic, sizeof(subtopic), "event/%s", name);
+    size_t len = measureJson(data);
+    char *payload = (char*)malloc(len + 1);
+    if(!payload) {
+        dropped++;
+        return OS_FAIL;
+    }
+    serializeJson(data, payload, len + 1);
+    return enqueue(subtopic, payload, len);
+}
+
+int CLAppMqtt::publishFrame(const char *subtopic, SharedFrame *frame) {
+    if(!enabled || !connected) return OS_FAIL;
+    if(isOutboxFull(true)) {
+        dropped++;
+        return OS_FAIL;
+    }
+
+    MqttMessage msg = {"", nullptr, 0, false, true, false, nullptr};
+    strlcpy(msg.subtopic, subtopic, sizeof(msg.subtopic));
+    msg.setFrame(frame);
+    if(!queue || xQueueSend(queue, &msg, 0) != pdTRUE) {
+        dropped++;
+        msg.release();
+        return OS_FAIL;
+    }
+    return OS_SUCCESS;
+}
+
+void CLAppMqtt::publish(MqttMessage &msg) {
+    const char *data = msg.getData();
+    if(!data) return;
+
+    char full_topic[MQTT_TOPIC_LENGTH + 40];
+    snprintf(full_topic, sizeof(full_topic), "%s/%s", topic, msg.subtopic);
+
+    if(connected && !isOutboxFull(msg.frame) &&
+       esp_mqtt_client_publish(client, full_topic, data, msg.len, (msg.frame?0:qos), msg.retain) >= 0)
+        published++;
+    else
+        dropped++;
+    msg.release();
+}
+
+void CLAppMqtt::publishStatus(bool full) {
+    JsonDocument current;
+    AppHttpd.dumpCameraStatusToJson(current, true);
+    current["streams"] = AppHttpd.getStreamCount();
+
+    JsonDocument delta;
+    if(buildStatusDelta(current.as<JsonObjectConst>(), last_status.as<JsonObjectConst>(), delta, full) == 0) return;
+
+    size_t len = measureJson(delta);
+    char *payload = (char*)malloc(len + 1);
+    if(!payload) {
+        dropped++;
+        return;
+    }
+    serializeJson(delta, payload, len + 1);
+
+    MqttMessage msg = {"status", payload, len, full, false, false};
+    publish(msg);
+    last_status = current;
+}
+
+void CLAppMqtt::offerFrame(const uint8_t *buf, size_t len) {
+    if(!frame_wanted || snapshot) return;
+
+    uint8_t *copy = (uint8_t*)(psramFound()?ps_malloc(len):malloc(len));
+    if(copy) {
+        memcpy(copy, buf, len);
+        snapshot_len = len;
+        snapshot = copy;
+    }
+    frame_wanted = false;
+    if(task) xTaskNotifyGive(task);
+}
+
+void CLAppMqtt::takeSnapshot() {
+    snapshot_requested = false;
+    if(!connected) return;
+
+    // the snapshot comes from the capture loop, like the frames of the streams
+    frame_wanted = true;
+    AppHttpd.startCapture();
+    unsigned long start = millis();
+    while(frame_wanted && millis() - start < MQTT_SNAPSHOT_TIMEOUT)
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    frame_wanted = false;
+    AppHttpd.stopCapture();
+
+    uint8_t *jpeg = snapshot;
+    if(!jpeg) {
+        Log.warn("MQTT snapshot failed");
+        return;
+    }
+    MqttMessage msg = {"snapshot/jpeg", (char*)jpeg, snapshot_len, false, true, false};
+    snapshot = nullptr;
+    publish(msg);
+}
+
+void CLAppMqtt::run() {
+    TickType_t interval = pdMS_TO_TICKS(status_interval * 1000);
+    TickType_t last_status_tick = xTaskGetTickCount();
+
+    while(true) {
+        MqttMessage msg;
+        TickType_t elapsed = xTaskGetTickCount() - last_status_tick;
+        TickType_t wait = (elapsed < interval?interval - elapsed:0);
+
+        if(xQueueReceive(queue, &msg, wait) == pdTRUE) {
+            if(msg.control) onControl(msg);
+            else publish(msg);
+        }
+
+        if(full_status && connected) {
+            full_status = false;
+            char *online = strdup("online");
+            if(online) {
+                MqttMessage avail = {"availability", online, 6, true, false, false};
+                publish(avail);
+            }
+            publishStatus(true);
+            last_status_tick = xTaskGetTickCount();
+        }
+
+        if(snapshot_requested) takeSnapshot();
+
+        if(xTaskGetTickCount() - last_status_tick >= interval) {
+            if(connected) publishStatus(false);
+            last_status_tick = xTaskGetTickCount();
+        }
+    }
+}
+
+void CLAppMqtt::dumpStatusToJson(JsonObject json) {
+    json["enabled"] = enabled;
+    if(!enabled) return;
+
+    json["connected"] = (bool)connected;
+    json["topic"] = topic;
+    json["connects"] = connects;
+    json["published"] = published;
+    json["dropped"] = dropped;
+    json["controls"] = controls;
+    json["queued"] = (queue?uxQueueMessagesWaiting(queue):0);
+}
+
+void mqttTask(void *pvParameters) {
+    AppMqtt.run();
+}
+
+CLAppMqtt AppMqtt;
@@ -0,0 +1,105 @@
+#ifndef app_mqtt_h
+#define app_mqtt_h
+
+#include <mqtt_client.h>
+#include <freertos/queue.h>
+#include <ArduinoJson.h>
+
+#include "app_component.h"
+#include "mqtt_message.h"
+
+#define MQTT_URI_LENGTH             128
+#define MQTT_TOPIC_LENGTH           64
+#define MQTT_QUEUE_LENGTH           16      // messages waiting for the publisher task
+#define MQTT_OUTBOX_LIMIT           (16*1024)   // bytes of unacknowledged QoS 1 messages; more are dropped
+#define MQTT_DEFAULT_TOPIC          "esp32cam"
+#define MQTT_DEFAULT_STATUS_INTERVAL 5      // s between two status deltas
+#define MQTT_SNAPSHOT_TIMEOUT       5000    // ms to wait for a frame from the capture loop
+#define MQTT_TASK_STACK_SIZE        6144
+#define MQTT_TASK_PRIORITY          1
+
+/**
+ * @brief MQTT client
+ * Publishes events, status changes and on-demand JPEG snapshots to a broker, and maps the messages
+ * received on <topic>/control/<var> onto the camera and lamp variables of /control. All publishing and the
+ * controls are handled by a low priority task from a bounded queue, so a slow broker never stalls the
+ * capture loop, the web server or the MQTT client. The frames are sent with QoS 0 and dropped while older
+ * messages wait for the broker, so the unacknowledged messages kept by the client stay bounded.
+ * The status is published as a delta of the changed values, at most once per status interval.
+ * Configured in /mqtt.json.
+ *
+ */
+class CLAppMqtt : public CLAppComponent {
+    public:
+        CLAppMqtt();
+
+        int start();
+        int loadPrefs();
+        int savePrefs();
+
+        bool isEnabled() {return enabled;};
+        bool isConnected() {return connected;};
+
+        /// @brief queues an event for <topic>/event/<name>
+        /// @return OS_SUCCESS, or OS_FAIL if the queue is full
+        int publishEvent(const char *name, JsonVariantConst data);
+
+        /// @brief queues a JPEG frame for <topic>/<subtopic>; the queue keeps a reference to it, not a copy
+        /// @return OS_SUCCESS, or OS_FAIL if not connected or the queue is full
+        int publishFrame(const char *subtopic, SharedFrame *frame);
+
+        /// @brief true while a snapshot waits for a frame from the capture loop
+        bool isFrameWanted() {return frame_wanted;};
+        /// @brief takes a copy of the frame for the snapshot; called from the capture loop
+        void offerFrame(const uint8_t *buf, size_t len);
+
+        void dumpStatusToJson(JsonObject json);
+
+        void run();
+        void onEvent(esp_mqtt_event_handle_t event);
+
+    private:
+        int enqueue(const char *subtopic, char *payload, size_t len, bool retain = false, bool frame = false);
+        void wakeUp();
+        bool isOutboxFull(bool frame);
+        void publish(MqttMessage &msg);
+        void publishStatus(bool full);
+        void takeSnapshot();
+        void queueControl(const char *var, size_t var_len, const char *value, size_t value_len);
+        void onControl(MqttMessage &msg);
+
+        // configuration
+        bool enabled = false;
+        char uri[MQTT_URI_LENGTH] = "";
+        char user[32] = "";
+        char pass[64] = "";
+        char topic[MQTT_TOPIC_LENGTH] = MQTT_DEFAULT_TOPIC;
+        int qos = 0;
+        int status_interval = MQTT_DEFAULT_STATUS_INTERVAL;
+
+        esp_mqtt_client_handle_t client = NULL;
+        QueueHandle_t queue = NULL;
+        TaskHandle_t task = NULL;
+        volatile bool connected = false;
+        volatile bool full_status = false;
+        volatile bool snapshot_requested = false;
+
+        // last published status, for the deltas
+        JsonDocument last_status;
+
+        volatile bool frame_wanted = false;
+        uint8_t * volatile snapshot = nullptr;
+        volatile size_t snapshot_len = 0;
+
+        // statistics
+        uint32_t published = 0;
+        uint32_t dropped = 0;
+        uint32_t controls = 0;
+        uint32_t connects = 0;
+};
+
+void mqttTask(void *pvParameters);
+
+extern CLAppMqtt AppMqtt;
+
+#endif
@@ -0,0 +1,387 @@
+#include "app_push.h"
+#include "app_httpd.h"
+
+static const char * push_state_names[] = {"disabled", "idle", "connected", "backoff"};
+
+CLAppPush::CLAppPush() {
+    setTag("push");
+    // the prefs contain the ingest token
+    setLogPrefs(false);
+}
+
+int CLAppPush::loadPrefs() {
+    JsonDocument json;
+    int ret = parsePrefs(json);
+    if(ret != OS_SUCCESS) return ret;
+
+    enabled = json["enabled"] | false;
+    strlcpy(url, json["url"] | "", sizeof(url));
+    strlcpy(token, json["token"] | "", sizeof(token));
+    mode = (strcmp(json["mode"] | "stream", "still") == 0?PUSH_STILL:PUSH_STREAM);
+    interval = max(1, json["interval"] | PUSH_DEFAULT_INTERVAL);
+    slot_count = constrain(json["queue"] | PUSH_DEFAULT_SLOTS, 1, PUSH_MAX_SLOTS);
+
+    JsonObject spool = json["spool"];
+    spool_enabled = spool["enabled"] | false;
+    spool_max_mb = constrain(spool["max_mb"] | PUSH_SPOOL_MAX_MB, 1, 4095);
+    spool_batch = max(1, spool["batch"] | PUSH_SPOOL_BATCH);
+    spool_rate_kbps = max(0, spool["rate_kbps"] | PUSH_SPOOL_RATE_KBPS);
+    return OS_SUCCESS;
+}
+
+int CLAppPush::savePrefs() {
+    TRACE_SCOPE("prefs_save");
+    JsonDocument json;
+    char* prefs_file = getPrefsFileName(true);
+
+    if (Storage.exists(prefs_file)) {
+        Log.info("Updating %s", prefs_file);
+    } else {
+        Log.info("Creating %s", prefs_file);
+    }
+
+    json["enabled"] = enabled;
+    json["url"] = url;
+    json["token"] = token;
+    json["mode"] = (mode == PUSH_STILL?"still":"stream");
+    json["interval"] = interval;
+    json["queue"] = slot_count;
+
+    JsonObject spool = json["spool"].to<JsonObject>();
+    spool["enabled"] = spool_enabled;
+    spool["max_mb"] = spool_max_mb;
+    spool["batch"] = spool_batch;
+    spool["rate_kbps"] = spool_rate_kbps;
+
+    File file = Storage.open(prefs_file, FILE_WRITE);
+    if(file) {
+        serializeJson(json, file);
+        file.close();
+        Log.info("File %s updated", prefs_file);
+        return OS_SUCCESS;
+    }
+    Log.error("Failed to open %s for writing", prefs_file);
+    return OS_FAIL;
+}
+
+int CLAppPush::start() {
+    loadPrefs();
+    if(!enabled) return OS_SUCCESS;
+
+    if(!parseUrl()) {
+        Log.error("Push URL %s is not valid; only http:// URLs are supported", url);
+        return OS_FAIL;
+    }
+
+    if(!psramFound()) slot_count = min(slot_count, 2);
+    slot_count = queue.begin(slot_count, (psramFound()?PUSH_SLOT_SIZE:PUSH_SLOT_SIZE_NO_PSRAM));
+    // the spool keeps the stills only; a stream is live or lost
+    if(mode == PUSH_STILL && spool_enabled && !Spool.begin((uint32_t)spool_max_mb * 1024 * 1024))
+        Log.warn("Push: the spool is not available");
+
+    if(slot_count == 0 ||
+       xTaskCreate(pushTask, "push", PUSH_TASK_STACK_SIZE, NULL, PUSH_TASK_PRIORITY, &task) != pdPASS) {
+        Log.error("Failed to start the push publisher");
+        return OS_FAIL;
+    }
+
+    state = PUSH_IDLE;
+    Log.info("Push publisher started: %s to %s:%u%s, %d slots", (mode == PUSH_STILL?"stills":"stream"),
+             host, port, path, slot_count);
+    return OS_SUCCESS;
+}
+
+bool CLAppPush::parseUrl() {
+    if(strncmp(url, "http://", 7) != 0) return false;
+
+    const char *start = url + 7;
+    const char *slash = strchr(start, '/');
+    size_t host_len = (slash?slash - start:strlen(start));
+    if(host_len == 0 || host_len >= sizeof(host)) return false;
+
+    memcpy(host, start, host_len);
+    host[host_len] = '\0';
+    strlcpy(path, (slash?slash:"/"), sizeof(path));
+
+    char *colon = strchr(host, ':');
+    if(colon) {
+        *colon = '\0';
+        port = atoi(colon + 1);
+    }
+    return port > 0;
+}
+
+void CLAppPush::offerFrame(const uint8_t *buf, size_t len) {
+    if(!frame_wanted) return;
+    // a still needs only one frame
+    if(mode == PUSH_STILL) frame_wanted = false;
+
+    queueFrame(buf, len);
+}
+
+int CLAppPush::queueStill(SharedFrame *frame) {
+    if(!enabled || mode != PUSH_STILL || !task) return OS_FAIL;
+    return queueFrame(frame->getBuffer(), frame->getSize(), frame);
+}
+
+int CLAppPush::queueFrame(const uint8_t *buf, size_t len, SharedFrame *frame) {
+    if(queue.push(buf, len, frame) != OS_SUCCESS) return OS_FAIL;
+
+    if(task) xTaskNotifyGive(task);
+    return OS_SUCCESS;
+}
+
+bool CLAppPush::connect() {
+    if(client.connected()) return true;
+
+    client.setTimeout(PUSH_TIMEOUT);
+    if(!client.connect(host, port, PUSH_TIMEOUT * 1000)) {
+        Log.warn("Push: cannot connect to %s:%u", host, port);
+        return false;
+    }
+    client.setNoDelay(true);
+    connects++;
+    state = PUSH_CONNECTED;
+    return true;
+}
+
+void CLAppPush::disconnect() {
+    client.stop();
+    if(state == PUSH_CONNECTED) state = PUSH_IDLE;
+}
+
+void CLAppPush::scheduleRetry() {
+    failures++;
+    state = PUSH_BACKOFF;
+    // random jitter, so a fleet of cameras does not reconnect in lockstep
+    uint32_t delay_ms = backoff_ms + esp_random() % (backoff_ms / 4 + 1);
+    Log.info("Push: retrying in %lu ms", (unsigned long)delay_ms);
+    retry_at = millis() + delay_ms;
+    backoff_ms = min((uint32_t)PUSH_BACKOFF_MAX, backoff_ms * 2);
+}
+
+void CLAppPush::backoff() {
+    scheduleRetry();
+    long wait = (long)(retry_at - millis());
+    if(wait > 0) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+    state = PUSH_IDLE;
+}
+
+int CLAppPush::readResponse() {
+    String line = client.readStringUntil('\n');
+    int status = -1;
+    if(sscanf(line.c_str(), "HTTP/%*d.%*d %d", &status) != 1) return -1;
+
+    long content_length = 0;
+    bool close = false;
+    while(client.connected()) {
+        line = client.readStringUntil('\n');
+        line.trim();
+        if(line.length() == 0) break;
+        line.toLowerCase();
+        if(line.startsWith("content-length:")) content_length = line.substring(15).toInt();
+        else if(line.startsWith("connection:") && line.indexOf("close") > 0) close = true;
+    }
+    // the response body is not used
+    while(content_length > 0 && client.connected()) {
+        uint8_t buf[64];
+        int n = client.readBytes(buf, min((long)sizeof(buf), content_length));
+        if(n <= 0) break;
+        content_length -= n;
+    }
+    if(close) disconnect();
+    last_status = status;
+    return status;
+}
+
+bool CLAppPush::sendStreamFrame(PushSlot &slot) {
+    char head[PUSH_STREAM_HEAD_SIZE];
+    size_t head_len = formatStreamHead(head, sizeof(head), slot.len);
+
+    if(!head_len ||
+       client.write((const uint8_t*)head, head_len) != head_len ||
+       client.write(slot.data, slot.len) != slot.len ||
+       client.write((const uint8_t*)"\r\n\r\n", 4) != 4)
+        return false;
+
+    frames_sent++;
+    bytes_sent += slot.len;
+    return true;
+}
+
+bool CLAppPush::sendStill(const uint8_t *buf, size_t len, uint32_t time) {
+    char capture_time[40] = "";
+    if(time) snprintf(capture_time, sizeof(capture_time), "X-Capture-Time: %lu\r\n", (unsigned long)time);
+
+    char head[448];
+    int head_len = snprintf(head, sizeof(head),
+                            "POST %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: esp32cam\r\n%s%s%s%s"
+                            "Content-Type: image/jpeg\r\nContent-Length: %u\r\nConnection: keep-alive\r\n\r\n",
+                            path, host, (token[0]?"Authorization: Bearer ":""), token, (token[0]?"\r\n":""),
+                            capture_time, (unsigned)len);
+    if(head_len >= (int)sizeof(head) ||
+       client.write((const uint8_t*)head, head_len) != (size_t)head_len ||
+       client.write(buf, len) != len)
+        return false;
+
+    int status = readResponse();
+    if(status < 200 || status > 299) {
+        Log.warn("Push: the server answered %d", status);
+        return false;
+    }
+    frames_sent++;
+    bytes_sent += len;
+    return true;
+}
+
+bool CLAppPush::sendSpooled(const SpoolRecordHeader &header, const uint8_t *payload, void *arg) {
+    CLAppPush *push = (CLAppPush*)arg;
+    return push->client.connected() && push->sendStill(payload, header.len, header.time);
+}
+
+void CLAppPush::runStream() {
+    if(!connect()) {
+        backoff();
+        return;
+    }
+
+    char head[384];
+    int head_len = snprintf(head, sizeof(head),
+                            "POST %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: esp32cam\r\n%s%s%s"
+                            "Content-Type: multipart/x-mixed-replace;boundary=" PUSH_BOUNDARY "\r\n"
+                            "Transfer-Encoding: chunked\r\n\r\n",
+                            path, host, (token[0]?"Authorization: Bearer ":""), token, (token[0]?"\r\n":""));
+    if(head_len >= (int)sizeof(head) || client.write((const uint8_t*)head, head_len) != (size_t)head_len) {
+        disconnect();
+        backoff();
+        return;
+    }
+
+    Log.info("Push: streaming to %s:%u%s", host, port, path);
+    queue.reset();
+    frame_wanted = true;
+    AppHttpd.startCapture();
+
+    bool ok = true;
+    while(ok && client.connected()) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+
+        // the server does not answer before the end of the body, unless it refuses it
+        if(client.available()) {
+            Log.warn("Push: the server answered %d", readResponse());
+            ok = false;
+            break;
+        }
+
+        int slot;
+        while(ok && (slot = queue.take()) >= 0) {
+            ok = sendStreamFrame(queue.getSlot(slot));
+            queue.release(slot);
+        }
+        // the connection works, the next failure starts with a short delay again
+        if(ok && frames_sent) backoff_ms = PUSH_BACKOFF_MIN;
+    }
+
+    frame_wanted = false;
+    AppHttpd.stopCapture();
+    disconnect();
+    Log.warn("Push: stream to %s:%u interrupted", host, port);
+    backoff();
+}
+
+void CLAppPush::runStill() {
+    unsigned long last_still = millis() - interval * 1000UL;
+
+    // the stills are taken offline too; they wait in the queue or in the spool
+    while(true) {
+        // grab a still from the capture loop, unless the task was woken up early by a queued still
+        if(millis() - last_still >= interval * 1000UL) {
+            last_still = millis();
+            frame_wanted = true;
+            AppHttpd.startCapture();
+            unsigned long wait_start = millis();
+            while(frame_wanted && millis() - wait_start < PUSH_TIMEOUT * 1000UL)
+                ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+            AppHttpd.stopCapture();
+            frame_wanted = false;
+        }
+
+        bool online = AppConn.isConnected() && (state != PUSH_BACKOFF || (long)(millis() - retry_at) >= 0);
+        if(!AppConn.isConnected() && state == PUSH_CONNECTED) disconnect();
+        if(online && state == PUSH_BACKOFF) state = PUSH_IDLE;
+
+        // upload everything queued, including the stills which failed before
+        int slot;
+        while((slot = queue.take()) >= 0) {
+            PushSlot &still = queue.getSlot(slot);
+            // while older stills wait in the spool, the new ones join them to keep the order
+            if(online && Spool.getBacklog() == 0) {
+                if(connect() && sendStill(still.data, still.len, still.time)) {
+                    queue.release(slot);
+                    backoff_ms = PUSH_BACKOFF_MIN;
+                    continue;
+                }
+                disconnect();
+                scheduleRetry();
+                online = false;
+            }
+            if(!Spool.isEnabled()) {
+                queue.release(slot, true);
+                break;
+            }
+            Spool.append(SPOOL_STILL, still.time, still.data, still.len);
+            queue.release(slot);
+        }
+
+        // the backlog goes out in batches, at a limited rate
+        if(online && Spool.getBacklog() > 0) {
+            if(!connect() || Spool.drain(sendSpooled, this, spool_batch, spool_rate_kbps * 1000 / 8) < 0) {
+                disconnect();
+                scheduleRetry();
+            } else
+                backoff_ms = PUSH_BACKOFF_MIN;
+        }
+
+        long wait = interval * 1000L - (long)(millis() - last_still);
+        if(wait > 0) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+    }
+}
+
+void CLAppPush::run() {
+    if(mode == PUSH_STILL) runStill();
+
+    while(true) {
+        if(!AppConn.isConnected()) {
+            if(state == PUSH_CONNECTED) disconnect();
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+        runStream();
+    }
+}
+
+void CLAppPush::dumpStatusToJson(JsonObject json) {
+    json["enabled"] = enabled;
+    if(!enabled) return;
+
+    json["mode"] = (mode == PUSH_STILL?"still":"stream");
+    json["state"] = push_state_names[state];
+    json["host"] = host;
+    json["connects"] = connects;
+    json["frames_sent"] = frames_sent;
+    json["bytes_sent"] = bytes_sent;
+    json["frames_dropped"] = queue.getDropped();
+    json["frames_oversize"] = queue.getOversize();
+    json["failures"] = failures;
+    json["last_status"] = last_status;
+    json["backoff_ms"] = backoff_ms;
+    json["queued"] = queue.getQueued();
+    json["queue"] = slot_count;
+    if(mode == PUSH_STILL) Spool.dumpToJson(json["spool"].to<JsonObject>());
+}
+
+void pushTask(void *pvParameters) {
+    AppPush.run();
+}
+
+CLAppPush AppPush;
@@ -0,0 +1,118 @@
+#ifndef app_push_h
+#define app_push_h
+
+#include <WiFi.h>
+#include <ArduinoJson.h>
+
+#include "app_component.h"
+#include "spool.h"
+#include "push_queue.h"
+
+#define PUSH_URL_LENGTH         128
+#define PUSH_TOKEN_LENGTH       64
+#define PUSH_DEFAULT_SLOTS      3
+#define PUSH_SLOT_SIZE          (160*1024)  // largest frame that can be queued (PSRAM)
+#define PUSH_SLOT_SIZE_NO_PSRAM (32*1024)
+#define PUSH_DEFAULT_INTERVAL   10          // s between two stills
+#define PUSH_BACKOFF_MIN        1000        // ms
+#define PUSH_BACKOFF_MAX        60000       // ms
+#define PUSH_TIMEOUT            10          // s to connect, write or wait for a response
+#define PUSH_TASK_STACK_SIZE    6144
+#define PUSH_TASK_PRIORITY      1
+#define PUSH_SPOOL_MAX_MB       64          // default limit of the spool on the storage
+#define PUSH_SPOOL_BATCH        10          // stills drained from the spool per still interval
+#define PUSH_SPOOL_RATE_KBPS    256         // drain rate limit, kbit/s
+
+enum PushModeEnum {PUSH_STREAM, PUSH_STILL};
+enum PushStateEnum {PUSH_DISABLED, PUSH_IDLE, PUSH_CONNECTED, PUSH_BACKOFF};
+
+/**
+ * @brief Push publisher
+ * Uploads the video to an ingest server, for cameras that cannot be reached from outside (NAT).
+ * In stream mode the frames are sent as a multipart/x-mixed-replace body of a single chunked POST,
+ * in still mode each still is POSTed on a persistent connection. The frames are copied from the
+ * capture loop into a bounded queue; if the upload does not keep up, the oldest frame is dropped.
+ * Failed connections are retried with exponential backoff. In still mode, the stills taken while the
+ * server cannot be reached are kept in a spool on the storage and uploaded once it is back.
+ * Configured in /push.json.
+ *
+ */
+class CLAppPush : public CLAppComponent {
+    public:
+        CLAppPush();
+
+        int start();
+        int loadPrefs();
+        int savePrefs();
+
+        bool isEnabled() {return enabled;};
+
+        /// @brief true if the publisher waits for a frame from the capture loop
+        bool isFrameWanted() {return frame_wanted;};
+        /// @brief copies the frame into the queue; called from the capture loop
+        void offerFrame(const uint8_t *buf, size_t len);
+        /// @brief queues a still taken by someone else (a trigger); it is uploaded or spooled like the others.
+        /// The queue keeps a reference to the frame instead of a copy.
+        /// @return OS_SUCCESS, or OS_FAIL if the publisher is not in still mode or the queue is busy
+        int queueStill(SharedFrame *frame);
+
+        void dumpStatusToJson(JsonObject json);
+
+        void run();
+
+    private:
+        bool parseUrl();
+        bool connect();
+        void disconnect();
+        void scheduleRetry();
+        void backoff();
+
+        int queueFrame(const uint8_t *buf, size_t len, SharedFrame *frame = nullptr);
+
+        bool sendStreamFrame(PushSlot &slot);
+        bool sendStill(const uint8_t *buf, size_t len, uint32_t time);
+        static bool sendSpooled(const SpoolRecordHeader &header, const uint8_t *payload, void *arg);
+        int readResponse();
+        void runStream();
+        void runStill();
+
+        // configuration
+        bool enabled = false;
+        char url[PUSH_URL_LENGTH] = "";
+        char token[PUSH_TOKEN_LENGTH] = "";
+        PushModeEnum mode = PUSH_STREAM;
+        int interval = PUSH_DEFAULT_INTERVAL;
+        int slot_count = PUSH_DEFAULT_SLOTS;
+        bool spool_enabled = false;
+        int spool_max_mb = PUSH_SPOOL_MAX_MB;
+        int spool_batch = PUSH_SPOOL_BATCH;
+        int spool_rate_kbps = PUSH_SPOOL_RATE_KBPS;
+
+        // parsed url
+        char host[64] = "";
+        char path[PUSH_URL_LENGTH] = "/";
+        uint16_t port = 80;
+
+        WiFiClient client;
+        TaskHandle_t task = NULL;
+        volatile PushStateEnum state = PUSH_DISABLED;
+        volatile bool frame_wanted = false;
+        bool capturing = false;
+        uint32_t backoff_ms = PUSH_BACKOFF_MIN;
+        unsigned long retry_at = 0;
+
+        PushQueue queue;
+
+        // statistics
+        uint32_t frames_sent = 0;
+        uint64_t bytes_sent = 0;
+        uint32_t failures = 0;
+        uint32_t connects = 0;
+        int last_status = 0;
+};
+
+void pushTask(void *pvParameters);
+
+extern CLAppPush AppPush;
+
+#endif
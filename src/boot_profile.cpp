@@ -0,0 +1,19 @@
+#include "boot_profile.h"
+
+void CLBootProfile::mark(const char *phase) {
+    int i = count.fetch_add(1, std::memory_order_relaxed);
+    if(i >= BOOT_MAX_PHASES) return;
+
+    phases[i].ms = (uint32_t)(esp_timer_get_time() / 1000);
+    phases[i].name = phase;
+    ready.fetch_add(1, std::memory_order_release);
+}
+
+void CLBootProfile::dumpToJson(JsonObject json) {
+    int n = ready.load(std::memory_order_acquire);
+    if(n > BOOT_MAX_PHASES) n = BOOT_MAX_PHASES;
+    for(int i=0; i < n; i++)
+        if(phases[i].name) json[phases[i].name] = phases[i].ms;
+}
+
+CLBootProfile BootProfile;
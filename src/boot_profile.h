@@ -0,0 +1,35 @@
+#ifndef boot_profile_h
+#define boot_profile_h
+
+#include <Arduino.h>
+#include <atomic>
+#include <ArduinoJson.h>
+
+#define BOOT_MAX_PHASES     16
+
+/**
+ * @brief Boot phase profiler
+ * Records the time (ms since power-on) at which each startup phase was completed. Phases can be marked
+ * from any task, since some of them run in parallel.
+ * 
+ */
+class CLBootProfile {
+    public:
+        /// @brief records the completion of the phase
+        /// @param phase name of the phase; must be a string literal (only the pointer is stored)
+        void mark(const char *phase);
+
+        /// @brief writes the phases as "phase": ms pairs, in the order they completed
+        void dumpToJson(JsonObject json);
+
+    private:
+        struct Phase {const char *name; uint32_t ms;};
+
+        Phase phases[BOOT_MAX_PHASES];
+        std::atomic<int> count{0};
+        std::atomic<int> ready{0};
+};
+
+extern CLBootProfile BootProfile;
+
+#endif
@@ -229,6 +229,26 @@ void ESP32PWM::attachPin(uint8_t pin, double freq, uint8_t resolution_bits) {
 		setup(freq, resolution_bits);
 	attachPin(pin);
 }
+void ESP32PWM::attachPin(uint8_t pin, double freq, uint8_t resolution_bits, int channel) {
+	if (!hasPwm(pin) || channel < 0 || channel >= NUM_PWM || ChannelUsed[channel] != NULL)
+		return;
+
+	pwmChannel = channel;
+	timerNum = (channel / 2) % 4;
+	// as allocatenext() does, so the channels allocated later do not share the timer with another frequency
+	timerFreqSet[timerNum] = (long) freq;
+	ChannelUsed[pwmChannel] = this;
+	timerCount[timerNum]++;
+	PWMCount++;
+	myFreq = freq;
+	resolutionBits = resolution_bits;
+	if (ledcSetup(pwmChannel, freq, resolution_bits) == 0) {
+		deallocate();
+		return;
+	}
+	attachPin(pin);
+}
+
 void ESP32PWM::detachPin(int pin) {
 	ledcDetachPin(pin);
 	deallocate();
@@ -36,6 +36,8 @@ class ESP32PWM {
 
         void detachPin(int pin);
         void attachPin(uint8_t pin, double freq, uint8_t resolution_bits);
+        // attach on a channel chosen by the caller (see CLLedcPlanner) instead of allocatenext()
+        void attachPin(uint8_t pin, double freq, uint8_t resolution_bits, int channel);
 
         // write raw duty cycle
         void write(uint32_t duty);
@@ -54,6 +56,9 @@ class ESP32PWM {
         uint32_t getDuty();
         double getDutyScaled();
 
+        // records a duty set by other means than write(), e.g. by the LEDC fade hardware
+        void trackDuty(uint32_t duty) {myDuty = duty;};
+
         uint32_t getDefaultDuty() {return default_duty;}; 
         void setDefaultDuty(uint32_t val) {default_duty = val;};
 
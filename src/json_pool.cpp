@@ -0,0 +1,90 @@
+#include "json_pool.h"
+#include "logger.h"
+
+// every block is prefixed with its size, which keeps the blocks aligned as well
+#define ARENA_HEADER_SIZE 8
+
+bool ArenaAllocator::begin(size_t size) {
+    if(arena) return true;
+    arena = (uint8_t*)(psramFound()?ps_malloc(size):malloc(size));
+    capacity = (arena?size:0);
+    used = 0;
+    return arena != nullptr;
+}
+
+void* ArenaAllocator::allocate(size_t size) {
+    size_t block = (size + ARENA_HEADER_SIZE + 7) & ~((size_t)7);
+    if(!arena || used + block > capacity)
+        return malloc(size);
+
+    uint8_t *ptr = arena + used;
+    *(size_t*)ptr = size;
+    used += block;
+    if(used > peak) peak = used;
+    return ptr + ARENA_HEADER_SIZE;
+}
+
+void ArenaAllocator::deallocate(void* ptr) {
+    // arena blocks are reclaimed all at once by reset()
+    if(!owns(ptr)) free(ptr);
+}
+
+void* ArenaAllocator::reallocate(void* ptr, size_t new_size) {
+    if(!owns(ptr)) return realloc(ptr, new_size);
+
+    size_t old_size = *(size_t*)((uint8_t*)ptr - ARENA_HEADER_SIZE);
+    if(new_size <= old_size) return ptr;
+
+    void *new_ptr = allocate(new_size);
+    if(new_ptr) memcpy(new_ptr, ptr, old_size);
+    return new_ptr;
+}
+
+void CLJsonPool::begin() {
+    for(int i=0; i < JSON_POOL_SIZE; i++) {
+        if(slots[i].doc) continue;
+        if(!slots[i].allocator.begin(JSON_POOL_ARENA_SIZE))
+            Log.error("Failed to reserve memory for the JSON pool");
+        slots[i].doc = new JsonDocument(&slots[i].allocator);
+    }
+}
+
+JsonDocument * CLJsonPool::acquire() {
+    portENTER_CRITICAL(&mux);
+    for(int i=0; i < JSON_POOL_SIZE; i++) {
+        if(slots[i].doc && !slots[i].busy) {
+            slots[i].busy = true;
+            portEXIT_CRITICAL(&mux);
+            return slots[i].doc;
+        }
+    }
+    portEXIT_CRITICAL(&mux);
+
+    return new JsonDocument();
+}
+
+void CLJsonPool::release(JsonDocument *doc) {
+    if(!doc) return;
+
+    for(int i=0; i < JSON_POOL_SIZE; i++) {
+        if(slots[i].doc == doc) {
+            doc->clear();
+            slots[i].allocator.reset();
+            portENTER_CRITICAL(&mux);
+            slots[i].busy = false;
+            portEXIT_CRITICAL(&mux);
+            return;
+        }
+    }
+
+    delete doc;
+}
+
+size_t CLJsonPool::getPeak() {
+    size_t peak = 0;
+    for(int i=0; i < JSON_POOL_SIZE; i++) 
+        if(slots[i].allocator.getPeak() > peak) peak = slots[i].allocator.getPeak();
+    return peak;
+}
+
+CLJsonPool JsonPool;
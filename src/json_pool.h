@@ -0,0 +1,66 @@
+#ifndef json_pool_h
+#define json_pool_h
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define JSON_POOL_SIZE          2       // number of documents which can be leased at the same time
+#define JSON_POOL_ARENA_SIZE    8192    // memory reserved for each document, in bytes
+
+/**
+ * @brief Bump allocator working on a fixed memory block, which is reserved once (in PSRAM if available).
+ * Memory released by the document is only reclaimed by reset(). Requests which do not fit into the block
+ * are served from the regular heap.
+ * 
+ */
+class ArenaAllocator : public ArduinoJson::Allocator {
+    public:
+        bool begin(size_t size);
+
+        void* allocate(size_t size) override;
+        void deallocate(void* ptr) override;
+        void* reallocate(void* ptr, size_t new_size) override;
+
+        void reset() {used = 0;};
+        size_t getPeak() {return peak;};
+
+    private:
+        bool owns(void* ptr) {return arena && (uint8_t*)ptr >= arena && (uint8_t*)ptr < arena + capacity;};
+
+        uint8_t *arena = nullptr;
+        size_t capacity = 0;
+        size_t used = 0;
+        size_t peak = 0;
+};
+
+/**
+ * @brief Pool of pre-sized JSON documents used for serializing the status responses.
+ * Avoids building the documents on the internal heap on every request.
+ * 
+ */
+class CLJsonPool {
+    public:
+        /// @brief reserves the memory of the pool. Must be called after PSRAM has been initialized.
+        void begin();
+
+        /// @brief leases a document from the pool. If the pool is exhausted, a heap backed document is created.
+        /// @return empty document, never NULL
+        JsonDocument * acquire();
+
+        /// @brief returns the document to the pool
+        /// @param doc document obtained with acquire()
+        void release(JsonDocument *doc);
+
+        /// @brief highest number of bytes ever used in a pooled document
+        size_t getPeak();
+
+    private:
+        struct Slot {ArenaAllocator allocator; JsonDocument *doc = nullptr; bool busy = false;};
+
+        Slot slots[JSON_POOL_SIZE];
+        portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+extern CLJsonPool JsonPool;
+
+#endif
@@ -0,0 +1,148 @@
+#include "ledc_plan.h"
+
+CLLedcPlanner::CLLedcPlanner() {
+    memset(timers, 0, sizeof(timers));
+}
+
+void CLLedcPlanner::reserveTimer(int timer) {
+    if(timer < 0 || timer >= LEDC_TIMER_COUNT) return;
+    timers[timer].reserved = true;
+    for(int slot = 0; slot < LEDC_TIMER_CHANNELS; slot++)
+        channel_used[channelOf(timer, slot)] = true;
+}
+
+bool CLLedcPlanner::isPossible(uint32_t freq, uint8_t bits) {
+    return freq > 0 && bits > 0 && bits <= SOC_LEDC_TIMER_BIT_WIDE_NUM &&
+           ((uint64_t)freq << bits) <= LEDC_APB_CLOCK;
+}
+
+int CLLedcPlanner::add(uint32_t freq, uint8_t bits) {
+    if(request_count >= NUM_PWM || !isPossible(freq, bits)) return -1;
+    requests[request_count] = {freq, bits, -1};
+    return request_count++;
+}
+
+void CLLedcPlanner::assign(int request, int timer) {
+    LedcTimerPlan &t = timers[timer];
+    t.freq = requests[request].freq;
+    t.bits = requests[request].bits;
+    for(int slot = 0; slot < LEDC_TIMER_CHANNELS; slot++) {
+        int channel = channelOf(timer, slot);
+        if(!channel_used[channel]) {
+            channel_used[channel] = true;
+            requests[request].channel = channel;
+            t.used++;
+            return;
+        }
+    }
+}
+
+int CLLedcPlanner::place(int request) {
+    const LedcRequest &r = requests[request];
+    int free_timer = -1;
+    for(int t = 0; t < LEDC_TIMER_COUNT; t++) {
+        if(timers[t].reserved) continue;
+        if(timers[t].used == 0) {
+            if(free_timer < 0) free_timer = t;
+        } else if(timers[t].used < LEDC_TIMER_CHANNELS && timers[t].freq == r.freq && timers[t].bits == r.bits) {
+            // a timer of the same group with a free channel comes first
+            assign(request, t);
+            return requests[request].channel;
+        }
+    }
+    if(free_timer < 0) return -1;
+    assign(request, free_timer);
+    return requests[request].channel;
+}
+
+int CLLedcPlanner::plan() {
+    for(int t = 0; t < LEDC_TIMER_COUNT; t++)
+        if(!timers[t].reserved) timers[t] = {0, 0, 0, false};
+    for(int c = 0; c < NUM_PWM; c++)
+        channel_used[c] = timers[(c / 8) * 4 + (c % 8) / 2].reserved;
+    for(int i = 0; i < request_count; i++) requests[i].channel = -1;
+
+    // pairs of the same group fill a timer each, so they go first; the groups keep the order of the config
+    for(int i = 0; i < request_count; i++) {
+        if(requests[i].channel >= 0) continue;
+        for(int j = i + 1; j < request_count; j++) {
+            if(requests[j].channel >= 0 || requests[j].freq != requests[i].freq || requests[j].bits != requests[i].bits)
+                continue;
+            int t = 0;
+            while(t < LEDC_TIMER_COUNT && (timers[t].reserved || timers[t].used > 0)) t++;
+            if(t == LEDC_TIMER_COUNT) break;
+            assign(i, t);
+            assign(j, t);
+            break;
+        }
+    }
+
+    // then the single ones, sharing a timer with their group where possible
+    unplaced = 0;
+    for(int i = 0; i < request_count; i++)
+        if(requests[i].channel < 0 && place(i) < 0) unplaced++;
+    return unplaced;
+}
+
+int CLLedcPlanner::allocate(uint32_t freq, uint8_t bits) {
+    int request = add(freq, bits);
+    if(request < 0) return -1;
+    int channel = place(request);
+    if(channel < 0) unplaced++;
+    return channel;
+}
+
+int CLLedcPlanner::getCapacity(uint32_t freq, uint8_t bits) {
+    if(!isPossible(freq, bits) || request_count >= NUM_PWM) return 0;
+    int free = 0;
+    for(int t = 0; t < LEDC_TIMER_COUNT; t++) {
+        if(timers[t].reserved) continue;
+        if(timers[t].used == 0) free += LEDC_TIMER_CHANNELS;
+        else if(timers[t].freq == freq && timers[t].bits == bits) free += LEDC_TIMER_CHANNELS - timers[t].used;
+    }
+    return min(free, NUM_PWM - request_count);
+}
+
+void CLLedcPlanner::dumpToJson(JsonObject json) {
+    int free_timers = 0;
+    JsonArray list = json["timers"].to<JsonArray>();
+    for(int t = 0; t < LEDC_TIMER_COUNT; t++) {
+        JsonObject timer = list.add<JsonObject>();
+        timer["speed"] = (t < 4?"high":"low");
+        timer["timer"] = t % 4;
+        if(timers[t].reserved) {
+            timer["reserved"] = true;
+            continue;
+        }
+        timer["used"] = timers[t].used;
+        if(timers[t].used > 0) {
+            timer["frequency"] = timers[t].freq;
+            timer["resolution"] = timers[t].bits;
+        } else
+            free_timers++;
+    }
+
+    json["outputs"] = request_count;
+    json["unplaced"] = unplaced;
+    json["free_timers"] = free_timers;
+    // a new frequency needs a free timer
+    json["free_any"] = min(free_timers * LEDC_TIMER_CHANNELS, NUM_PWM - request_count);
+
+    // what can still be added next to the configured groups
+    JsonArray capacity = json["capacity"].to<JsonArray>();
+    for(int t = 0; t < LEDC_TIMER_COUNT; t++) {
+        if(timers[t].reserved || timers[t].used == 0) continue;
+        bool listed = false;
+        for(int u = 0; u < t; u++)
+            if(!timers[u].reserved && timers[u].used > 0 && timers[u].freq == timers[t].freq && timers[u].bits == timers[t].bits)
+                listed = true;
+        if(listed) continue;
+
+        JsonObject group = capacity.add<JsonObject>();
+        group["frequency"] = timers[t].freq;
+        group["resolution"] = timers[t].bits;
+        group["free"] = getCapacity(timers[t].freq, timers[t].bits);
+    }
+}
+
+CLLedcPlanner LedcPlanner;
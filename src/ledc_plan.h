@@ -0,0 +1,88 @@
+#ifndef ledc_plan_h
+#define ledc_plan_h
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <soc/soc_caps.h>
+#include "esp32pwm.h"
+
+// The Arduino core maps LEDC channel c to timer (c/2)%4 of the speed mode c/8: 8 timers of 2 channels each.
+// The two channels of a timer run with the same frequency and resolution.
+#define LEDC_TIMER_COUNT        8
+#define LEDC_TIMER_CHANNELS     2
+#define LEDC_CAMERA_TIMER       0           // high speed timer 0 (channels 0 and 1) clocks the camera (XCLK)
+#define LEDC_APB_CLOCK          80000000    // Hz; frequency * 2^resolution must not exceed it
+
+/**
+ * @brief PWM output waiting for its channel
+ *
+ */
+struct LedcRequest {
+    uint32_t freq;
+    uint8_t bits;
+    int8_t channel;         // assigned channel, -1 if it did not fit
+};
+
+/**
+ * @brief Configuration of one LEDC timer in the plan
+ *
+ */
+struct LedcTimerPlan {
+    uint32_t freq;
+    uint8_t bits;
+    uint8_t used;           // channels assigned
+    bool reserved;          // used outside of the PWM outputs
+};
+
+/**
+ * @brief LEDC channel planner
+ * Assigns the PWM outputs to the LEDC channels knowing all of them up front: the outputs are grouped by
+ * frequency and resolution, and every timer is given to a single group. Pairs of outputs of the same group
+ * are placed first, as they fill a timer completely, then the single ones. Unlike a first come, first served
+ * allocation, mixing 50 Hz servos with a 50 kHz lamp does not waste timers, and what does not fit is
+ * reported instead of halting. Outputs added after the plan take the free channels left.
+ *
+ */
+class CLLedcPlanner {
+    public:
+        CLLedcPlanner();
+
+        /// @brief excludes a timer and its channels from the plan
+        void reserveTimer(int timer);
+
+        /// @brief registers an output for the next plan()
+        /// @return request number, or -1 if the frequency and resolution are not possible
+        int add(uint32_t freq, uint8_t bits);
+
+        /// @brief assigns the channels to all registered outputs
+        /// @return number of outputs which could not be placed
+        int plan();
+
+        /// @brief places one more output after the plan, without moving the others
+        /// @return channel, or -1 if there is no room for it
+        int allocate(uint32_t freq, uint8_t bits);
+
+        /// @return channel assigned to the request, or -1
+        int getChannel(int request) {return (request >= 0 && request < request_count?requests[request].channel:-1);};
+
+        /// @return number of outputs which can still be added with this frequency and resolution
+        int getCapacity(uint32_t freq, uint8_t bits);
+
+        void dumpToJson(JsonObject json);
+
+    private:
+        bool isPossible(uint32_t freq, uint8_t bits);
+        int place(int request);
+        void assign(int request, int timer);
+        static int channelOf(int timer, int slot) {return (timer / 4) * 8 + (timer % 4) * 2 + slot;};
+
+        LedcRequest requests[NUM_PWM];
+        int request_count = 0;
+        LedcTimerPlan timers[LEDC_TIMER_COUNT];
+        bool channel_used[NUM_PWM] = {};
+        int unplaced = 0;
+};
+
+extern CLLedcPlanner LedcPlanner;
+
+#endif
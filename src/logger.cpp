@@ -0,0 +1,184 @@
+#include "logger.h"
+
+static const char level_tags[] = {'E', 'W', 'I', 'D', ' '};
+
+/**
+ * @brief Queued message. The text follows the header and is not terminated.
+ *
+ */
+struct LogItem {
+    uint32_t ms;
+    uint8_t level;
+    bool eol;               // a line ending follows; not for the pieces of a long raw string
+    char text[];
+};
+
+bool CLLogger::begin() {
+    if(ring) return true;
+
+    history = (char*)(psramFound()?ps_malloc(LOG_HISTORY_SIZE):malloc(LOG_HISTORY_SIZE));
+    history_mutex = xSemaphoreCreateMutex();
+    ring = xRingbufferCreate(LOG_RING_SIZE, RINGBUF_TYPE_NOSPLIT);
+
+    if(!ring || !history_mutex || !history ||
+       xTaskCreate(logDrainTask, "log", LOG_DRAIN_STACK_SIZE, NULL, LOG_DRAIN_PRIORITY, NULL) != pdPASS) {
+        if(ring) vRingbufferDelete(ring);
+        ring = NULL;
+        Serial.println("Failed to start the logger, writing to Serial directly");
+        return false;
+    }
+    return true;
+}
+
+void CLLogger::error(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vlog(LOG_LEVEL_ERROR, fmt, args);
+    va_end(args);
+}
+
+void CLLogger::warn(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vlog(LOG_LEVEL_WARN, fmt, args);
+    va_end(args);
+}
+
+void CLLogger::info(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vlog(LOG_LEVEL_INFO, fmt, args);
+    va_end(args);
+}
+
+void CLLogger::debug(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vlog(LOG_LEVEL_DEBUG, fmt, args);
+    va_end(args);
+}
+
+void CLLogger::raw(const char *str, const char *prefix) {
+    // the serial protocol should not lose anything, so the pieces wait a while for the drain task
+    if(prefix && !enqueue(LOG_RAW, prefix, strlen(prefix), false, pdMS_TO_TICKS(LOG_RAW_WAIT))) return;
+
+    size_t len = strlen(str);
+    do {
+        size_t piece = (len > LOG_RAW_CHUNK?LOG_RAW_CHUNK:len);
+        if(!enqueue(LOG_RAW, str, piece, piece == len, pdMS_TO_TICKS(LOG_RAW_WAIT))) return;
+        str += piece;
+        len -= piece;
+    } while(len > 0);
+}
+
+void CLLogger::vlog(int lvl, const char *fmt, va_list args) {
+    if(lvl > level) return;
+
+    char buf[LOG_LINE_LENGTH];
+    int len = vsnprintf(buf, sizeof(buf), fmt, args);
+    if(len < 0) return;
+    if(len >= (int)sizeof(buf)) len = sizeof(buf) - 1;
+
+    // line endings are added by the drain task
+    while(len > 0 && (buf[len-1] == '\n' || buf[len-1] == '\r')) len--;
+    enqueue(lvl, buf, len);
+}
+
+void CLLogger::json(int lvl, const char *label, JsonVariantConst doc) {
+    if(lvl > level) return;
+
+    char *buf = (char*)malloc(LOG_JSON_LENGTH);
+    if(!buf) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    size_t len = snprintf(buf, LOG_JSON_LENGTH, "%s", label);
+    len += serializeJson(doc, buf + len, LOG_JSON_LENGTH - len);
+    enqueue(lvl, buf, len);
+    free(buf);
+}
+
+bool CLLogger::enqueue(int lvl, const char *text, size_t len, bool eol, TickType_t wait) {
+    if(!ring) {
+        Serial.write((const uint8_t*)text, len);
+        if(eol) Serial.println();
+        return true;
+    }
+
+    void *ptr = NULL;
+    if(xRingbufferSendAcquire(ring, &ptr, sizeof(LogItem) + len, wait) != pdTRUE) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    LogItem *item = (LogItem*)ptr;
+    item->ms = millis();
+    item->level = lvl;
+    item->eol = eol;
+    memcpy(item->text, text, len);
+    xRingbufferSendComplete(ring, ptr);
+    return true;
+}
+
+void CLLogger::drain() {
+    size_t size;
+    LogItem *item = (LogItem*)xRingbufferReceive(ring, &size, portMAX_DELAY);
+    if(!item) return;
+
+    size_t len = size - sizeof(LogItem);
+    Serial.write((const uint8_t*)item->text, len);
+    if(item->eol) Serial.println();
+
+    if(item->level != LOG_RAW) {
+        char line[LOG_JSON_LENGTH + 24];
+        int hlen = snprintf(line, sizeof(line), "%lu.%03lu %c ",
+                            (unsigned long)(item->ms / 1000), (unsigned long)(item->ms % 1000), level_tags[item->level]);
+        if(len > sizeof(line) - hlen - 1) len = sizeof(line) - hlen - 1;
+        memcpy(line + hlen, item->text, len);
+        len += hlen;
+        line[len++] = '\n';
+
+        appendHistory(line, len);
+        LogTailCallback cb = tail;
+        if(cb) cb(line, len);
+    }
+    vRingbufferReturnItem(ring, item);
+}
+
+void CLLogger::appendHistory(const char *str, size_t len) {
+    if(len > LOG_HISTORY_SIZE) return;
+
+    xSemaphoreTake(history_mutex, portMAX_DELAY);
+    size_t first = LOG_HISTORY_SIZE - history_head;
+    if(len < first) {
+        memcpy(history + history_head, str, len);
+        history_head += len;
+    }
+    else {
+        memcpy(history + history_head, str, first);
+        memcpy(history, str + first, len - first);
+        history_head = len - first;
+        history_wrapped = true;
+    }
+    xSemaphoreGive(history_mutex);
+}
+
+void CLLogger::printHistory(Print &out) {
+    if(!history_mutex || !history) return;
+
+    xSemaphoreTake(history_mutex, portMAX_DELAY);
+    if(history_wrapped) {
+        // skip the partially overwritten line
+        size_t start = history_head;
+        while(start < LOG_HISTORY_SIZE && history[start] != '\n') start++;
+        if(start + 1 < LOG_HISTORY_SIZE)
+            out.write((const uint8_t*)history + start + 1, LOG_HISTORY_SIZE - start - 1);
+    }
+    out.write((const uint8_t*)history, history_head);
+    xSemaphoreGive(history_mutex);
+}
+
+void logDrainTask(void *pvParameters) {
+    while(true) Log.drain();
+}
+
+CLLogger Log;
@@ -0,0 +1,86 @@
+#ifndef logger_h
+#define logger_h
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/ringbuf.h>
+#include <freertos/semphr.h>
+#include <ArduinoJson.h>
+
+#define LOG_LINE_LENGTH         192     // longest formatted message, longer ones are truncated
+#define LOG_JSON_LENGTH         1024    // longest JSON dump
+#define LOG_RING_SIZE           4096    // messages waiting for the drain task
+#define LOG_HISTORY_SIZE        8192    // recent messages kept for /log
+#define LOG_DRAIN_STACK_SIZE    4096
+#define LOG_DRAIN_PRIORITY      1
+#define LOG_RAW_CHUNK           256     // raw output is queued in pieces of this size, waiting for room
+#define LOG_RAW_WAIT            250     // ms a piece of raw output may wait for room before it is dropped
+
+/**
+ * @brief Log levels. LOG_RAW is always written to Serial as is, but it is not kept in the history
+ * (used by the serial command protocol). Unlike the messages, it waits for room in the ring before it is dropped.
+ *
+ */
+enum LogLevelEnum {LOG_LEVEL_ERROR, LOG_LEVEL_WARN, LOG_LEVEL_INFO, LOG_LEVEL_DEBUG, LOG_RAW};
+
+typedef void (*LogTailCallback)(const char *line, size_t len);
+
+/**
+ * @brief Leveled logger
+ * Messages are formatted on the caller's stack and queued into a ring buffer without waiting, so
+ * logging never blocks the caller. If the ring is full the message is dropped and counted. A low
+ * priority task drains the ring to Serial, keeps the recent messages for /log and passes them to
+ * the tail callback. Before begin() is called the messages are written to Serial directly.
+ *
+ */
+class CLLogger {
+    public:
+        bool begin();
+
+        void setLevel(int val) {if(val >= LOG_LEVEL_ERROR && val <= LOG_LEVEL_DEBUG) level = val;};
+        int getLevel() {return level;};
+
+        void error(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+        void warn(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+        void info(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+        void debug(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+        /// @brief queues the string to Serial without a level prefix and without keeping it in the history.
+        /// Long strings are queued in pieces; each one waits up to LOG_RAW_WAIT for room in the ring, as the
+        /// caller may be the network task. The rest of a string which could not be queued is dropped and counted.
+        /// @param prefix written before the string, e.g. the marker of a serial command
+        void raw(const char *str, const char *prefix = nullptr);
+
+        /// @brief logs the compact JSON serialization of the document, prefixed with the label
+        void json(int lvl, const char *label, JsonVariantConst doc);
+
+        /// @brief writes the history, oldest message first
+        void printHistory(Print &out);
+
+        void setTailCallback(LogTailCallback cb) {tail = cb;};
+
+        uint32_t getDropped() {return dropped.load(std::memory_order_relaxed);};
+
+        void drain();
+
+    private:
+        void vlog(int lvl, const char *fmt, va_list args);
+        bool enqueue(int lvl, const char *text, size_t len, bool eol = true, TickType_t wait = 0);
+        void appendHistory(const char *str, size_t len);
+
+        RingbufHandle_t ring = NULL;
+        SemaphoreHandle_t history_mutex = NULL;
+        char *history = nullptr;
+        size_t history_head = 0;
+        bool history_wrapped = false;
+
+        volatile int level = LOG_LEVEL_DEBUG;
+        volatile LogTailCallback tail = NULL;
+        std::atomic<uint32_t> dropped{0};
+};
+
+void logDrainTask(void *pvParameters);
+
+extern CLLogger Log;
+
+#endif
@@ -5,6 +5,14 @@
 #include <app_cam.h>        // Camera 
 #include <app_httpd.h>      // Web server
 #include <camera_pins.h>    // Pin Mappings
+#include <boot_profile.h>   // Startup timing
+
+#define CAMERA_START_STACK_SIZE 8192
+
+// The loop sleeps until it is notified (serial input, WiFi events) or until the next tick, which polls
+// OTA, the captive portal DNS and the connection timeouts
+#define LOOP_TICK_MS            50
+#define LOOP_TICK_PORTAL_MS     10
 
 /* 
  * This sketch is a extension/expansion/rework of the ESP32 Camera webserer example.
@@ -22,24 +30,30 @@ void flashLED(int flashtime) {
 
 // @brief tries to initialize the filesystem until success, otherwise loops indefinitely
 void filesystemStart() {
-  Serial.println("Starting filesystem");
+  Log.info("Starting filesystem");
   while ( !Storage.init() ) {
     // if we sit in this loop something is wrong;
-    Serial.println("Filesystem mount failed");
+    Log.error("Filesystem mount failed");
     for (int i=0; i<10; i++) {
       flashLED(100); // Show filesystem failure
       delay(100);
     }
     delay(1000);
-    Serial.println("Retrying..");
+    Log.info("Retrying..");
   }
   
   // Storage.listDir("/", 0);
 }
 
+// task running setup() and loop(); notified when the camera is started, on serial input and on WiFi events
+TaskHandle_t setup_task = NULL;
+volatile bool camera_ready = false;
+
+unsigned long last_ws_cleanup = 0;
+
 // Serial input 
 void handleSerial() {
-    if(Serial.available()) {
+    while(Serial.available()) {
         char cmd = Serial.read();
 
         // Rceiving commands and data from serial. Any input, which doesnt start from '#' is ignored.
@@ -47,10 +61,12 @@ void handleSerial() {
             String rsp = Serial.readStringUntil('\n');
             rsp.trim();
             snprintf(AppHttpd.getSerialBuffer(), SERIAL_BUFFER_SIZE, rsp.c_str());
+            AppHttpd.touchStatus();
         }
     }
 }
 
+// Flash the LED to show we are connected
 void notifyConnect() {
     for (int i = 0; i < 5; i++) {
         flashLED(150);
@@ -59,10 +75,23 @@ void notifyConnect() {
     AppHttpd.serialSendCommand("Connected");
 }
 
+void onSerialReceive() {
+    if(setup_task) xTaskNotifyGive(setup_task);
+}
+
+// sleeps until notified, or until the next service tick
+void waitForWork() {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(AppConn.isCaptivePortal()?LOOP_TICK_PORTAL_MS:LOOP_TICK_MS));
+}
+
 void notifyDisconnect() {
     AppHttpd.serialSendCommand("Disconnected");
 }
 
+bool isStreaming() {
+    return AppHttpd.getStreamCount() > 0;
+}
+
 void scheduleReboot(int delay) {
     esp_task_wdt_init(delay,true);
     esp_task_wdt_add(NULL);
@@ -76,117 +105,143 @@ void resetI2CBus() {
     periph_module_reset(PERIPH_I2C1_MODULE);
 }
 
+// Initialises the camera, applies its preferences and takes the first frame, so the sensor has settled
+// by the time the first client asks for an image
+void cameraStart() {
+#ifndef USE_LittleFS
+    delay(200); // a short delay to let spi bus settle after the SD card init
+#endif
+    if (AppCam.start() == OS_SUCCESS) {
+        Log.info("Camera init succeeded");
+        BootProfile.mark("camera");
+    }
+
+    AppCam.loadPrefs();
+    BootProfile.mark("camera_prefs");
+
+    if(!AppCam.getLastErr() && AppCam.snapToBuffer() == ESP_OK) {
+        AppCam.releaseBuffer();
+        BootProfile.mark("first_frame");
+    }
+}
+
+void cameraStartTask(void *pvParameters) {
+    cameraStart();
+    camera_ready = true;
+    xTaskNotifyGive(setup_task);
+    vTaskDelete(NULL);
+}
+
 void setup() {
     Serial.begin(115200);
     Serial.setDebugOutput(true);
+    Log.begin();
 
-    Serial.println("Start ESP32 Cam Webserver");
-    Serial.println("Initialize....");
+    Log.info("Start ESP32 Cam Webserver");
+    Log.info("Initialize....");
 
     // Warn if no PSRAM is detected (typically user error with board selection in the IDE)
     if(!psramFound()){
-        Serial.println("\r\nFatal Error; Halting");
+        Log.error("Fatal Error; Halting");
         while (true) {
-            Serial.println("No PSRAM found; camera cannot be initialised: Please check the board config for your module.");
+            Log.error("No PSRAM found; camera cannot be initialised: Please check the board config for your module.");
             delay(5000);
         }
     }
 
+    #ifdef ENABLE_TRACE
+        Trace.begin();
+    #endif
+
     #if defined(LED_PIN)  // If we have a notification LED, set it to output
         pinMode(LED_PIN, OUTPUT);
     #endif
 
     // Start the filesystem before we initialise the camera
     filesystemStart();
-    delay(200); // a short delay to let spi bus settle after init
-
-    // Start (init) the camera 
-    if (AppCam.start() != OS_SUCCESS) {
-        delay(100);  // need a delay here or the next serial o/p gets missed
-        Serial.println();
-        Serial.print("CRITICAL FAILURE:"); Serial.println(AppCam.getErr());
-        Serial.println("A full (hard, power off/on) reboot will probably be needed to recover from this.");
-        Serial.println("Meanwhile; this unit will reboot in 1 minute since these errors sometime clear automatically");
-        resetI2CBus();
-        scheduleReboot(60);
+    BootProfile.mark("filesystem");
+
+    // Start (init) the camera in parallel with the WiFi connection; both need the filesystem only
+    setup_task = xTaskGetCurrentTaskHandle();
+    Serial.onReceive(onSerialReceive);
+    bool parallel = (xTaskCreatePinnedToCore(cameraStartTask, "CamStart", CAMERA_START_STACK_SIZE, NULL, 1, NULL, 
+                                             xPortGetCoreID()) == pdPASS);
+    if(!parallel) {
+        Log.warn("Failed to start the camera in parallel, starting it now");
+        cameraStart();
+        camera_ready = true;
     }
-    else
-        Serial.println("Camera init succeeded");
-
-    // Now load and apply preferences
-    delay(200); // a short delay to let spi bus settle after camera init
-    AppCam.loadPrefs();
-
-    /*
-    * Camera setup complete; initialise the rest of the hardware.
-    */
 
-    // Start Wifi and loop until we are connected or have started an AccessPoint
-    while (AppConn.wifiStatus() != WL_CONNECTED)  {
-        if(AppConn.start() != WL_CONNECTED) {
-            Serial.println("Failed to initiate WiFi, retryng in 5 sec ... ");
+    // Start Wifi and wait until we are connected or have started an AccessPoint
+    AppConn.setOnConnect(notifyConnect);
+    AppConn.setOnDisconnect(notifyDisconnect);
+    AppConn.setBusyCheck(isStreaming);
+    AppConn.setNotifyTask(setup_task);
+    AppConn.start();
+    while (!AppConn.isConnected())  {
+        if(AppConn.getState() == CONN_IDLE) {
+            Log.warn("Failed to initiate WiFi, retryng in 5 sec ... ");
             delay(5000);
+            AppConn.start();
         }
-        else {
-            // Flash the LED to show we are connected
-            notifyConnect();
-        }
+        AppConn.handle();
+        handleSerial();
+        waitForWork();
     }
+    BootProfile.mark("wifi");
 
     // Set time via NTP server when enabled
     if(!AppConn.isAccessPoint()) {
         AppConn.configNTP();
-        Serial.print("Time: ");
         AppConn.printLocalTime(true);
     }
 
+    // wait for the camera before serving the web pages
+    // (the task is notified on serial input and WiFi events as well)
+    while(!camera_ready) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    if (AppCam.getLastErr()) {
+        Log.error("CRITICAL FAILURE:%s", AppCam.getErr().c_str());
+        Log.error("A full (hard, power off/on) reboot will probably be needed to recover from this.");
+        Log.error("Meanwhile; this unit will reboot in 1 minute since these errors sometime clear automatically");
+        resetI2CBus();
+        scheduleReboot(60);
+    }
+
+    /*
+    * Camera and network setup complete; initialise the rest of the hardware.
+    */
+
     // Start the web server
     AppHttpd.start();
+    BootProfile.mark("httpd");
+
+    // Start the push publisher, if configured in /push.json
+    AppPush.start();
+
+    // Start the MQTT client, if configured in /mqtt.json
+    AppMqtt.start();
 
 }
 
 void loop() {
     /*
-     *  Just loop forever, reconnecting Wifi As necesscary in client mode
-     * The stream and URI handler processes initiated by the startCameraServer() call at the
-     * end of setup() will handle the camera and UI processing from now on.
+     * The stream and URI handler processes initiated by AppHttpd.start() at the end of setup() will 
+     * handle the camera and UI processing from now on. The connection state machine takes care of 
+     * the reconnects in client mode; none of the calls below blocks.
     */
-    if (AppConn.isAccessPoint()) {
-        // Accespoint is permanently up, so just loop, servicing the captive portal as needed
-        // Rather than loop forever, follow the watchdog, in case we later add auto re-scan.
-        unsigned long pingwifi = millis();
-        while (millis() - pingwifi < WIFI_WATCHDOG ) {
-            // delay(100);
-            AppConn.handleOTA();
-            handleSerial();
-            AppConn.handleDNSRequest();
-        }
+    waitForWork();
+
+    AppConn.handle();
+    AppConn.handleOTA();
+    handleSerial();
+    AppConn.handleDNSRequest();
+
+    if(millis() - last_ws_cleanup >= WIFI_WATCHDOG) {
         AppHttpd.cleanupWsClients();
-    } else {
-        // client mode can fail; so reconnect as appropriate
-
-        if (AppConn.wifiStatus() == WL_CONNECTED) {
-            // We are connected
-            // loop here for §
-            unsigned long pingwifi = millis();
-            while (millis() - pingwifi < WIFI_WATCHDOG ) {
-                AppConn.handleOTA();
-                handleSerial();
-            }
-            AppHttpd.cleanupWsClients();
-        } else {
-            // disconnected; notify 
-            notifyDisconnect();
-
-            // ensures disconnect is complete, wifi scan cleared
-            AppConn.stop();  
-
-            //attempt to reconnect
-            if(AppConn.start() == WL_CONNECTED) {
-                notifyConnect();
-            }
-            
-        }
+        last_ws_cleanup = millis();
     }
-}
 
+    // a burst of notifications would let the loop run back to back; the idle task keeps its share
+    vTaskDelay(1);
+}
@@ -0,0 +1,123 @@
+#include "metrics.h"
+#include <esp_freertos_hooks.h>
+
+static const uint32_t fb_get_bounds[] = {1000, 2000, 5000, 10000, 20000, 40000, 80000, 160000, 320000};
+static const uint32_t jpeg_bounds[] = {8192, 16384, 32768, 65536, 131072, 262144};
+static const uint32_t ws_enqueue_bounds[] = {100, 250, 500, 1000, 2500, 5000, 10000, 25000};
+static const uint32_t control_rtt_bounds[] = {5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000};
+static const uint32_t trigger_latency_bounds[] = {10000, 20000, 50000, 100000, 200000, 500000, 1000000, 2000000};
+
+#define BOUNDS(b) b, (int)(sizeof(b)/sizeof(b[0]))
+
+void MetricHistogram::observe(uint32_t value) {
+    int i = 0;
+    while(i < nbounds && value > bounds[i]) i++;
+    buckets[i].fetch_add(1, std::memory_order_relaxed);
+    uint32_t previous = sum.fetch_add(value);
+    if((uint32_t)(previous + value) < previous) sum_wraps.fetch_add(1);
+}
+
+void MetricHistogram::print(Print &out, const char *name, const char *help, float scale) {
+    out.printf("# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+
+    uint32_t cumulative = 0;
+    for(int i=0; i < nbounds; i++) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        out.printf("%s_bucket{le=\"%g\"} %u\n", name, bounds[i] / scale, (unsigned)cumulative);
+    }
+    cumulative += buckets[nbounds].load(std::memory_order_relaxed);
+    out.printf("%s_bucket{le=\"+Inf\"} %u\n", name, (unsigned)cumulative);
+    // read again if a wrap was counted in between
+    uint32_t wraps, low;
+    do {
+        wraps = sum_wraps.load();
+        low = sum.load();
+    } while(wraps != sum_wraps.load());
+    uint64_t total = ((uint64_t)wraps << 32) | low;
+    out.printf("%s_sum %.15g\n", name, (double)total / scale);
+    out.printf("%s_count %u\n", name, (unsigned)cumulative);
+}
+
+CLMetrics::CLMetrics() : 
+    fb_get_us(BOUNDS(fb_get_bounds)),
+    jpeg_bytes(BOUNDS(jpeg_bounds)),
+    ws_enqueue_us(BOUNDS(ws_enqueue_bounds)),
+    control_rtt_us(BOUNDS(control_rtt_bounds)),
+    trigger_latency_us(BOUNDS(trigger_latency_bounds)) {
+}
+
+static void IRAM_ATTR cpu0TickHook() {
+    Metrics.countTick(0);
+}
+
+#if portNUM_PROCESSORS > 1
+static void IRAM_ATTR cpu1TickHook() {
+    Metrics.countTick(1);
+}
+#endif
+
+bool CLMetrics::beginCpuLoad() {
+    for(int i=0; i < portNUM_PROCESSORS; i++)
+        idle_tasks[i] = xTaskGetIdleTaskHandleForCPU(i);
+
+    bool ok = (esp_register_freertos_tick_hook_for_cpu(cpu0TickHook, 0) == ESP_OK);
+#if portNUM_PROCESSORS > 1
+    ok = ok && (esp_register_freertos_tick_hook_for_cpu(cpu1TickHook, 1) == ESP_OK);
+#endif
+    return ok;
+}
+
+void IRAM_ATTR CLMetrics::countTick(int core) {
+    // the tick interrupt of a core only runs on that core, so the counters need no locking
+    total_ticks[core]++;
+    if(xTaskGetCurrentTaskHandleForCPU(core) == idle_tasks[core]) idle_ticks[core]++;
+}
+
+void CLMetrics::sampleCpuLoad() {
+    for(int i=0; i < portNUM_PROCESSORS; i++) {
+        uint32_t idle = idle_ticks[i], total = total_ticks[i];
+        uint32_t d_total = total - last_total[i];
+        if(d_total > 0) cpu_idle[i] = (uint8_t)((uint64_t)(idle - last_idle[i]) * 100 / d_total);
+        last_idle[i] = idle;
+        last_total[i] = total;
+    }
+}
+
+void CLMetrics::printCounter(Print &out, const char *name, const char *help, uint32_t value) {
+    out.printf("# HELP %s %s\n# TYPE %s counter\n%s %u\n", name, help, name, name, (unsigned)value);
+}
+
+void CLMetrics::printGauge(Print &out, const char *name, const char *help, uint32_t value) {
+    out.printf("# HELP %s %s\n# TYPE %s gauge\n%s %u\n", name, help, name, name, (unsigned)value);
+}
+
+void CLMetrics::print(Print &out) {
+    fb_get_us.print(out, "esp32cam_fb_get_seconds", "Latency of esp_camera_fb_get()", 1000000);
+    jpeg_bytes.print(out, "esp32cam_jpeg_size_bytes", "Size of the captured JPEG frames");
+    ws_enqueue_us.print(out, "esp32cam_ws_enqueue_seconds", "Time to enqueue a frame for the websocket clients", 1000000);
+    control_rtt_us.print(out, "esp32cam_control_rtt_seconds", "Round trip of the pings to the websocket control client", 1000000);
+    trigger_latency_us.print(out, "esp32cam_trigger_latency_seconds", "From the edge of a trigger input to its first frame", 1000000);
+
+    printCounter(out, "esp32cam_frames_captured_total", "Frames captured", frames_captured.get());
+    printCounter(out, "esp32cam_frames_dropped_total", "Frames dropped because the clients were busy", frames_dropped.get());
+    printCounter(out, "esp32cam_wifi_reconnects_total", "WiFi reconnection attempts", wifi_reconnects.get());
+    printCounter(out, "esp32cam_streams_rejected_total", "Video streams rejected", streams_rejected.get());
+    printCounter(out, "esp32cam_control_lane_drops_total", "Video frames withheld to keep the control latency", 
+                 control_lane_drops.get());
+    printCounter(out, "esp32cam_triggers_total", "Captures started by the trigger inputs", triggers.get());
+
+    printGauge(out, "esp32cam_heap_free_bytes", "Free internal heap", ESP.getFreeHeap());
+    printGauge(out, "esp32cam_heap_min_free_bytes", "Lowest free internal heap since boot", ESP.getMinFreeHeap());
+    printGauge(out, "esp32cam_heap_max_alloc_bytes", "Largest allocatable internal heap block", ESP.getMaxAllocHeap());
+    out.printf("# HELP esp32cam_cpu_idle_percent Idle time of the core over the last second\n"
+               "# TYPE esp32cam_cpu_idle_percent gauge\n");
+    for(int i=0; i < portNUM_PROCESSORS; i++)
+        out.printf("esp32cam_cpu_idle_percent{core=\"%d\"} %u\n", i, (unsigned)cpu_idle[i]);
+
+    if(psramFound()) {
+        printGauge(out, "esp32cam_psram_free_bytes", "Free PSRAM", ESP.getFreePsram());
+        printGauge(out, "esp32cam_psram_min_free_bytes", "Lowest free PSRAM since boot", ESP.getMinFreePsram());
+    }
+}
+
+CLMetrics Metrics;
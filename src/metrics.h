@@ -0,0 +1,104 @@
+#ifndef metrics_h
+#define metrics_h
+
+#include <Arduino.h>
+#include <atomic>
+
+#define METRICS_MAX_BUCKETS     12
+
+/**
+ * @brief Monotonic counter. Increments are lock-free and can be done from any task.
+ * 
+ */
+class MetricCounter {
+    public:
+        void inc(uint32_t n = 1) {value.fetch_add(n, std::memory_order_relaxed);};
+        uint32_t get() {return value.load(std::memory_order_relaxed);};
+
+    private:
+        std::atomic<uint32_t> value{0};
+};
+
+/**
+ * @brief Histogram with fixed bucket bounds. Recording an observation is a short bucket scan followed
+ * by lock-free increments, so it is cheap enough to stay enabled in the hot paths.
+ * 
+ */
+class MetricHistogram {
+    public:
+        /// @param bounds upper bounds of the buckets, ascending; must stay valid for the lifetime of the histogram
+        /// @param count number of bounds, at most METRICS_MAX_BUCKETS
+        MetricHistogram(const uint32_t *bounds, int count) : bounds(bounds), 
+            nbounds(count > METRICS_MAX_BUCKETS?METRICS_MAX_BUCKETS:count) {};
+
+        void observe(uint32_t value);
+
+        /// @brief writes the histogram in the Prometheus text format
+        /// @param out destination
+        /// @param name metric name
+        /// @param help description of the metric
+        /// @param scale divisor applied to the bounds and the sum (e.g. 1000000 to report microseconds as seconds)
+        void print(Print &out, const char *name, const char *help, float scale = 1);
+
+    private:
+        const uint32_t *bounds;
+        int nbounds;
+        // the last bucket collects the values above the highest bound (+Inf)
+        std::atomic<uint32_t> buckets[METRICS_MAX_BUCKETS + 1] = {};
+        // the ESP32 has no 64 bit atomics; the sum of the JPEG sizes wraps 32 bits within hours, so the wraps are
+        // counted and print() puts the 64 bit sum back together
+        std::atomic<uint32_t> sum{0};
+        std::atomic<uint32_t> sum_wraps{0};
+};
+
+/**
+ * @brief Metrics Registry
+ * Runtime metrics of the hot paths, exported in the Prometheus text format by the /metrics endpoint.
+ * 
+ */
+class CLMetrics {
+    public:
+        CLMetrics();
+
+        /// @brief writes all metrics in the Prometheus text format
+        /// @param out destination
+        void print(Print &out);
+
+        MetricHistogram fb_get_us;          // esp_camera_fb_get() latency, microseconds
+        MetricHistogram jpeg_bytes;         // size of the captured JPEG frames
+        MetricHistogram ws_enqueue_us;      // time to enqueue a frame for the websocket clients, microseconds
+        MetricHistogram control_rtt_us;     // round trip of the pings to the websocket control client, microseconds
+        MetricHistogram trigger_latency_us; // from the edge of a trigger input to its first frame, microseconds
+
+        MetricCounter frames_captured;
+        MetricCounter frames_dropped;       // frames skipped because the clients could not take them
+        MetricCounter wifi_reconnects;
+        MetricCounter streams_rejected;
+        MetricCounter control_lane_drops;   // video frames withheld from a client to keep the control latency
+        MetricCounter triggers;             // captures started by the trigger inputs
+
+        /// @brief installs the tick hooks counting the idle ticks of each core
+        bool beginCpuLoad();
+        /// @brief computes the idle percentage of each core since the previous call
+        void sampleCpuLoad();
+        /// @return idle time of the core in percent, over the last sampling period
+        uint8_t getCpuIdle(int core) {return (core >= 0 && core < portNUM_PROCESSORS?cpu_idle[core]:0);};
+
+        // called from the tick interrupt
+        void IRAM_ATTR countTick(int core);
+
+    private:
+        void printCounter(Print &out, const char *name, const char *help, uint32_t value);
+        void printGauge(Print &out, const char *name, const char *help, uint32_t value);
+
+        TaskHandle_t idle_tasks[portNUM_PROCESSORS] = {};
+        volatile uint32_t idle_ticks[portNUM_PROCESSORS] = {};
+        volatile uint32_t total_ticks[portNUM_PROCESSORS] = {};
+        uint32_t last_idle[portNUM_PROCESSORS] = {};
+        uint32_t last_total[portNUM_PROCESSORS] = {};
+        uint8_t cpu_idle[portNUM_PROCESSORS] = {};
+};
+
+extern CLMetrics Metrics;
+
+#endif
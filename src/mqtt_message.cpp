@@ -0,0 +1,40 @@
+#include "mqtt_message.h"
+
+// the /control variables which can be set over MQTT: the image and the lamp, not the network or the credentials
+static const char * mqtt_controls[] = {
+    "framesize", "quality", "contrast", "brightness", "saturation", "sharpness", "denoise", "gainceiling",
+    "colorbar", "awb", "agc", "aec", "hmirror", "vflip", "awb_gain", "agc_gain", "aec_value", "aec2", "dcw",
+    "bpc", "wpc", "raw_gma", "lenc", "special_effect", "wb_mode", "ae_level", "rotate", "frame_rate",
+    "autolamp", "lamp", "flashlamp"
+};
+
+void MqttMessage::setFrame(SharedFrame *frame) {
+    frame->retain();
+    shared = frame;
+    payload = nullptr;
+    len = frame->getSize();
+}
+
+void MqttMessage::release() {
+    if(shared) shared->release();
+    else free(payload);
+    shared = nullptr;
+    payload = nullptr;
+    len = 0;
+}
+
+bool isMqttControl(const char *var) {
+    for(int i = 0; i < (int)(sizeof(mqtt_controls)/sizeof(mqtt_controls[0])); i++)
+        if(strcmp(var, mqtt_controls[i]) == 0) return true;
+    return false;
+}
+
+size_t buildStatusDelta(JsonObjectConst current, JsonObjectConst last, JsonDocument &delta, bool full) {
+    delta.clear();
+    for(JsonPairConst kv : current) {
+        if(!full && (kv.key() == "local_time" || kv.key() == "up_time")) continue;
+        if(full || last[kv.key()] != kv.value())
+            delta[kv.key()] = kv.value();
+    }
+    return delta.size();
+}
@@ -0,0 +1,41 @@
+#ifndef mqtt_message_h
+#define mqtt_message_h
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "shared_frame.h"
+
+#define MQTT_SUBTOPIC_LENGTH        32
+
+/**
+ * @brief Message queued for the publisher task. The payload is allocated by the producer and freed by the task,
+ * or it is a frame shared with other consumers, which the task releases. A message without payload only wakes
+ * the task up. A control message carries the variable in the subtopic and its value in the payload.
+ *
+ */
+struct MqttMessage {
+    char subtopic[MQTT_SUBTOPIC_LENGTH];
+    char *payload;
+    size_t len;
+    bool retain;
+    bool frame;                 // JPEG, sent with QoS 0
+    bool control;
+    SharedFrame *shared;        // payload of a frame, instead of payload
+
+    /// @brief takes a reference to the frame as the payload
+    void setFrame(SharedFrame *frame);
+    const char *getData() {return (shared?(const char*)shared->getBuffer():payload);};
+    /// @brief frees the payload or releases the frame; the message is empty afterwards
+    void release();
+};
+
+/// @brief true if the /control variable can be set over MQTT
+bool isMqttControl(const char *var);
+
+/// @brief collects the values of the status which differ from the last published one. The clock values change
+/// every second, so they are only part of the full status
+/// @param full all the values
+/// @return number of values in the delta
+size_t buildStatusDelta(JsonObjectConst current, JsonObjectConst last, JsonDocument &delta, bool full);
+
+#endif
@@ -0,0 +1,189 @@
+#include "multicast.h"
+#include "app_httpd.h"
+
+void RtpFecSink::begin(IPAddress group, uint16_t port, uint8_t fec_group) {
+    media.begin(group, port);
+    fec.begin(group, port + MULTICAST_FEC_PORT_OFFSET);
+    this->fec_group = fec_group;
+    protected_count = 0;
+}
+
+bool RtpFecSink::sendPacket(const uint8_t *packet, size_t len) {
+    bool res = media.sendPacket(packet, len);
+    if(!fec_group) return res;
+
+    uint8_t *payload = parity + MULTICAST_FEC_HEADER_SIZE;
+    if(protected_count == 0) {
+        base_seq = (packet[2] << 8) | packet[3];
+        memset(payload, 0, RTP_MAX_PACKET);
+        parity_len = 0;
+        length_xor = 0;
+    }
+
+    // the packet is protected even if it could not be sent; the receiver restores it like a lost one
+    for(size_t i = 0; i < len; i++) payload[i] ^= packet[i];
+    if(len > parity_len) parity_len = len;
+    length_xor ^= len;
+
+    if(++protected_count == fec_group) sendParity();
+    return res;
+}
+
+void RtpFecSink::endFrame() {
+    // the last group of the frame is not held back until the next frame
+    if(protected_count) sendParity();
+}
+
+void RtpFecSink::sendParity() {
+    parity[0] = base_seq >> 8;
+    parity[1] = base_seq & 0xFF;
+    parity[2] = protected_count;
+    parity[3] = 0;
+    parity[4] = length_xor >> 8;
+    parity[5] = length_xor & 0xFF;
+    parity[6] = 0;
+    parity[7] = 0;
+
+    if(fec.sendPacket(parity, MULTICAST_FEC_HEADER_SIZE + parity_len)) parity_packets++;
+    protected_count = 0;
+}
+
+void RtpFecSink::describe(char *buf, size_t len) {
+    media.describe(buf, len);
+}
+
+bool CLMulticast::begin() {
+    if(!mutex) mutex = xSemaphoreCreateMutex();
+    if(!mutex) return false;
+
+    if(isConfigured()) {
+        sink.begin(group, port, fec_group);
+        Log.info("Multicast group %s:%u, FEC every %u packets%s", group.toString().c_str(), port, fec_group,
+                 (always_on?", always on":""));
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        updateStream();
+        xSemaphoreGive(mutex);
+    }
+    return true;
+}
+
+void CLMulticast::setConfig(const char *group, int port, int fec_group, bool always_on) {
+    IPAddress ip;
+    if(!ip.fromString(group) || ip[0] < 224 || ip[0] > 239) {
+        Log.warn("Multicast group %s is not valid", group);
+        return;
+    }
+    this->group = ip;
+    if(port > 0 && port < 0xFFFF - MULTICAST_FEC_PORT_OFFSET) this->port = port;
+    this->fec_group = constrain(fec_group, 0, MULTICAST_MAX_FEC);
+    this->always_on = always_on;
+}
+
+int CLMulticast::join(IPAddress viewer) {
+    if(!mutex || !isConfigured()) return OS_FAIL;
+
+    int res = OS_FAIL;
+    uint32_t ip = (uint32_t)viewer;
+    unsigned long expires = millis() + MULTICAST_LEASE * 1000UL;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for(int i = 0; i < viewers; i++)
+        if(leases[i].ip == ip) {
+            leases[i].expires = expires;
+            res = OS_SUCCESS;
+            break;
+        }
+    if(res != OS_SUCCESS && viewers < MULTICAST_MAX_VIEWERS) {
+        leases[viewers++] = {ip, expires};
+        res = OS_SUCCESS;
+        Log.info("Multicast viewer %s joined", viewer.toString().c_str());
+    }
+    updateStream();
+    xSemaphoreGive(mutex);
+    return res;
+}
+
+void CLMulticast::leave(IPAddress viewer) {
+    if(!mutex) return;
+
+    uint32_t ip = (uint32_t)viewer;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for(int i = 0; i < viewers; i++)
+        if(leases[i].ip == ip) {
+            leases[i] = leases[--viewers];
+            Log.info("Multicast viewer %s left", viewer.toString().c_str());
+            break;
+        }
+    updateStream();
+    xSemaphoreGive(mutex);
+}
+
+void CLMulticast::expireLeases() {
+    if(!mutex || !viewers) return;
+
+    unsigned long now = millis();
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for(int i = 0; i < viewers; )
+        if((long)(now - leases[i].expires) >= 0)
+            leases[i] = leases[--viewers];
+        else
+            i++;
+    updateStream();
+    xSemaphoreGive(mutex);
+}
+
+void CLMulticast::updateStream() {
+    bool wanted = isConfigured() && (always_on || viewers > 0);
+    if(wanted == streaming) return;
+
+    if(wanted) {
+        if(RtpStreamer.addSink(&sink) != OS_SUCCESS) {
+            Log.warn("RTP streams exhausted, multicast not started");
+            return;
+        }
+        AppHttpd.startCapture();
+        Log.info("Multicast stream started");
+    }
+    else {
+        RtpStreamer.removeSink(&sink);
+        AppHttpd.stopCapture();
+        Log.info("Multicast stream stopped");
+    }
+    streaming = wanted;
+}
+
+int CLMulticast::printSDP(char *buf, size_t len) {
+    return snprintf(buf, len,
+                    "v=0\r\n"
+                    "o=- 0 0 IN IP4 %s\r\n"
+                    "s=%s\r\n"
+                    "c=IN IP4 %s/1\r\n"
+                    "t=0 0\r\n"
+                    "m=video %u RTP/AVP %d\r\n"
+                    "a=rtpmap:%d JPEG/%d\r\n"
+                    "a=framerate:%d\r\n",
+                    WiFi.localIP().toString().c_str(), AppHttpd.getName(), group.toString().c_str(),
+                    port, RTP_PAYLOAD_JPEG, RTP_PAYLOAD_JPEG, RTP_CLOCK_RATE, AppCam.getFrameRate());
+}
+
+void CLMulticast::dumpToJson(JsonObject json) {
+    json["group"] = group.toString();
+    json["port"] = port;
+    json["fec_port"] = (fec_group?port + MULTICAST_FEC_PORT_OFFSET:0);
+    json["fec_group"] = fec_group;
+    json["sdp"] = "/stream.sdp";
+    json["lease"] = MULTICAST_LEASE;
+    json["always_on"] = always_on;
+    json["streaming"] = streaming;
+    json["viewers"] = viewers;
+    json["parity_packets"] = sink.getParityPackets();
+}
+
+void CLMulticast::dumpPrefsToJson(JsonObject json) {
+    json["group"] = group.toString();
+    json["port"] = port;
+    json["fec"] = fec_group;
+    json["always_on"] = always_on;
+}
+
+CLMulticast Multicast;
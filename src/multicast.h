@@ -0,0 +1,97 @@
+#ifndef multicast_h
+#define multicast_h
+
+#include <Arduino.h>
+#include <freertos/semphr.h>
+#include <ArduinoJson.h>
+#include "rtp.h"
+
+#define MULTICAST_DEFAULT_PORT      5004
+#define MULTICAST_DEFAULT_FEC       8       // media packets per parity packet, 0 = no FEC
+#define MULTICAST_MAX_FEC           32
+#define MULTICAST_FEC_PORT_OFFSET   2       // the parity packets go to port + 2
+#define MULTICAST_FEC_HEADER_SIZE   8
+#define MULTICAST_MAX_VIEWERS       32
+#define MULTICAST_LEASE             60      // seconds a join is valid without renewal
+
+/**
+ * @brief Sends the RTP packets to a multicast group, followed by an XOR parity packet for each group of
+ * packets on a separate port. A receiver can restore one lost packet per group from the parity packet.
+ *
+ * Parity packet: base sequence number (2 bytes), number of protected packets (1), reserved (1),
+ * XOR of the packet lengths (2), reserved (2), XOR of the protected RTP packets padded with zeros.
+ *
+ */
+class RtpFecSink : public RtpSink {
+    public:
+        void begin(IPAddress group, uint16_t port, uint8_t fec_group);
+
+        bool sendPacket(const uint8_t *packet, size_t len);
+        void endFrame();
+        void describe(char *buf, size_t len);
+
+        uint32_t getParityPackets() {return parity_packets;};
+
+    private:
+        void sendParity();
+
+        RtpUdpSink media;
+        RtpUdpSink fec;
+        uint8_t fec_group = 0;
+
+        uint8_t parity[MULTICAST_FEC_HEADER_SIZE + RTP_MAX_PACKET];
+        size_t parity_len = 0;
+        uint16_t length_xor = 0;
+        uint16_t base_seq = 0;
+        uint8_t protected_count = 0;
+        uint32_t parity_packets = 0;
+};
+
+/**
+ * @brief Multicast video for any number of viewers on the local network
+ * Each frame is sent once to the multicast group, so the radio load does not depend on the number of
+ * viewers. The group is advertised in /info and described by /stream.sdp. The stream either runs
+ * permanently (always_on) or while at least one viewer holds a lease, which is taken and renewed with
+ * /control?var=mc_join.
+ *
+ */
+class CLMulticast {
+    public:
+        bool begin();
+
+        void setConfig(const char *group, int port, int fec_group, bool always_on);
+        bool isConfigured() {return group != IPAddress();};
+
+        /// @brief takes or renews the lease of the viewer
+        int join(IPAddress viewer);
+        void leave(IPAddress viewer);
+        /// @brief drops the expired leases; stops the stream when the last one is gone
+        void expireLeases();
+
+        int printSDP(char *buf, size_t len);
+
+        /// @brief reports the configuration for the viewers (/info)
+        void dumpToJson(JsonObject json);
+        /// @brief adds the configuration for the prefs file
+        void dumpPrefsToJson(JsonObject json);
+
+    private:
+        void updateStream();
+
+        struct Lease {uint32_t ip; unsigned long expires;};
+
+        IPAddress group;
+        uint16_t port = MULTICAST_DEFAULT_PORT;
+        uint8_t fec_group = MULTICAST_DEFAULT_FEC;
+        bool always_on = false;
+
+        RtpFecSink sink;
+        bool streaming = false;
+        Lease leases[MULTICAST_MAX_VIEWERS];
+        int viewers = 0;
+        SemaphoreHandle_t mutex = NULL;
+};
+
+extern CLMulticast Multicast;
+
+#endif
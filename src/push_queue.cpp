@@ -0,0 +1,122 @@
+#include "push_queue.h"
+#include <time.h>
+
+int PushQueue::begin(int count, size_t size) {
+    slot_size = size;
+    for(this->count = 0; this->count < min(count, PUSH_MAX_SLOTS); this->count++) {
+        PushSlot &slot = slots[this->count];
+        slot.buf = (uint8_t*)(psramFound()?ps_malloc(size):malloc(size));
+        if(!slot.buf) break;
+        slot.frame = nullptr;
+        slot.state = SLOT_FREE;
+    }
+    return this->count;
+}
+
+int PushQueue::push(const uint8_t *buf, size_t len, SharedFrame *frame) {
+    if(!frame && len > slot_size) {
+        oversize++;
+        return OS_FAIL;
+    }
+
+    int slot = -1, oldest = -1;
+    portENTER_CRITICAL(&mux);
+    for(int i = 0; i < count; i++) {
+        if(slots[i].state == SLOT_FREE) {
+            slot = i;
+            break;
+        }
+        if(slots[i].state == SLOT_QUEUED && (oldest < 0 || (int32_t)(slots[i].seq - slots[oldest].seq) < 0))
+            oldest = i;
+    }
+    // the queue is full; the oldest frame makes room
+    if(slot < 0 && oldest >= 0) {
+        slot = oldest;
+        dropped++;
+    }
+    SharedFrame *dropped_frame = nullptr;
+    if(slot >= 0) {
+        slots[slot].state = SLOT_FILLING;
+        dropped_frame = slots[slot].frame;
+        slots[slot].frame = nullptr;
+    }
+    portEXIT_CRITICAL(&mux);
+    if(dropped_frame) dropped_frame->release();
+
+    if(slot < 0) {
+        dropped++;
+        return OS_FAIL;
+    }
+
+    if(frame) frame->retain();
+    else memcpy(slots[slot].buf, buf, len);
+    time_t now = time(nullptr);
+    // before the first NTP sync the clock starts at 1970
+    uint32_t capture_time = (now > 1600000000?(uint32_t)now:0);
+
+    portENTER_CRITICAL(&mux);
+    slots[slot].data = (frame?frame->getBuffer():slots[slot].buf);
+    slots[slot].frame = frame;
+    slots[slot].len = len;
+    slots[slot].seq = next_seq++;
+    slots[slot].time = capture_time;
+    slots[slot].state = SLOT_QUEUED;
+    portEXIT_CRITICAL(&mux);
+    return OS_SUCCESS;
+}
+
+int PushQueue::take() {
+    int slot = -1;
+    portENTER_CRITICAL(&mux);
+    for(int i = 0; i < count; i++)
+        if(slots[i].state == SLOT_QUEUED && (slot < 0 || (int32_t)(slots[i].seq - slots[slot].seq) < 0))
+            slot = i;
+    if(slot >= 0) slots[slot].state = SLOT_SENDING;
+    portEXIT_CRITICAL(&mux);
+    return slot;
+}
+
+void PushQueue::release(int slot, bool requeue) {
+    SharedFrame *frame = nullptr;
+    portENTER_CRITICAL(&mux);
+    slots[slot].state = (requeue?SLOT_QUEUED:SLOT_FREE);
+    if(!requeue) {
+        frame = slots[slot].frame;
+        slots[slot].frame = nullptr;
+    }
+    portEXIT_CRITICAL(&mux);
+    // the shared frame is freed by its last consumer, outside of the lock
+    if(frame) frame->release();
+}
+
+void PushQueue::reset() {
+    for(int i = 0; i < count; i++) {
+        SharedFrame *frame = nullptr;
+        portENTER_CRITICAL(&mux);
+        if(slots[i].state == SLOT_QUEUED) {
+            slots[i].state = SLOT_FREE;
+            frame = slots[i].frame;
+            slots[i].frame = nullptr;
+        }
+        portEXIT_CRITICAL(&mux);
+        if(frame) frame->release();
+    }
+}
+
+int PushQueue::getQueued() {
+    int queued = 0;
+    portENTER_CRITICAL(&mux);
+    for(int i = 0; i < count; i++)
+        if(slots[i].state == SLOT_QUEUED) queued++;
+    portEXIT_CRITICAL(&mux);
+    return queued;
+}
+
+size_t formatStreamHead(char *buf, size_t size, size_t frame_len) {
+    char part[112];
+    int part_len = snprintf(part, sizeof(part), "--" PUSH_BOUNDARY "\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n",
+                            (unsigned)frame_len);
+    // the chunk holds the part header, the frame and the "\r\n" ending the part
+    int len = snprintf(buf, size, "%X\r\n%s", (unsigned)(part_len + frame_len + 2), part);
+    return (len > 0 && (size_t)len < size?len:0);
+}
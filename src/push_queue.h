@@ -0,0 +1,73 @@
+#ifndef push_queue_h
+#define push_queue_h
+
+#include <Arduino.h>
+#include "json_parser.h"
+#include "shared_frame.h"
+
+#define PUSH_MAX_SLOTS          8
+#define PUSH_BOUNDARY           "esp32camframe"
+#define PUSH_STREAM_HEAD_SIZE   140         // chunk size line and part header of a frame of the stream
+
+enum PushSlotStateEnum {SLOT_FREE, SLOT_FILLING, SLOT_QUEUED, SLOT_SENDING};
+
+/**
+ * @brief Frame copied from the capture loop, waiting to be uploaded
+ *
+ */
+struct PushSlot {
+    uint8_t *buf;
+    const uint8_t *data;        // buf, or the buffer of the shared frame
+    SharedFrame *frame;         // still shared with other consumers, kept without a copy
+    size_t len;
+    uint32_t seq;               // queue order
+    uint32_t time;              // capture time, seconds since the epoch (0 if the clock was not set)
+    PushSlotStateEnum state;
+};
+
+/**
+ * @brief Bounded queue of the frames waiting for the push publisher
+ * The frames are copied into preallocated slots, or kept by reference if they are shared. When the queue
+ * is full the oldest frame makes room. Filled from the capture loop, emptied by the publisher task.
+ *
+ */
+class PushQueue {
+    public:
+        /// @brief allocates the slots
+        /// @return number of slots allocated
+        int begin(int count, size_t size);
+
+        /// @brief copies the frame into a free slot, or keeps a reference if it is shared
+        /// @return OS_SUCCESS, or OS_FAIL if the frame does not fit or all the slots are being filled or sent
+        int push(const uint8_t *buf, size_t len, SharedFrame *frame = nullptr);
+        /// @brief marks the oldest queued frame as being sent
+        /// @return its slot, -1 if the queue is empty
+        int take();
+        /// @brief frees the slot taken, or queues it again if the frame could not be sent
+        void release(int slot, bool requeue = false);
+        /// @brief drops all the queued frames
+        void reset();
+
+        PushSlot &getSlot(int slot) {return slots[slot];};
+        int getCount() {return count;};
+        int getQueued();
+        uint32_t getDropped() {return dropped;};
+        uint32_t getOversize() {return oversize;};
+
+    private:
+        PushSlot slots[PUSH_MAX_SLOTS];
+        int count = 0;
+        size_t slot_size = 0;
+        uint32_t next_seq = 0;
+        portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+        uint32_t dropped = 0;
+        uint32_t oversize = 0;
+};
+
+/// @brief formats the chunk size line and the part header of a frame of the multipart stream.
+/// They are followed by the frame, and "\r\n\r\n" which ends the part and the chunk.
+/// @return length of the head, 0 if it does not fit
+size_t formatStreamHead(char *buf, size_t size, size_t frame_len);
+
+#endif
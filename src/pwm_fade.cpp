@@ -0,0 +1,188 @@
+#include "pwm_fade.h"
+#include "app_httpd.h"
+
+static void onStrobeTimer(void *arg) {
+    PwmFader.onStrobeTimeout();
+}
+
+bool CLPwmFader::begin() {
+    if(task) return true;
+
+    setGamma(gamma);
+
+    // the Arduino core sets the LEDC channels up without the fade service
+    esp_err_t err = ledc_fade_func_install(0);
+    if(err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        Log.error("Failed to install the LEDC fade service (0x%x)", err);
+        return false;
+    }
+
+    esp_timer_create_args_t args = {};
+    args.callback = onStrobeTimer;
+    args.name = "strobe";
+    if(esp_timer_create(&args, &strobe_timer) != ESP_OK)
+        return false;
+
+    return xTaskCreate(pwmFaderTask, "PwmFader", PWM_FADE_TASK_STACK_SIZE, NULL, PWM_FADE_TASK_PRIORITY, &task) == pdPASS;
+}
+
+void CLPwmFader::setGamma(float val) {
+    if(val < 1.0 || val > 4.0) val = PWM_FADE_DEFAULT_GAMMA;
+    gamma = val;
+    for(int i = 0; i < PWM_FADE_LUT_SIZE; i++)
+        lut[i] = round(pow(i / (float)(PWM_FADE_LUT_SIZE - 1), gamma) * 65535);
+}
+
+uint32_t CLPwmFader::percentToDuty(int percent, uint32_t max_duty) {
+    percent = constrain(percent, 0, PWM_FADE_LUT_SIZE - 1);
+    uint32_t duty = ((uint64_t)lut[percent] * max_duty + 32767) / 65535;
+    // the lowest steps would round to off
+    if(percent > 0 && duty == 0) duty = 1;
+    return duty;
+}
+
+void CLPwmFader::setFadeTime(uint8_t pin, int time) {
+    if(pin < SOC_GPIO_PIN_COUNT)
+        fade_time[pin] = constrain(time, 0, PWM_FADE_MAX_TIME);
+}
+
+void CLPwmFader::request(int channel, uint32_t duty, int time) {
+    portENTER_CRITICAL(&mux);
+    FadeChannel &ch = channels[channel];
+    if(ch.pending) replaced++;
+    ch.target = duty;
+    ch.time = time;
+    ch.pending = true;
+    portEXIT_CRITICAL(&mux);
+    xTaskNotifyGive(task);
+}
+
+int CLPwmFader::fadeTo(ESP32PWM *pwm, uint32_t duty, int time) {
+    if(!task || !pwm || !pwm->attached()) return OS_FAIL;
+    // the ESP32PWM keeps the level, e.g. for a change of frequency
+    pwm->trackDuty(duty);
+    request(pwm->getChannel(), duty, constrain(time, 0, PWM_FADE_MAX_TIME));
+    return OS_SUCCESS;
+}
+
+int CLPwmFader::strobe(ESP32PWM *pwm, uint32_t duty, uint32_t rest_duty, int max_time) {
+    if(!task || !pwm || !pwm->attached()) return OS_FAIL;
+
+    esp_timer_stop(strobe_timer);
+    portENTER_CRITICAL(&mux);
+    strobe_rest = rest_duty;
+    strobe_start = esp_timer_get_time();
+    strobe_channel = pwm->getChannel();
+    portEXIT_CRITICAL(&mux);
+    strobes++;
+    // the flash is temporary, the level of the output stays the steady one
+    pwm->trackDuty(rest_duty);
+    request(pwm->getChannel(), duty, 0);
+    esp_timer_start_once(strobe_timer, (uint64_t)max_time * 1000);
+    return OS_SUCCESS;
+}
+
+void CLPwmFader::endStrobe() {
+    // the capture path and the strobe timer may both end it
+    portENTER_CRITICAL(&mux);
+    int channel = strobe_channel;
+    strobe_channel = -1;
+    portEXIT_CRITICAL(&mux);
+    if(channel < 0) return;
+
+    esp_timer_stop(strobe_timer);
+    strobe_us = esp_timer_get_time() - strobe_start;
+    request(channel, strobe_rest, 0);
+}
+
+void CLPwmFader::onStrobeTimeout() {
+    if(!isStrobing()) return;
+    strobe_timeouts++;
+    endStrobe();
+}
+
+void CLPwmFader::apply(int channel, uint32_t duty, int time) {
+    ledc_mode_t mode = (ledc_mode_t)(channel / 8);
+    ledc_channel_t ch = (ledc_channel_t)(channel % 8);
+    esp_err_t err;
+
+    if(time > 0) {
+        err = ledc_set_fade_with_time(mode, ch, duty, time);
+        if(err == ESP_OK) err = ledc_fade_start(mode, ch, LEDC_FADE_NO_WAIT);
+    }
+    else
+        err = ledc_set_duty_and_update(mode, ch, duty, 0);
+
+    if(err != ESP_OK)
+        Log.warn("LEDC fade on channel %d failed (0x%x)", channel, err);
+}
+
+void CLPwmFader::step(int channel, int64_t now) {
+    FadeChannel &ch = channels[channel];
+
+    // a request replaces the rest of the ramp once the running step has ended
+    portENTER_CRITICAL(&mux);
+    bool ready = ch.pending && ch.busy_until <= now;
+    uint32_t duty = ch.target;
+    int time = ch.time;
+    if(ready) ch.pending = false;
+    portEXIT_CRITICAL(&mux);
+
+    if(ready) {
+        fades++;
+        if(time == 0) {
+            ch.ramping = false;
+            apply(channel, duty, 0);
+            return;
+        }
+        ch.ramp_from = ledc_get_duty((ledc_mode_t)(channel / 8), (ledc_channel_t)(channel % 8));
+        ch.ramp_to = duty;
+        ch.ramp_start = now;
+        ch.ramp_end = now + time * 1000LL;
+        ch.ramping = true;
+    }
+    if(!ch.ramping || ch.busy_until > now) return;
+
+    // the next step, along the straight line from the start to the target of the ramp
+    int64_t step_end = min(now + PWM_FADE_STEP_TIME * 1000LL, ch.ramp_end);
+    int64_t delta = (int64_t)ch.ramp_to - ch.ramp_from;
+    uint32_t step_duty = ch.ramp_from + delta * (step_end - ch.ramp_start) / (ch.ramp_end - ch.ramp_start);
+    apply(channel, step_duty, (step_end - now) / 1000);
+    ch.busy_until = step_end;
+    if(step_end >= ch.ramp_end) ch.ramping = false;
+}
+
+void CLPwmFader::run() {
+    while(true) {
+        // sleep until a request comes, or until the next running step ends if a ramp or a request waits for it
+        int64_t now = esp_timer_get_time();
+        int64_t wake = 0;
+        portENTER_CRITICAL(&mux);
+        for(int i = 0; i < NUM_PWM; i++)
+            if((channels[i].pending || channels[i].ramping) && (!wake || channels[i].busy_until < wake))
+                wake = channels[i].busy_until;
+        portEXIT_CRITICAL(&mux);
+        if(!wake)
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        else if(wake > now)
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((wake - now) / 1000) + 1);
+
+        for(int i = 0; i < NUM_PWM; i++)
+            step(i, esp_timer_get_time());
+    }
+}
+
+void CLPwmFader::dumpToJson(JsonObject json) {
+    json["gamma"] = gamma;
+    json["fades"] = fades;
+    json["replaced"] = replaced;
+    json["strobes"] = strobes;
+    json["strobe_timeouts"] = strobe_timeouts;
+    json["strobe_ms"] = strobe_us / 1000.0;
+}
+
+void pwmFaderTask(void *pvParameters) {
+    PwmFader.run();
+}
+
+CLPwmFader PwmFader;
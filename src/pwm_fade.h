@@ -0,0 +1,108 @@
+#ifndef pwm_fade_h
+#define pwm_fade_h
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <driver/ledc.h>
+#include <ArduinoJson.h>
+#include <soc/soc_caps.h>
+#include "esp32pwm.h"
+
+#define PWM_FADE_DEFAULT_GAMMA      2.2     // perceived brightness of a LED is about duty^(1/2.2)
+#define PWM_FADE_LUT_SIZE           101     // one entry per percent of brightness
+#define PWM_FADE_MAX_TIME           10000   // ms
+#define PWM_FADE_STEP_TIME          20      // ms; a ramp is run in hardware fades of at most this length
+#define PWM_FADE_TASK_STACK_SIZE    2048
+#define PWM_FADE_TASK_PRIORITY      4
+#define LAMP_SETTLE_TIME            75      // ms between the lamp on and the capture of a still
+#define LAMP_STROBE_MAX_TIME        1000    // ms; the strobe ends by itself if the capture does not end it
+
+/**
+ * @brief Fade of one LEDC channel. A new target replaces the pending one, and the rest of the running ramp.
+ *
+ */
+struct FadeChannel {
+    uint32_t target;        // duty
+    uint16_t time;          // ms, 0 for an immediate change
+    bool pending;
+
+    // ramp in progress, only used by the task
+    bool ramping;
+    uint32_t ramp_from;
+    uint32_t ramp_to;
+    int64_t ramp_start;
+    int64_t ramp_end;
+    int64_t busy_until;     // end of the running hardware fade step
+};
+
+/**
+ * @brief Brightness and hardware fades of the dimmable PWM outputs
+ * Brightness in percent is mapped to the duty through a gamma corrected table, so the steps look even to
+ * the eye. The ramps between two levels are carried out by the LEDC fade hardware, in steps of
+ * PWM_FADE_STEP_TIME: a hardware fade can not be stopped or replaced while it runs, so a task starts the steps
+ * one after the other and, once a step has ended, takes the last request of the channel instead of the rest
+ * of the ramp. An immediate change, like the strobe, waits for one step at most, not for a whole ramp.
+ * The strobe switches the flash lamp on for a still image and back to its steady level as soon as the frame
+ * is captured, or after LAMP_STROBE_MAX_TIME at the latest.
+ *
+ */
+class CLPwmFader {
+    public:
+        bool begin();
+
+        void setGamma(float val);
+        float getGamma() {return gamma;};
+
+        /// @brief duty of the brightness in percent (0-100) through the gamma table
+        uint32_t percentToDuty(int percent, uint32_t max_duty);
+
+        /// @brief default fade time of the output on the pin, in ms
+        void setFadeTime(uint8_t pin, int time);
+        int getFadeTime(uint8_t pin) {return (pin < SOC_GPIO_PIN_COUNT?fade_time[pin]:0);};
+
+        /// @brief changes the duty of the output, in a ramp of the given time
+        /// @param time ms, 0 for an immediate change
+        /// @return OS_SUCCESS, or OS_FAIL if the fader is not running or the PWM is not attached
+        int fadeTo(ESP32PWM *pwm, uint32_t duty, int time);
+
+        /// @brief switches the output to the duty until endStrobe(), then back to rest_duty
+        int strobe(ESP32PWM *pwm, uint32_t duty, uint32_t rest_duty, int max_time = LAMP_STROBE_MAX_TIME);
+        void endStrobe();
+        bool isStrobing() {return strobe_channel >= 0;};
+
+        void dumpToJson(JsonObject json);
+
+        void run();
+        void onStrobeTimeout();
+
+    private:
+        void request(int channel, uint32_t duty, int time);
+        void apply(int channel, uint32_t duty, int time);
+        void step(int channel, int64_t now);
+
+        float gamma = PWM_FADE_DEFAULT_GAMMA;
+        uint16_t lut[PWM_FADE_LUT_SIZE];
+        uint16_t fade_time[SOC_GPIO_PIN_COUNT] = {};
+
+        FadeChannel channels[NUM_PWM] = {};
+        portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+        TaskHandle_t task = NULL;
+
+        volatile int strobe_channel = -1;
+        uint32_t strobe_rest = 0;
+        int64_t strobe_start = 0;
+        esp_timer_handle_t strobe_timer = NULL;
+
+        // statistics
+        uint32_t fades = 0;
+        uint32_t replaced = 0;
+        uint32_t strobes = 0;
+        uint32_t strobe_timeouts = 0;
+        uint32_t strobe_us = 0;             // duration of the last strobe
+};
+
+void pwmFaderTask(void *pvParameters);
+
+extern CLPwmFader PwmFader;
+
+#endif
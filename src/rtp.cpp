@@ -0,0 +1,176 @@
+#include "rtp.h"
+#include "logger.h"
+
+bool RtpUdpSink::begin(IPAddress ip, uint16_t port) {
+    this->ip = ip;
+    this->port = port;
+    return true;
+}
+
+bool RtpUdpSink::sendPacket(const uint8_t *packet, size_t len) {
+    if(!udp.beginPacket(ip, port)) return false;
+    udp.write(packet, len);
+    return udp.endPacket();
+}
+
+void RtpUdpSink::describe(char *buf, size_t len) {
+    snprintf(buf, len, "udp://%s:%u", ip.toString().c_str(), port);
+}
+
+bool CLRtpStreamer::begin() {
+    if(!mutex) mutex = xSemaphoreCreateMutex();
+    return mutex != NULL;
+}
+
+bool CLRtpStreamer::parseDestination(const char *dest, IPAddress &ip, uint16_t &port) {
+    const char *colon = strchr(dest, ':');
+    if(!colon || colon - dest >= 16) return false;
+
+    char addr[16];
+    memcpy(addr, dest, colon - dest);
+    addr[colon - dest] = '\0';
+
+    long val = atol(colon + 1);
+    if(!ip.fromString(addr) || val <= 0 || val > 0xFFFF) return false;
+    port = val;
+    return true;
+}
+
+int CLRtpStreamer::findFreeSlot() {
+    for(int i = 0; i < RTP_MAX_SINKS; i++)
+        if(!destinations[i].active) return i;
+    return -1;
+}
+
+int CLRtpStreamer::addDestination(const char *dest) {
+    IPAddress ip;
+    uint16_t port;
+    if(!mutex || !parseDestination(dest, ip, port)) return OS_FAIL;
+
+    int res = OS_FAIL;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for(int i = 0; i < RTP_MAX_SINKS; i++)
+        if(destinations[i].active && destinations[i].owned &&
+           destinations[i].udp.getIP() == ip && destinations[i].udp.getPort() == port) {
+            xSemaphoreGive(mutex);
+            return OS_FAIL;
+        }
+
+    int i = findFreeSlot();
+    if(i >= 0 && udp_count < RTP_MAX_DESTINATIONS) {
+        destinations[i].udp.begin(ip, port);
+        destinations[i].sink = &destinations[i].udp;
+        destinations[i].owned = true;
+        RtpJpeg::initSession(destinations[i].session);
+        destinations[i].active = true;
+        count++;
+        udp_count++;
+        res = OS_SUCCESS;
+    }
+    xSemaphoreGive(mutex);
+
+    if(res == OS_SUCCESS) Log.info("RTP stream to %s started", dest);
+    else Log.warn("RTP destinations exhausted, %s not added", dest);
+    return res;
+}
+
+int CLRtpStreamer::removeDestination(const char *dest) {
+    IPAddress ip;
+    uint16_t port = 0;
+    bool all = (strcmp(dest, "all") == 0);
+    if(!mutex || (!all && !parseDestination(dest, ip, port))) return 0;
+
+    int removed = 0;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for(int i = 0; i < RTP_MAX_SINKS; i++)
+        if(destinations[i].active && destinations[i].owned &&
+           (all || (destinations[i].udp.getIP() == ip && destinations[i].udp.getPort() == port))) {
+            destinations[i].udp.end();
+            destinations[i].active = false;
+            destinations[i].owned = false;
+            count--;
+            udp_count--;
+            removed++;
+        }
+    xSemaphoreGive(mutex);
+
+    if(removed) Log.info("RTP stream to %s stopped", dest);
+    return removed;
+}
+
+int CLRtpStreamer::addSink(RtpSink *sink) {
+    if(!mutex || !sink) return OS_FAIL;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int i = findFreeSlot();
+    if(i >= 0) {
+        destinations[i].sink = sink;
+        destinations[i].owned = false;
+        RtpJpeg::initSession(destinations[i].session);
+        destinations[i].active = true;
+        count++;
+    }
+    xSemaphoreGive(mutex);
+    return (i >= 0?OS_SUCCESS:OS_FAIL);
+}
+
+void CLRtpStreamer::removeSink(RtpSink *sink) {
+    if(!mutex || !sink) return;
+
+    // once the mutex is taken, the capture task is not using the sink anymore
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for(int i = 0; i < RTP_MAX_SINKS; i++)
+        if(destinations[i].active && !destinations[i].owned && destinations[i].sink == sink) {
+            destinations[i].active = false;
+            destinations[i].sink = nullptr;
+            count--;
+        }
+    xSemaphoreGive(mutex);
+}
+
+void CLRtpStreamer::sendFrame(const uint8_t *jpeg, size_t len, int64_t capture_us) {
+    if(!count || !mutex) return;
+
+    JpegFrameInfo info;
+    if(RtpJpeg::parse(jpeg, len, info) != OS_SUCCESS) {
+        rejected_frames++;
+        return;
+    }
+
+    uint32_t timestamp = RtpJpeg::timestamp(capture_us);
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for(int i = 0; i < RTP_MAX_SINKS; i++) {
+        Destination &d = destinations[i];
+        if(!d.active) continue;
+        if(!d.sink->beginFrame(info.scan_len)) {
+            d.session.dropped_frames++;
+            continue;
+        }
+        RtpJpeg::sendFrame(info, timestamp, d.session, *d.sink);
+        d.sink->endFrame();
+    }
+    xSemaphoreGive(mutex);
+    frames++;
+}
+
+void CLRtpStreamer::dumpToJson(JsonObject json) {
+    json["frames"] = frames;
+    json["rejected_frames"] = rejected_frames;
+    JsonArray dests = json["destinations"].to<JsonArray>();
+    if(!mutex) return;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for(int i = 0; i < RTP_MAX_SINKS; i++) {
+        if(!destinations[i].active) continue;
+        JsonObject d = dests.add<JsonObject>();
+        char addr[40];
+        destinations[i].sink->describe(addr, sizeof(addr));
+        d["dest"] = addr;
+        d["packets"] = destinations[i].session.packets;
+        d["errors"] = destinations[i].session.errors;
+        d["dropped_frames"] = destinations[i].session.dropped_frames;
+    }
+    xSemaphoreGive(mutex);
+}
+
+CLRtpStreamer RtpStreamer;
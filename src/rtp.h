@@ -0,0 +1,86 @@
+#ifndef rtp_h
+#define rtp_h
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include <freertos/semphr.h>
+#include <ArduinoJson.h>
+#include "rtp_jpeg.h"
+
+#if __has_include("../myconfig.h")
+#include "../myconfig.h"
+#else
+#include "app_config.h"
+#endif
+
+#define RTP_MAX_DESTINATIONS    4       // UDP destinations added with rtp_dest
+#define RTP_MAX_SINKS           8       // all streams, including the RTSP sessions
+
+/**
+ * @brief Sends the RTP packets to a UDP destination (unicast or multicast)
+ *
+ */
+class RtpUdpSink : public RtpSink {
+    public:
+        bool begin(IPAddress ip, uint16_t port);
+        void end() {udp.stop();};
+        bool sendPacket(const uint8_t *packet, size_t len);
+        void describe(char *buf, size_t len);
+
+        IPAddress getIP() {return ip;};
+        uint16_t getPort() {return port;};
+
+    private:
+        WiFiUDP udp;
+        IPAddress ip;
+        uint16_t port = 0;
+};
+
+/**
+ * @brief RTP/UDP streamer
+ * Sends each captured frame to the destinations added with /control?var=rtp_dest. The frames come from
+ * the same capture loop as the websocket stream.
+ *
+ */
+class CLRtpStreamer {
+    public:
+        bool begin();
+
+        /// @brief adds a destination
+        /// @param dest "ip:port"
+        int addDestination(const char *dest);
+        /// @brief removes the destination ("ip:port"), or all of them ("all")
+        /// @return number of destinations removed
+        int removeDestination(const char *dest);
+
+        /// @brief adds a sink owned by the caller (e.g. an RTSP session); it must be removed before it is destroyed
+        int addSink(RtpSink *sink);
+        void removeSink(RtpSink *sink);
+
+        /// @return number of active streams, UDP destinations and other sinks
+        int getDestinationCount() {return count;};
+
+        /// @brief sends the frame to all destinations; called from the capture task
+        void sendFrame(const uint8_t *jpeg, size_t len, int64_t capture_us);
+
+        void dumpToJson(JsonObject json);
+
+    private:
+        static bool parseDestination(const char *dest, IPAddress &ip, uint16_t &port);
+
+        // the UDP destinations use the embedded sink, the other streams point to their own
+        struct Destination {RtpUdpSink udp; RtpSink *sink = nullptr; RtpSession session; bool active = false; bool owned = false;};
+
+        int findFreeSlot();
+
+        Destination destinations[RTP_MAX_SINKS];
+        int count = 0;
+        int udp_count = 0;
+        uint32_t frames = 0;
+        uint32_t rejected_frames = 0;
+        SemaphoreHandle_t mutex = NULL;
+};
+
+extern CLRtpStreamer RtpStreamer;
+
+#endif
@@ -0,0 +1,153 @@
+#include <string.h>
+#include <algorithm>
+#include <esp_system.h>
+#include "rtp_jpeg.h"
+
+#define JPEG_MARKER_SOI     0xD8
+#define JPEG_MARKER_EOI     0xD9
+#define JPEG_MARKER_SOF0    0xC0
+#define JPEG_MARKER_DQT     0xDB
+#define JPEG_MARKER_DRI     0xDD
+#define JPEG_MARKER_SOS     0xDA
+
+#define JPEG_TABLE_SIZE     64
+#define RTP_MAX_DIMENSION   2040        // width and height are sent in 8 pixel units in one byte
+
+uint8_t RtpJpeg::packet[RTP_MAX_PACKET];
+
+int RtpJpeg::parse(const uint8_t *jpeg, size_t len, JpegFrameInfo &info) {
+    memset(&info, 0, sizeof(info));
+
+    if(len < 4 || jpeg[0] != 0xFF || jpeg[1] != JPEG_MARKER_SOI) return OS_FAIL;
+
+    bool have_sof = false;
+    size_t pos = 2;
+    while(pos + 4 <= len) {
+        if(jpeg[pos] != 0xFF) return OS_FAIL;
+        uint8_t marker = jpeg[pos+1];
+        if(marker == 0xFF) {    // fill byte
+            pos++;
+            continue;
+        }
+        size_t seg_len = (jpeg[pos+2] << 8) | jpeg[pos+3];
+        const uint8_t *seg = jpeg + pos + 4;
+        if(seg_len < 2 || pos + 2 + seg_len > len) return OS_FAIL;
+        seg_len -= 2;
+
+        switch(marker) {
+            case JPEG_MARKER_DQT:
+                for(size_t i = 0; i + 1 + JPEG_TABLE_SIZE <= seg_len; i += 1 + JPEG_TABLE_SIZE) {
+                    // only 8 bit tables 0 and 1 can be sent with Q = 255
+                    if((seg[i] >> 4) != 0 || (seg[i] & 0x0F) > 1) return OS_FAIL;
+                    info.qtables[seg[i] & 0x0F] = seg + i + 1;
+                }
+                break;
+
+            case JPEG_MARKER_SOF0:
+                if(seg_len < 15 || seg[5] != 3) return OS_FAIL;
+                info.height = (seg[1] << 8) | seg[2];
+                info.width = (seg[3] << 8) | seg[4];
+                // Y, Cb, Cr; the chroma components are not subsampled and share table 1
+                if(seg[10] != 0x11 || seg[13] != 0x11 || seg[8] != 0 || seg[11] != 1 || seg[14] != 1)
+                    return OS_FAIL;
+                if(seg[7] == 0x21) info.type = 0;
+                else if(seg[7] == 0x22) info.type = 1;
+                else return OS_FAIL;
+                have_sof = true;
+                break;
+
+            case JPEG_MARKER_DRI:
+                // restart markers would need the types 64-127
+                return OS_FAIL;
+
+            case JPEG_MARKER_SOS:
+                if(!have_sof || !info.qtables[0] || !info.qtables[1]) return OS_FAIL;
+                if(info.width == 0 || info.height == 0 ||
+                   info.width > RTP_MAX_DIMENSION || info.height > RTP_MAX_DIMENSION) return OS_FAIL;
+
+                info.scan = seg + seg_len;
+                info.scan_len = jpeg + len - info.scan;
+                // the receiver adds the EOI marker itself
+                if(info.scan_len >= 2 && info.scan[info.scan_len-2] == 0xFF && info.scan[info.scan_len-1] == JPEG_MARKER_EOI)
+                    info.scan_len -= 2;
+                return (info.scan_len > 0?OS_SUCCESS:OS_FAIL);
+
+            default:
+                // APPn, COM and the Huffman tables are not carried; the standard tables are assumed
+                break;
+        }
+        pos += 4 + seg_len;
+    }
+    return OS_FAIL;
+}
+
+void RtpJpeg::initSession(RtpSession &session) {
+    session.seq = esp_random() & 0xFFFF;
+    session.ssrc = esp_random();
+    session.packets = 0;
+    session.errors = 0;
+    session.dropped_frames = 0;
+}
+
+int RtpJpeg::sendFrame(const JpegFrameInfo &info, uint32_t timestamp, RtpSession &session, RtpSink &sink) {
+    int sent = 0;
+    size_t offset = 0;
+
+    while(offset < info.scan_len) {
+        uint8_t *p = packet;
+
+        // RTP header (RFC 3550), the marker bit is set below for the last packet
+        *p++ = 0x80;
+        *p++ = RTP_PAYLOAD_JPEG;
+        *p++ = session.seq >> 8;
+        *p++ = session.seq & 0xFF;
+        *p++ = timestamp >> 24;
+        *p++ = (timestamp >> 16) & 0xFF;
+        *p++ = (timestamp >> 8) & 0xFF;
+        *p++ = timestamp & 0xFF;
+        *p++ = session.ssrc >> 24;
+        *p++ = (session.ssrc >> 16) & 0xFF;
+        *p++ = (session.ssrc >> 8) & 0xFF;
+        *p++ = session.ssrc & 0xFF;
+
+        // JPEG header (RFC 2435, 3.1)
+        *p++ = 0;                           // type specific
+        *p++ = (offset >> 16) & 0xFF;
+        *p++ = (offset >> 8) & 0xFF;
+        *p++ = offset & 0xFF;
+        *p++ = info.type;
+        *p++ = 255;                         // Q: the tables follow in-band
+        *p++ = info.width / 8;
+        *p++ = info.height / 8;
+
+        // the quantization tables are sent with the first fragment only
+        if(offset == 0) {
+            *p++ = 0;                       // MBZ
+            *p++ = 0;                       // precision: 8 bit tables
+            *p++ = 0;
+            *p++ = 2 * JPEG_TABLE_SIZE;     // length
+            memcpy(p, info.qtables[0], JPEG_TABLE_SIZE);
+            p += JPEG_TABLE_SIZE;
+            memcpy(p, info.qtables[1], JPEG_TABLE_SIZE);
+            p += JPEG_TABLE_SIZE;
+        }
+
+        size_t chunk = std::min((size_t)(packet + RTP_MAX_PACKET - p), info.scan_len - offset);
+        memcpy(p, info.scan + offset, chunk);
+        p += chunk;
+        offset += chunk;
+
+        if(offset == info.scan_len) packet[1] |= 0x80;     // marker: last packet of the frame
+
+        if(sink.sendPacket(packet, p - packet)) {
+            session.packets++;
+            sent++;
+        }
+        else
+            session.errors++;
+
+        // a lost packet still consumes its sequence number, so the receiver drops the frame
+        session.seq++;
+    }
+    return sent;
+}
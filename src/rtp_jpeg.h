@@ -0,0 +1,85 @@
+#ifndef rtp_jpeg_h
+#define rtp_jpeg_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "json_parser.h"
+
+#define RTP_MAX_PACKET          1400    // bytes, RTP header included; stays below the WiFi MTU
+#define RTP_HEADER_SIZE         12
+#define RTP_JPEG_HEADER_SIZE    8
+#define RTP_QUANT_HEADER_SIZE   4
+#define RTP_PAYLOAD_JPEG        26
+#define RTP_CLOCK_RATE          90000
+
+/**
+ * @brief JPEG frame parsed for the RTP/JPEG payload format (RFC 2435). Only points into the frame buffer.
+ *
+ */
+struct JpegFrameInfo {
+    uint8_t type;                   // 0 = 4:2:2, 1 = 4:2:0
+    uint16_t width;
+    uint16_t height;
+    const uint8_t *qtables[2];      // luma and chroma quantization tables, 64 bytes each
+    const uint8_t *scan;            // entropy coded data, without the EOI marker
+    size_t scan_len;
+};
+
+/**
+ * @brief State of one RTP stream: sequence numbers and SSRC are per destination.
+ *
+ */
+struct RtpSession {
+    uint16_t seq;
+    uint32_t ssrc;
+    uint32_t packets;
+    uint32_t errors;
+    uint32_t dropped_frames;
+};
+
+/**
+ * @brief Receives the packets of the RTP streams (e.g. UDP socket, interleaved RTSP connection)
+ *
+ */
+class RtpSink {
+    public:
+        virtual ~RtpSink() {};
+        /// @brief called before the packets of a frame are sent
+        /// @param len size of the JPEG scan data
+        /// @return false if the sink cannot take the frame now; the frame is skipped
+        virtual bool beginFrame(size_t len) {return true;};
+        /// @return true if the packet has been sent or queued
+        virtual bool sendPacket(const uint8_t *packet, size_t len) = 0;
+        /// @brief called after the last packet of a frame
+        virtual void endFrame() {};
+        /// @brief formats the destination for the status reports
+        virtual void describe(char *buf, size_t len) = 0;
+};
+
+/**
+ * @brief RTP/JPEG packetizer (RFC 2435). The quantization tables are sent in-band (Q = 255), so
+ * the receivers do not need to know the quality setting of the camera. The packets are built in a
+ * static buffer, so the packetizer must only be used from the capture task.
+ *
+ */
+class RtpJpeg {
+    public:
+        /// @brief extracts the image parameters, the tables and the scan data from the JPEG frame
+        /// @return OS_SUCCESS, or OS_FAIL if the frame cannot be carried by RFC 2435
+        static int parse(const uint8_t *jpeg, size_t len, JpegFrameInfo &info);
+
+        /// @brief sends the frame as a sequence of RTP packets, the last one with the marker bit set
+        /// @param timestamp capture time in 90 kHz units
+        /// @return number of packets sent
+        static int sendFrame(const JpegFrameInfo &info, uint32_t timestamp, RtpSession &session, RtpSink &sink);
+
+        /// @brief converts the capture time to the RTP clock
+        static uint32_t timestamp(int64_t us) {return (uint32_t)(us * 9 / 100);};
+
+        static void initSession(RtpSession &session);
+
+    private:
+        static uint8_t packet[RTP_MAX_PACKET];
+};
+
+#endif
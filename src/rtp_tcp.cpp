@@ -0,0 +1,107 @@
+#include "rtp_tcp.h"
+
+RtpTcpSink::RtpTcpSink(AsyncClient *client, uint8_t channel) {
+    this->client = client;
+    this->channel = channel;
+    capacity = (psramFound()?RTSP_TCP_BUFFER_SIZE:RTSP_TCP_BUFFER_SIZE_NO_PSRAM);
+    buffer = (uint8_t*)(psramFound()?ps_malloc(capacity):malloc(capacity));
+    mutex = xSemaphoreCreateMutex();
+}
+
+RtpTcpSink::~RtpTcpSink() {
+    if(buffer) free(buffer);
+    if(mutex) vSemaphoreDelete(mutex);
+}
+
+bool RtpTcpSink::beginFrame(size_t frame_len) {
+    // worst case: interleaved and RTP/JPEG headers in each packet, plus the quantization tables
+    size_t packets = frame_len / (RTP_MAX_PACKET - RTP_HEADER_SIZE - RTP_JPEG_HEADER_SIZE) + 2;
+    size_t needed = frame_len + packets * (RTSP_INTERLEAVED_HEADER + RTP_HEADER_SIZE + RTP_JPEG_HEADER_SIZE) +
+                    RTP_QUANT_HEADER_SIZE + 128;
+    if(needed > capacity) return false;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    bool idle = (sent == len);
+    xSemaphoreGive(mutex);
+    if(!idle) return false;
+
+    fill = 0;
+    return true;
+}
+
+bool RtpTcpSink::sendPacket(const uint8_t *packet, size_t packet_len) {
+    if(fill + RTSP_INTERLEAVED_HEADER + packet_len > capacity) return false;
+
+    buffer[fill++] = '$';
+    buffer[fill++] = channel;
+    buffer[fill++] = packet_len >> 8;
+    buffer[fill++] = packet_len & 0xFF;
+    memcpy(buffer + fill, packet, packet_len);
+    fill += packet_len;
+    return true;
+}
+
+void RtpTcpSink::endFrame() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    len = fill;
+    sent = 0;
+    packet_end = 0;
+    if(!reply_len) last_progress = millis();
+    xSemaphoreGive(mutex);
+    drain();
+}
+
+bool RtpTcpSink::queueReply(const char *data, size_t data_len) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    bool fits = (reply_len + data_len <= sizeof(replies));
+    if(fits) {
+        if(!reply_len && sent == len) last_progress = millis();
+        memcpy(replies + reply_len, data, data_len);
+        reply_len += data_len;
+    }
+    xSemaphoreGive(mutex);
+
+    if(fits) drain();
+    return fits;
+}
+
+void RtpTcpSink::drain() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    bool added = false;
+    while(client->connected()) {
+        size_t space = client->space();
+        if(!space) break;
+
+        size_t n;
+        if(sent == packet_end && reply_len) {
+            // between two packets: the responses go first
+            n = client->add(replies + reply_sent, min(space, reply_len - reply_sent), ASYNC_WRITEFLAG_COPY);
+            reply_sent += n;
+            if(reply_sent == reply_len) reply_len = reply_sent = 0;
+        }
+        else if(sent < len) {
+            if(sent == packet_end) packet_end = sent + RTSP_INTERLEAVED_HEADER + ((buffer[sent+2] << 8) | buffer[sent+3]);
+            n = client->add((const char*)buffer + sent, min(space, packet_end - sent), ASYNC_WRITEFLAG_COPY);
+            sent += n;
+        }
+        else
+            break;
+
+        if(!n) break;
+        added = true;
+        last_progress = millis();
+    }
+    if(added) client->send();
+    xSemaphoreGive(mutex);
+}
+
+unsigned long RtpTcpSink::getStallTime() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    unsigned long stall = (sent < len || reply_len?millis() - last_progress:0);
+    xSemaphoreGive(mutex);
+    return stall;
+}
+
+void RtpTcpSink::describe(char *buf, size_t buf_len) {
+    snprintf(buf, buf_len, "rtsp-tcp://%s:%u", client->remoteIP().toString().c_str(), client->remotePort());
+}
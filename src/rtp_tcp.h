@@ -0,0 +1,65 @@
+#ifndef rtp_tcp_h
+#define rtp_tcp_h
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include <freertos/semphr.h>
+#include "rtp_jpeg.h"
+
+#define RTSP_INTERLEAVED_HEADER     4
+#define RTSP_MAX_RESPONSE           1024
+#define RTSP_REPLY_BUFFER_SIZE      (2*RTSP_MAX_RESPONSE)   // responses waiting for the end of an interleaved packet
+#define RTSP_TCP_BUFFER_SIZE        (96*1024)   // interleaved frame waiting for the TCP window (PSRAM)
+#define RTSP_TCP_BUFFER_SIZE_NO_PSRAM   (24*1024)
+
+/**
+ * @brief Sends the RTP packets interleaved in the RTSP connection (RFC 2326, 10.12). One frame is buffered and
+ * drained as the TCP window opens; while it is being sent, the next frames are skipped.
+ * The RTSP responses share the connection, so they are queued here too and sent between two packets,
+ * never inside one.
+ *
+ */
+class RtpTcpSink : public RtpSink {
+    public:
+        RtpTcpSink(AsyncClient *client, uint8_t channel);
+        ~RtpTcpSink();
+
+        bool isReady() {return buffer != nullptr && mutex != NULL;};
+
+        /// @brief channel of the RTP packets; the RTCP channel is the next one
+        void setChannel(uint8_t channel) {this->channel = channel;};
+
+        bool beginFrame(size_t len);
+        bool sendPacket(const uint8_t *packet, size_t len);
+        void endFrame();
+        void describe(char *buf, size_t len);
+
+        /// @brief queues an RTSP response, it is sent at the next packet boundary
+        /// @return false if too many responses are waiting
+        bool queueReply(const char *data, size_t len);
+
+        /// @brief passes as much of the buffered frame and of the responses to the TCP stack as the window allows
+        void drain();
+
+        /// @return ms since the client last took data while some is waiting for it, 0 if nothing is waiting
+        unsigned long getStallTime();
+
+    private:
+        AsyncClient *client;
+        uint8_t channel;
+        SemaphoreHandle_t mutex = NULL;
+        uint8_t *buffer = nullptr;
+        size_t capacity = 0;
+        size_t fill = 0;            // written by the capture task while the frame is assembled
+        size_t len = 0;             // size of the frame being sent
+        size_t sent = 0;
+        size_t packet_end = 0;      // end of the packet being sent; the responses go out when sent reaches it
+
+        char replies[RTSP_REPLY_BUFFER_SIZE];
+        size_t reply_len = 0;
+        size_t reply_sent = 0;
+
+        unsigned long last_progress = 0;
+};
+
+#endif
@@ -0,0 +1,389 @@
+#include "rtsp.h"
+#include "app_httpd.h"
+#include <mbedtls/base64.h>
+
+#define RTSP_PUBLIC_METHODS         "OPTIONS, DESCRIBE, SETUP, PLAY, PAUSE, TEARDOWN, GET_PARAMETER, SET_PARAMETER"
+
+RtspSession::RtspSession(AsyncClient *client) {
+    this->client = client;
+    last_activity = millis();
+}
+
+RtspSession::~RtspSession() {
+    stopPlaying();
+    if(tcp) delete tcp;
+}
+
+void RtspSession::stopPlaying() {
+    if(state != RTSP_PLAYING) return;
+
+    RtpStreamer.removeSink(sink);
+    AppHttpd.stopCapture();
+    RtspServer.onStop();
+    state = RTSP_READY;
+    Log.info("RTSP stream to %s stopped", client->remoteIP().toString().c_str());
+}
+
+void RtspSession::onData(uint8_t *data, size_t len) {
+    last_activity = millis();
+
+    // the connection is closed by onPoll(), which may delete the session; the data path must not
+    while(len > 0 && !closing) {
+        if(skip) {
+            size_t n = min(skip, len);
+            skip -= n;
+            data += n;
+            len -= n;
+            continue;
+        }
+
+        // RTCP reports of the interleaved channels; the header may be split across segments
+        if(interleaved_len > 0 || (request_len == 0 && data[0] == '$')) {
+            interleaved[interleaved_len++] = *data++;
+            len--;
+            if(interleaved_len == RTSP_INTERLEAVED_HEADER) {
+                skip = (interleaved[2] << 8) | interleaved[3];
+                interleaved_len = 0;
+            }
+            continue;
+        }
+
+        request[request_len++] = *data++;
+        len--;
+
+        if(request_len >= 4 && memcmp(request + request_len - 4, "\r\n\r\n", 4) == 0) {
+            request[request_len] = '\0';
+            handleRequest();
+            request_len = 0;
+        }
+        else if(request_len >= RTSP_MAX_REQUEST - 1) {
+            request_len = 0;
+            reply(400, "Bad Request");
+        }
+    }
+}
+
+void RtspSession::onAck() {
+    if(tcp) tcp->drain();
+}
+
+void RtspSession::onPoll() {
+    if(closing) {
+        client->close();
+        return;
+    }
+    if(tcp) tcp->drain();
+
+    // a playing interleaved session is kept alive by the client reading the stream, the others by requests
+    if(state == RTSP_PLAYING && sink == tcp) {
+        if(tcp->getStallTime() > RTSP_TCP_STALL_TIMEOUT * 1000UL) {
+            Log.info("RTSP stream to %s stalled", client->remoteIP().toString().c_str());
+            client->close();
+        }
+    }
+    else if(millis() - last_activity > RTSP_SESSION_TIMEOUT * 1000UL) {
+        Log.info("RTSP session of %s timed out", client->remoteIP().toString().c_str());
+        client->close();
+    }
+}
+
+bool RtspSession::getHeader(const char *name, char *value, size_t len) {
+    size_t name_len = strlen(name);
+    const char *line = strstr(request, "\r\n");
+    while(line && line[2] != '\r') {
+        line += 2;
+        if(strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char *start = line + name_len + 1;
+            while(*start == ' ') start++;
+            const char *end = strstr(start, "\r\n");
+            size_t n = min((size_t)(end - start), len - 1);
+            memcpy(value, start, n);
+            value[n] = '\0';
+            return true;
+        }
+        line = strstr(line, "\r\n");
+    }
+    return false;
+}
+
+bool RtspSession::isAuthorized() {
+    const String &user = AppConn.getUser();
+    if(user.length() == 0) return true;
+
+    char auth[128];
+    if(!getHeader("Authorization", auth, sizeof(auth)) || strncasecmp(auth, "Basic ", 6) != 0) return false;
+
+    char credentials[96];
+    size_t n = 0;
+    int len = snprintf(credentials, sizeof(credentials), "%s:%s", user.c_str(), AppConn.getPwd().c_str());
+    if(len < 0 || len >= (int)sizeof(credentials)) return false;
+
+    unsigned char expected[132];
+    if(mbedtls_base64_encode(expected, sizeof(expected), &n, (const unsigned char*)credentials, len) != 0) return false;
+    return (strlen(auth + 6) == n && memcmp(auth + 6, expected, n) == 0);
+}
+
+void RtspSession::reply(int code, const char *status, const char *headers, const char *body, const char *content_type) {
+    char response[RTSP_MAX_RESPONSE];
+    int len = snprintf(response, sizeof(response), "RTSP/1.0 %d %s\r\nCSeq: %s\r\nServer: %s\r\n%s",
+                       code, status, cseq, AppHttpd.getName(), headers);
+    if(body)
+        len += snprintf(response + len, sizeof(response) - len, "Content-Type: %s\r\nContent-Length: %u\r\n\r\n%s",
+                        content_type, (unsigned)strlen(body), body);
+    else
+        len += snprintf(response + len, sizeof(response) - len, "\r\n");
+
+    if(len >= (int)sizeof(response)) len = sizeof(response) - 1;
+
+    // on an interleaved connection the response must not cut into an RTP packet
+    if(tcp) {
+        if(!tcp->queueReply(response, len)) {
+            Log.warn("RTSP responses to %s are not read, closing", client->remoteIP().toString().c_str());
+            closing = true;
+        }
+        return;
+    }
+    client->add(response, len, ASYNC_WRITEFLAG_COPY);
+    client->send();
+}
+
+void RtspSession::handleRequest() {
+    char method[16], url[128];
+    if(sscanf(request, "%15s %127s", method, url) != 2) {
+        reply(400, "Bad Request");
+        return;
+    }
+    if(!getHeader("CSeq", cseq, sizeof(cseq))) strcpy(cseq, "0");
+
+    char value[16];
+    if(getHeader("Content-Length", value, sizeof(value))) skip = atoi(value);
+
+    Log.debug("RTSP %s %s", method, url);
+
+    if(strcmp(method, "OPTIONS") == 0) {
+        onOptions();
+        return;
+    }
+
+    if(!isAuthorized()) {
+        char headers[96];
+        snprintf(headers, sizeof(headers), "WWW-Authenticate: Basic realm=\"%s\"\r\n", AppHttpd.getName());
+        reply(401, "Unauthorized", headers);
+        return;
+    }
+
+    if(strcmp(method, "DESCRIBE") == 0) {
+        onDescribe(url);
+        return;
+    }
+    if(strcmp(method, "SETUP") == 0) {
+        onSetup();
+        return;
+    }
+
+    // the remaining methods refer to the session
+    char session[32];
+    char headers[48];
+    if(state == RTSP_INIT || !getHeader("Session", session, sizeof(session)) ||
+       strncmp(session, session_id, strlen(session_id)) != 0) {
+        if(strcmp(method, "GET_PARAMETER") == 0 || strcmp(method, "SET_PARAMETER") == 0)
+            reply(200, "OK");
+        else
+            reply(454, "Session Not Found");
+        return;
+    }
+    snprintf(headers, sizeof(headers), "Session: %s\r\n", session_id);
+
+    if(strcmp(method, "PLAY") == 0)
+        onPlay();
+    else if(strcmp(method, "PAUSE") == 0) {
+        stopPlaying();
+        reply(200, "OK", headers);
+    }
+    else if(strcmp(method, "TEARDOWN") == 0) {
+        stopPlaying();
+        state = RTSP_INIT;
+        reply(200, "OK", headers);
+    }
+    else if(strcmp(method, "GET_PARAMETER") == 0 || strcmp(method, "SET_PARAMETER") == 0)
+        reply(200, "OK", headers);
+    else
+        reply(405, "Method Not Allowed", "Allow: " RTSP_PUBLIC_METHODS "\r\n");
+}
+
+void RtspSession::onOptions() {
+    reply(200, "OK", "Public: " RTSP_PUBLIC_METHODS "\r\n");
+}
+
+void RtspSession::onDescribe(const char *url) {
+    String ip = client->localIP().toString();
+    char sdp[320];
+    snprintf(sdp, sizeof(sdp),
+             "v=0\r\n"
+             "o=- %lu 1 IN IP4 %s\r\n"
+             "s=%s\r\n"
+             "c=IN IP4 0.0.0.0\r\n"
+             "t=0 0\r\n"
+             "m=video 0 RTP/AVP %d\r\n"
+             "a=rtpmap:%d JPEG/%d\r\n"
+             "a=framerate:%d\r\n"
+             "a=control:track1\r\n",
+             (unsigned long)millis(), ip.c_str(), AppHttpd.getName(),
+             RTP_PAYLOAD_JPEG, RTP_PAYLOAD_JPEG, RTP_CLOCK_RATE, AppCam.getFrameRate());
+
+    char headers[192];
+    size_t url_len = strlen(url);
+    snprintf(headers, sizeof(headers), "Content-Base: %s%s\r\n", url, (url_len && url[url_len-1] == '/'?"":"/"));
+    reply(200, "OK", headers, sdp, "application/sdp");
+}
+
+void RtspSession::onSetup() {
+    if(state == RTSP_PLAYING) {
+        reply(455, "Method Not Valid in This State");
+        return;
+    }
+
+    char transport[128];
+    if(!getHeader("Transport", transport, sizeof(transport))) {
+        reply(461, "Unsupported Transport");
+        return;
+    }
+
+    char headers[160];
+    const char *interleaved = strstr(transport, "interleaved=");
+    const char *ports = strstr(transport, "client_port=");
+
+    if(strstr(transport, "RTP/AVP/TCP")) {
+        int channel = (interleaved?atoi(interleaved + 12):0);
+        if(channel < 0 || channel > 254) {
+            reply(461, "Unsupported Transport");
+            return;
+        }
+        if(tcp) tcp->setChannel(channel);
+        else tcp = new RtpTcpSink(client, channel);
+        if(!tcp || !tcp->isReady()) {
+            if(tcp) delete tcp;
+            tcp = nullptr;
+            reply(453, "Not Enough Bandwidth");
+            return;
+        }
+        sink = tcp;
+        snprintf(headers, sizeof(headers), "Transport: RTP/AVP/TCP;unicast;interleaved=%d-%d\r\n", channel, channel + 1);
+    }
+    else if(ports && !strstr(transport, "multicast")) {
+        client_port = atoi(ports + 12);
+        if(client_port == 0) {
+            reply(461, "Unsupported Transport");
+            return;
+        }
+        udp.begin(client->remoteIP(), client_port);
+        sink = &udp;
+        snprintf(headers, sizeof(headers), "Transport: RTP/AVP;unicast;client_port=%u-%u\r\n",
+                 client_port, client_port + 1);
+    }
+    else {
+        reply(461, "Unsupported Transport");
+        return;
+    }
+
+    if(session_id[0] == '\0') snprintf(session_id, sizeof(session_id), "%08lX", (unsigned long)esp_random());
+    size_t len = strlen(headers);
+    snprintf(headers + len, sizeof(headers) - len, "Session: %s;timeout=%d\r\n", session_id, RTSP_SESSION_TIMEOUT);
+    state = RTSP_READY;
+    reply(200, "OK", headers);
+}
+
+void RtspSession::onPlay() {
+    char headers[64];
+    snprintf(headers, sizeof(headers), "Session: %s\r\nRange: npt=0.000-\r\n", session_id);
+
+    if(state == RTSP_PLAYING) {
+        reply(200, "OK", headers);
+        return;
+    }
+
+    if(!RtspServer.admitPlay()) {
+        reply(453, "Not Enough Bandwidth");
+        return;
+    }
+
+    // the response goes out before the first interleaved packet
+    reply(200, "OK", headers);
+
+    if(RtpStreamer.addSink(sink) != OS_SUCCESS) {
+        Log.warn("RTP streams exhausted, RTSP session of %s not started", client->remoteIP().toString().c_str());
+        closing = true;
+        return;
+    }
+    AppHttpd.startCapture();
+    RtspServer.onPlay();
+    state = RTSP_PLAYING;
+    Log.info("RTSP stream to %s started", client->remoteIP().toString().c_str());
+}
+
+int CLRtspServer::begin(uint16_t port) {
+    if(server) return OS_SUCCESS;
+
+    this->port = port;
+    server = new AsyncServer(port);
+    if(!server) return OS_FAIL;
+
+    server->onClient(onClient, this);
+    server->begin();
+    Log.info("RTSP server started on port %u", port);
+    return OS_SUCCESS;
+}
+
+void CLRtspServer::onClient(void *arg, AsyncClient *client) {
+    CLRtspServer *self = (CLRtspServer*)arg;
+
+    if(self->clients >= RTSP_MAX_CLIENTS) {
+        self->sessions_rejected++;
+        client->close(true);
+        delete client;
+        return;
+    }
+
+    RtspSession *session = new RtspSession(client);
+    if(!session) {
+        client->close(true);
+        delete client;
+        return;
+    }
+    self->clients++;
+
+    client->onData([](void *arg, AsyncClient *c, void *data, size_t len) {
+        ((RtspSession*)arg)->onData((uint8_t*)data, len);
+    }, session);
+    client->onAck([](void *arg, AsyncClient *c, size_t len, uint32_t time) {
+        ((RtspSession*)arg)->onAck();
+    }, session);
+    client->onPoll([](void *arg, AsyncClient *c) {
+        ((RtspSession*)arg)->onPoll();
+    }, session);
+    client->onDisconnect([](void *arg, AsyncClient *c) {
+        delete (RtspSession*)arg;
+        RtspServer.clients--;
+        delete c;
+    }, session);
+}
+
+bool CLRtspServer::admitPlay() {
+    if(AppHttpd.getStreamCount() + playing + 1 > AppHttpd.getMaxStreams() ||
+       !AppHttpd.admitRequest(REQUEST_STREAM, false)) {
+        sessions_rejected++;
+        Metrics.streams_rejected.inc();
+        return false;
+    }
+    return true;
+}
+
+void CLRtspServer::dumpToJson(JsonObject json) {
+    json["port"] = port;
+    json["clients"] = clients;
+    json["playing"] = playing;
+    json["served"] = sessions_served;
+    json["rejected"] = sessions_rejected;
+}
+
+CLRtspServer RtspServer;
@@ -0,0 +1,108 @@
+#ifndef rtsp_h
+#define rtsp_h
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include <freertos/semphr.h>
+#include <ArduinoJson.h>
+#include "rtp.h"
+#include "rtp_tcp.h"
+
+#define RTSP_DEFAULT_PORT           554
+#define RTSP_MAX_CLIENTS            4       // RTSP connections, playing or not
+#define RTSP_MAX_REQUEST            1024    // longest request header
+#define RTSP_SESSION_TIMEOUT        60      // seconds without a request before a session is closed
+#define RTSP_TCP_STALL_TIMEOUT      20      // seconds an interleaved session may stop reading before it is closed
+
+enum RtspStateEnum {RTSP_INIT, RTSP_READY, RTSP_PLAYING};
+
+/**
+ * @brief RTSP connection of one client with its single media session
+ *
+ */
+class RtspSession {
+    public:
+        RtspSession(AsyncClient *client);
+        ~RtspSession();
+
+        void onData(uint8_t *data, size_t len);
+        void onAck();
+        void onPoll();
+
+        /// @brief stops the RTP stream, the session stays set up
+        void stopPlaying();
+
+        RtspStateEnum getState() {return state;};
+
+    private:
+        void handleRequest();
+        bool getHeader(const char *name, char *value, size_t len);
+        bool isAuthorized();
+        void reply(int code, const char *status, const char *headers = "", const char *body = NULL,
+                   const char *content_type = NULL);
+
+        void onOptions();
+        void onDescribe(const char *url);
+        void onSetup();
+        void onPlay();
+
+        AsyncClient *client;
+        RtspStateEnum state = RTSP_INIT;
+
+        char request[RTSP_MAX_REQUEST];
+        size_t request_len = 0;
+        size_t skip = 0;            // interleaved data and request bodies are ignored
+        uint8_t interleaved[RTSP_INTERLEAVED_HEADER];
+        size_t interleaved_len = 0;
+        // set from the data path, where the disconnect callback would delete the session under onData();
+        // onPoll() closes the connection
+        bool closing = false;
+        char cseq[12] = "0";
+
+        char session_id[12] = "";
+        RtpUdpSink udp;
+        RtpTcpSink *tcp = nullptr;
+        RtpSink *sink = nullptr;
+        uint16_t client_port = 0;
+
+        unsigned long last_activity;
+};
+
+/**
+ * @brief RTSP server
+ * Publishes the camera as an RTP/JPEG stream (RFC 2326, RFC 2435) for NVRs and media players,
+ * with RTP over UDP or interleaved in the RTSP connection. The playing sessions count against the
+ * max_streams limit of the web server and get their frames from the shared capture loop.
+ *
+ */
+class CLRtspServer {
+    public:
+        int begin(uint16_t port);
+
+        int getPort() {return port;};
+        int getClientCount() {return clients;};
+        int getPlayingCount() {return playing;};
+
+        /// @brief admits a session to start playing
+        bool admitPlay();
+        void onPlay() {playing++; sessions_served++;};
+        void onStop() {playing--;};
+
+        void dumpToJson(JsonObject json);
+
+    private:
+        static void onClient(void *arg, AsyncClient *client);
+
+        AsyncServer *server = nullptr;
+        uint16_t port = 0;
+
+        // only updated from the AsyncTCP task
+        int clients = 0;
+        int playing = 0;
+        uint32_t sessions_served = 0;
+        uint32_t sessions_rejected = 0;
+};
+
+extern CLRtspServer RtspServer;
+
+#endif
@@ -0,0 +1,341 @@
+#include "servo_motion.h"
+#include "app_httpd.h"
+
+static void onServoTick(void *arg) {
+    ServoMotion.onTick();
+}
+
+bool CLServoMotion::begin() {
+    if(task) return true;
+
+    write_mutex = xSemaphoreCreateMutex();
+    if(!write_mutex) return false;
+
+    if(xTaskCreate(servoMotionTask, "ServoMotion", SERVO_TASK_STACK_SIZE, NULL, SERVO_TASK_PRIORITY, &task) != pdPASS)
+        return false;
+
+    esp_timer_create_args_t args = {};
+    args.callback = onServoTick;
+    args.name = "servo";
+    // the timer keeps running; it only wakes the task while a servo moves
+    return esp_timer_create(&args, &timer) == ESP_OK &&
+           esp_timer_start_periodic(timer, SERVO_TICK_US) == ESP_OK;
+}
+
+void CLServoMotion::onTick() {
+    if((active || pending) && task) xTaskNotifyGive(task);
+}
+
+void CLServoMotion::formatAck(uint8_t *buf, PwmAckStatusEnum status, uint16_t seq) {
+    buf[0] = 'A';
+    buf[1] = PWM_PROTOCOL_VERSION;
+    buf[2] = status;
+    buf[3] = 0;
+    buf[4] = seq & 0xFF;
+    buf[5] = seq >> 8;
+}
+
+PwmAckStatusEnum CLServoMotion::stageFrame(const uint8_t *frame, size_t len, uint16_t &seq) {
+    seq = 0;
+    if(len < PWM_FRAME_HEADER_SIZE) {
+        rejected++;
+        return PWM_ACK_MALFORMED;
+    }
+    seq = frame[4] | (frame[5] << 8);
+    if(frame[1] != PWM_PROTOCOL_VERSION) {
+        rejected++;
+        return PWM_ACK_VERSION;
+    }
+
+    uint8_t flags = frame[2];
+    int count = frame[3];
+    if(count == 0 || count > NUM_PWM || len != PWM_FRAME_HEADER_SIZE + (size_t)count * PWM_FRAME_ENTRY_SIZE) {
+        rejected++;
+        return PWM_ACK_MALFORMED;
+    }
+
+    // the whole frame is checked first, so it is applied completely or not at all
+    const uint8_t *entry = frame + PWM_FRAME_HEADER_SIZE;
+    for(int i = 0; i < count; i++, entry += PWM_FRAME_ENTRY_SIZE) {
+        if(entry[1] < PWM_MODE_SERVO || entry[1] > PWM_MODE_MOVE) {
+            rejected++;
+            return PWM_ACK_MALFORMED;
+        }
+        if(!AppHttpd.getPWM(entry[0])) {
+            rejected++;
+            return PWM_ACK_UNKNOWN_PIN;
+        }
+    }
+
+    entry = frame + PWM_FRAME_HEADER_SIZE;
+    portENTER_CRITICAL(&mux);
+    for(int i = 0; i < count; i++, entry += PWM_FRAME_ENTRY_SIZE) {
+        StagedWrite &w = staged[entry[0]];
+        if(w.dirty) coalesced++;
+        else if(staged_count < NUM_PWM) staged_pins[staged_count++] = entry[0];
+        w.value = entry[2] | (entry[3] << 8);
+        w.mode = entry[1];
+        w.dirty = true;
+    }
+    if(flags & PWM_FRAME_ACK_REQUESTED) {
+        // acknowledgements are cumulative: the tick acknowledges the last frame it applied
+        ack_seq = seq;
+        ack_pending = true;
+    }
+    frames++;
+    writes += count;
+    pending = true;
+    portEXIT_CRITICAL(&mux);
+    return PWM_ACK_OK;
+}
+
+void CLServoMotion::flushWrites() {
+    struct {uint8_t pin; uint8_t mode; uint16_t value;} batch[NUM_PWM];
+    int count;
+    bool ack;
+    uint16_t seq;
+
+    portENTER_CRITICAL(&mux);
+    count = staged_count;
+    for(int i = 0; i < count; i++) {
+        StagedWrite &w = staged[staged_pins[i]];
+        batch[i] = {staged_pins[i], w.mode, w.value};
+        w.dirty = false;
+    }
+    staged_count = 0;
+    ack = ack_pending;
+    seq = ack_seq;
+    ack_pending = false;
+    pending = false;
+    portEXIT_CRITICAL(&mux);
+
+    for(int i = 0; i < count; i++) {
+        if(batch[i].mode == PWM_MODE_SERVO)
+            AppHttpd.writePWM(batch[i].pin, batch[i].value);
+        else if(batch[i].mode == PWM_MODE_RAW)
+            AppHttpd.writePWM(batch[i].pin, batch[i].value, 0);
+        else
+            moveTo(batch[i].pin, batch[i].value);
+    }
+
+    if(ack) {
+        uint8_t buf[PWM_ACK_SIZE];
+        formatAck(buf, PWM_ACK_OK, seq);
+        AppHttpd.sendControlFrame(buf, sizeof(buf));
+        acks++;
+    }
+}
+
+ServoChannel *CLServoMotion::getChannel(uint8_t pin, bool create) {
+    for(int i = 0; i < channel_count; i++)
+        if(channels[i].pin == pin) return &channels[i];
+    if(!create || channel_count >= NUM_PWM) return nullptr;
+
+    ESP32PWM *pwm = AppHttpd.getPWM(pin);
+    if(!pwm || !pwm->attached()) return nullptr;
+
+    // the channel is published complete; the task only looks at channel_count entries
+    ServoChannel &ch = channels[channel_count];
+    ch.pin = pin;
+    ch.pwm = pwm;
+    ch.min_us = DEFAULT_uS_LOW;
+    ch.max_us = DEFAULT_uS_HIGH;
+    ch.pos = -1;
+    ch.vel = 0;
+    ch.target = 0;
+    float us_per_degree = (ch.max_us - ch.min_us) / 180.0f;
+    ch.default_vel = ch.max_vel = SERVO_DEFAULT_VELOCITY * us_per_degree;
+    ch.default_accel = ch.accel = SERVO_DEFAULT_ACCELERATION * us_per_degree;
+    ch.moving = false;
+    ch.event_ticks = 0;
+    ch.generation = 0;
+    channel_count++;
+    return &ch;
+}
+
+int CLServoMotion::setLimits(uint8_t pin, int velocity, int acceleration) {
+    portENTER_CRITICAL(&mux);
+    ServoChannel *ch = getChannel(pin, true);
+    if(ch) {
+        float us_per_degree = (ch->max_us - ch->min_us) / 180.0f;
+        if(velocity > 0) ch->default_vel = velocity * us_per_degree;
+        if(acceleration > 0) ch->default_accel = acceleration * us_per_degree;
+    }
+    portEXIT_CRITICAL(&mux);
+    return (ch?OS_SUCCESS:OS_FAIL);
+}
+
+int CLServoMotion::moveTo(uint8_t pin, int target, int velocity, int acceleration) {
+    // the duty is read before entering the critical section
+    ESP32PWM *pwm = AppHttpd.getPWM(pin);
+    if(!pwm || !pwm->attached()) return OS_FAIL;
+    uint32_t duty = pwm->getDuty();
+
+    portENTER_CRITICAL(&mux);
+    ServoChannel *ch = getChannel(pin, true);
+    if(ch) {
+        // same interpretation as writePWM(): small values are angles
+        if(target < MIN_PULSE_WIDTH)
+            target = map(constrain(target, 0, 180), 0, 180, ch->min_us, ch->max_us);
+        ch->target = constrain(target, ch->min_us, ch->max_us);
+
+        float us_per_degree = (ch->max_us - ch->min_us) / 180.0f;
+        ch->max_vel = (velocity > 0?velocity * us_per_degree:ch->default_vel);
+        ch->accel = (acceleration > 0?acceleration * us_per_degree:ch->default_accel);
+
+        if(ch->pos < 0) {
+            // unknown start: derive it from the duty of the channel, or jump if nothing was written yet
+            float us = (duty?(float)duty * REFRESH_USEC / (1 << pwm->getResolutionBits()) * 50.0f / pwm->getFreq():ch->target);
+            ch->pos = constrain(us, (float)ch->min_us, (float)ch->max_us);
+            ch->vel = 0;
+        }
+        ch->moving = true;
+        ch->event_ticks = 0;
+        active = true;
+        moves++;
+    }
+    portEXIT_CRITICAL(&mux);
+    if(!ch) return OS_FAIL;
+    AppHttpd.touchStatus();
+    return OS_SUCCESS;
+}
+
+void CLServoMotion::setPosition(uint8_t pin, int us) {
+    portENTER_CRITICAL(&mux);
+    ServoChannel *ch = getChannel(pin, false);
+    if(ch) {
+        ch->pos = us;
+        ch->vel = 0;
+        ch->moving = false;
+        ch->generation++;
+    }
+    portEXIT_CRITICAL(&mux);
+}
+
+void CLServoMotion::stop(uint8_t pin) {
+    portENTER_CRITICAL(&mux);
+    for(int i = 0; i < channel_count; i++)
+        if(pin == SERVO_ALL || channels[i].pin == pin) {
+            channels[i].moving = false;
+            channels[i].vel = 0;
+            channels[i].pos = -1;
+            channels[i].generation++;
+        }
+    portEXIT_CRITICAL(&mux);
+}
+
+void CLServoMotion::step(ServoChannel &ch, float dt, bool &arrived) {
+    float d = ch.target - ch.pos;
+    float dir = (d >= 0?1.0f:-1.0f);
+    float dv_max = ch.accel * dt;
+
+    arrived = false;
+    if(fabsf(d) < 0.5f && fabsf(ch.vel) <= dv_max) {
+        arrived = true;
+    } else {
+        // the highest speed from which the servo can still stop at the target
+        float v_stop = sqrtf(2.0f * ch.accel * fabsf(d));
+        float v_wanted = dir * min(ch.max_vel, v_stop);
+        ch.vel += constrain(v_wanted - ch.vel, -dv_max, dv_max);
+        ch.pos += ch.vel * dt;
+        // passing the target ends the move
+        if((ch.target - ch.pos) * dir <= 0) arrived = true;
+    }
+
+    if(arrived) {
+        ch.pos = ch.target;
+        ch.vel = 0;
+        ch.moving = false;
+    }
+}
+
+void CLServoMotion::sendEvent(uint8_t pin, int us, bool arrived) {
+    char msg[96];
+    int len = snprintf(msg, sizeof(msg), "{\"servo\":%u,\"us\":%d,\"angle\":%.1f,\"state\":\"%s\"}", pin, us,
+                       (us - DEFAULT_uS_LOW) * 180.0f / (DEFAULT_uS_HIGH - DEFAULT_uS_LOW), (arrived?"arrived":"moving"));
+    AppHttpd.sendControlEvent(msg, len);
+}
+
+void CLServoMotion::run() {
+    struct {int index; uint32_t generation; uint8_t pin; int us; bool arrived; bool report;} writes[NUM_PWM];
+    int64_t last_step = esp_timer_get_time();
+
+    while(true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // the staged writes first; a write cancels a move, a move starts with the next step
+        if(pending) flushWrites();
+
+        int64_t now = esp_timer_get_time();
+        int64_t elapsed = now - last_step;
+        last_step = now;
+        // after an idle period, or if the task was held up, the step is limited to a few ticks
+        if(elapsed > 3 * SERVO_TICK_US) elapsed = SERVO_TICK_US;
+        else if(elapsed > SERVO_TICK_US * 3 / 2) late_ticks++;
+        float dt = elapsed / 1000000.0f;
+
+        int count = 0;
+        bool any_moving = false;
+        portENTER_CRITICAL(&mux);
+        for(int i = 0; i < channel_count; i++) {
+            ServoChannel &ch = channels[i];
+            if(!ch.moving) continue;
+
+            bool arrived;
+            step(ch, dt, arrived);
+            if(arrived) arrivals++;
+            else any_moving = true;
+
+            bool report = arrived || ++ch.event_ticks >= SERVO_EVENT_TICKS;
+            if(report) ch.event_ticks = 0;
+            writes[count++] = {i, ch.generation, ch.pin, (int)roundf(ch.pos), arrived, report};
+        }
+        active = any_moving;
+        portEXIT_CRITICAL(&mux);
+
+        // the events are sent outside of the critical section; each LEDC write is checked against a direct
+        // write or a stop which came in the meantime, as it would overwrite them
+        for(int i = 0; i < count; i++) {
+            ServoChannel &ch = channels[writes[i].index];
+            uint32_t duty = ch.pwm->usToTicks(writes[i].us);
+            lockWrites();
+            portENTER_CRITICAL(&mux);
+            bool current = (ch.generation == writes[i].generation);
+            portEXIT_CRITICAL(&mux);
+            if(current) ch.pwm->write(duty);
+            unlockWrites();
+            if(current && writes[i].report) sendEvent(writes[i].pin, writes[i].us, writes[i].arrived);
+        }
+    }
+}
+
+void CLServoMotion::dumpToJson(JsonObject json) {
+    json["moves"] = moves;
+    json["arrivals"] = arrivals;
+    json["late_ticks"] = late_ticks;
+
+    JsonObject v2 = json["v2"].to<JsonObject>();
+    v2["frames"] = frames;
+    v2["writes"] = writes;
+    v2["coalesced"] = coalesced;
+    v2["rejected"] = rejected;
+    v2["acks"] = acks;
+
+    JsonArray servos = json["servos"].to<JsonArray>();
+    portENTER_CRITICAL(&mux);
+    int count = channel_count;
+    portEXIT_CRITICAL(&mux);
+    for(int i = 0; i < count; i++) {
+        JsonObject servo = servos.add<JsonObject>();
+        servo["pin"] = channels[i].pin;
+        servo["us"] = (int)roundf(channels[i].pos);
+        servo["target"] = (int)roundf(channels[i].target);
+        servo["moving"] = channels[i].moving;
+    }
+}
+
+void servoMotionTask(void *pvParameters) {
+    ServoMotion.run();
+}
+
+CLServoMotion ServoMotion;
@@ -0,0 +1,153 @@
+#ifndef servo_motion_h
+#define servo_motion_h
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/semphr.h>
+#include <ArduinoJson.h>
+#include <soc/soc_caps.h>
+#include "esp32pwm.h"
+
+#define SERVO_TICK_US               20000   // interpolation period, one servo refresh (50 Hz)
+#define SERVO_EVENT_TICKS           5       // position events every 5 ticks (100 ms) while moving
+#define SERVO_DEFAULT_VELOCITY      180     // degrees per second
+#define SERVO_DEFAULT_ACCELERATION  720     // degrees per second^2
+#define SERVO_ALL                   0       // all channels, like RESET_ALL_PWM
+#define SERVO_TASK_STACK_SIZE       3072
+#define SERVO_TASK_PRIORITY         5
+
+// binary control protocol v2 (see API.md)
+#define PWM_PROTOCOL_VERSION        2
+#define PWM_FRAME_HEADER_SIZE       6
+#define PWM_FRAME_ENTRY_SIZE        4
+#define PWM_FRAME_ACK_REQUESTED     0x01
+#define PWM_ACK_SIZE                6
+
+enum PwmWriteModeEnum {PWM_MODE_SERVO = 1, PWM_MODE_RAW = 2, PWM_MODE_MOVE = 3};
+enum PwmAckStatusEnum {PWM_ACK_OK, PWM_ACK_MALFORMED, PWM_ACK_UNKNOWN_PIN, PWM_ACK_VERSION, PWM_ACK_NOT_CONTROL};
+
+/**
+ * @brief Motion state of one servo channel. Positions and speeds are in microseconds of pulse width.
+ *
+ */
+struct ServoChannel {
+    uint8_t pin;
+    ESP32PWM *pwm;
+    int min_us;
+    int max_us;
+    float pos;              // current pulse width, < 0 if unknown
+    float vel;              // us/s, signed
+    float target;
+    float max_vel;          // us/s
+    float accel;            // us/s^2
+    float default_vel;
+    float default_accel;
+    bool moving;
+    uint8_t event_ticks;
+    uint32_t generation;    // bumped by a direct write or a stop; an older interpolated write is dropped
+};
+
+/**
+ * @brief PWM write of a v2 control frame, waiting for the next tick. A later write to the same pin replaces it.
+ *
+ */
+struct StagedWrite {
+    uint16_t value;
+    uint8_t mode;
+    bool dirty;
+};
+
+/**
+ * @brief Servo motion profiles
+ * Moves the servos to a target with a trapezoidal velocity profile (limited speed and acceleration), so a
+ * client sends one target per move instead of a stream of positions. A periodic esp_timer wakes the
+ * interpolator task once per servo refresh while a servo moves; the task writes the intermediate positions
+ * to the ESP32PWM channels and reports the position and the arrival to the websocket control client.
+ * A new target replaces the current one without stopping, the speed is adjusted smoothly.
+ * The same tick applies the PWM writes of the binary control protocol v2: the writes of a frame are staged
+ * together and the last value per pin wins until the tick, so a client flooding updates costs one LEDC
+ * write per pin and servo period.
+ *
+ */
+class CLServoMotion {
+    public:
+        bool begin();
+
+        /// @brief default speed limits of the servo on the pin
+        /// @param velocity degrees per second
+        /// @param acceleration degrees per second^2
+        int setLimits(uint8_t pin, int velocity, int acceleration);
+
+        /// @brief starts a move to the target
+        /// @param target angle (0-180) or pulse width in microseconds (500-2500), like writePWM()
+        /// @param velocity degrees per second, 0 for the default of the channel
+        /// @param acceleration degrees per second^2, 0 for the default of the channel
+        /// @return OS_SUCCESS, or OS_FAIL if no PWM is attached to the pin
+        int moveTo(uint8_t pin, int target, int velocity = 0, int acceleration = 0);
+
+        /// @brief records a position written directly to the servo; a running move is cancelled. Called before
+        /// the write, so no interpolated position of the move can land after it
+        void setPosition(uint8_t pin, int us);
+
+        /// @brief stops the moves; the position becomes unknown, as the PWM is reset afterwards
+        void stop(uint8_t pin = SERVO_ALL);
+
+        /// @brief serialises the LEDC writes with the interpolator. A direct write or a reset holds the lock from
+        /// setPosition() or stop() to its own write, so no interpolated position can land after it. A mutex, as
+        /// the LEDC driver may block on the fade service of the channel
+        void lockWrites() {if(write_mutex) xSemaphoreTake(write_mutex, portMAX_DELAY);};
+        void unlockWrites() {if(write_mutex) xSemaphoreGive(write_mutex);};
+
+        bool isActive() {return active;};
+
+        /// @brief stages the writes of a v2 control frame; all or none of them are applied
+        /// @param seq sequence number of the frame, if the header could be read
+        /// @return PWM_ACK_OK, or the reason of the rejection
+        PwmAckStatusEnum stageFrame(const uint8_t *frame, size_t len, uint16_t &seq);
+
+        /// @brief formats an acknowledgement frame of PWM_ACK_SIZE bytes
+        static void formatAck(uint8_t *buf, PwmAckStatusEnum status, uint16_t seq);
+
+        void dumpToJson(JsonObject json);
+
+        void run();
+        void onTick();
+
+    private:
+        ServoChannel *getChannel(uint8_t pin, bool create);
+        void step(ServoChannel &ch, float dt, bool &arrived);
+        void sendEvent(uint8_t pin, int us, bool arrived);
+        void flushWrites();
+
+        ServoChannel channels[NUM_PWM];
+        int channel_count = 0;
+        portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+        SemaphoreHandle_t write_mutex = NULL;
+        volatile bool active = false;
+
+        StagedWrite staged[SOC_GPIO_PIN_COUNT] = {};
+        uint8_t staged_pins[NUM_PWM];
+        int staged_count = 0;
+        volatile bool pending = false;
+        bool ack_pending = false;
+        uint16_t ack_seq = 0;
+
+        esp_timer_handle_t timer = NULL;
+        TaskHandle_t task = NULL;
+
+        // statistics
+        uint32_t moves = 0;
+        uint32_t arrivals = 0;
+        uint32_t late_ticks = 0;
+        uint32_t frames = 0;
+        uint32_t writes = 0;
+        uint32_t coalesced = 0;
+        uint32_t rejected = 0;
+        uint32_t acks = 0;
+};
+
+void servoMotionTask(void *pvParameters);
+
+extern CLServoMotion ServoMotion;
+
+#endif
@@ -0,0 +1,78 @@
+#include "session.h"
+#include <mbedtls/md.h>
+
+static const char hexdigits[] = "0123456789abcdef";
+
+void CLSession::rotateKey() {
+    uint8_t new_key[SESSION_KEY_SIZE];
+    esp_fill_random(new_key, sizeof(new_key));
+    portENTER_CRITICAL(&mux);
+    memcpy(key, new_key, sizeof(key));
+    portEXIT_CRITICAL(&mux);
+}
+
+bool CLSession::sign(const char *data, size_t len, char *hex) {
+    uint8_t k[SESSION_KEY_SIZE];
+    uint8_t mac[SESSION_MAC_SIZE];
+
+    portENTER_CRITICAL(&mux);
+    memcpy(k, key, sizeof(k));
+    portEXIT_CRITICAL(&mux);
+
+    int res = mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), k, sizeof(k), 
+                              (const unsigned char *)data, len, mac);
+    memset(k, 0, sizeof(k));
+    if(res != 0) return false;
+
+    for(int i=0; i < SESSION_MAC_SIZE; i++) {
+        hex[i*2] = hexdigits[mac[i] >> 4];
+        hex[i*2+1] = hexdigits[mac[i] & 0x0F];
+    }
+    return true;
+}
+
+bool CLSession::issue(char *buf, size_t len) {
+    if(len < SESSION_TOKEN_LENGTH + 1) return false;
+
+    snprintf(buf, len, "%08x.", (unsigned)(now() + SESSION_LIFETIME));
+    if(!sign(buf, 8, buf + 9)) return false;
+    buf[SESSION_TOKEN_LENGTH] = '\0';
+    return true;
+}
+
+bool CLSession::validate(const char *token, size_t len) {
+    if(!token || len != SESSION_TOKEN_LENGTH || token[8] != '.') return false;
+
+    char expected[SESSION_MAC_SIZE * 2];
+    if(!sign(token, 8, expected)) return false;
+
+    // constant time comparison of the signatures
+    uint8_t diff = 0;
+    for(int i=0; i < SESSION_MAC_SIZE * 2; i++) 
+        diff |= expected[i] ^ token[9 + i];
+    if(diff) return false;
+
+    char expiry[9];
+    memcpy(expiry, token, 8);
+    expiry[8] = '\0';
+    return strtoul(expiry, NULL, 16) > now();
+}
+
+const char * CLSession::findCookie(const char *cookies, size_t *len) {
+    const size_t name_len = strlen(SESSION_COOKIE);
+    const char *ptr = cookies;
+
+    while(ptr && *ptr) {
+        while(*ptr == ' ' || *ptr == ';') ptr++;
+        if(strncmp(ptr, SESSION_COOKIE, name_len) == 0 && ptr[name_len] == '=') {
+            ptr += name_len + 1;
+            const char *end = strchr(ptr, ';');
+            *len = (end?end - ptr:strlen(ptr));
+            return ptr;
+        }
+        ptr = strchr(ptr, ';');
+    }
+    return NULL;
+}
+
+CLSession Session;
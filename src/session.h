@@ -0,0 +1,55 @@
+#ifndef session_h
+#define session_h
+
+#include <Arduino.h>
+
+#define SESSION_KEY_SIZE        32
+#define SESSION_MAC_SIZE        32                              // HMAC-SHA256
+#define SESSION_TOKEN_LENGTH    (8 + 1 + SESSION_MAC_SIZE * 2)  // <expiry hex>.<mac hex>
+#define SESSION_LIFETIME        86400                           // seconds
+#define SESSION_COOKIE          "session"
+
+/**
+ * @brief Session Manager
+ * Issues and validates HMAC-signed session tokens, so the credentials only need to be checked once per session.
+ * A token is the hex encoded expiry time (seconds since boot), followed by its HMAC-SHA256 signature. 
+ * The signing key is generated randomly at start up, so all sessions end with a reboot. 
+ * 
+ */
+class CLSession {
+    public:
+        /// @brief generates the signing key
+        void begin() {rotateKey();};
+
+        /// @brief generates a new signing key. All issued tokens become invalid.
+        void rotateKey();
+
+        /// @brief issues a new token
+        /// @param buf destination buffer, at least SESSION_TOKEN_LENGTH + 1 bytes
+        /// @param len size of the buffer
+        /// @return true if the token has been issued
+        bool issue(char *buf, size_t len);
+
+        /// @brief checks the signature and the expiry of the token in constant time
+        /// @param token token to be checked, may be NULL
+        /// @param len length of the token
+        /// @return true if the token is valid
+        bool validate(const char *token, size_t len);
+
+        /// @brief extracts the session token from a Cookie header value
+        /// @param cookies value of the Cookie header
+        /// @param len returns the length of the token
+        /// @return pointer to the token in the cookies string or NULL
+        static const char * findCookie(const char *cookies, size_t *len);
+
+    private:
+        bool sign(const char *data, size_t len, char *hex);
+        static uint32_t now() {return (uint32_t)(esp_timer_get_time() / 1000000);};
+
+        uint8_t key[SESSION_KEY_SIZE];
+        portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+extern CLSession Session;
+
+#endif
@@ -0,0 +1,15 @@
+#include "shared_frame.h"
+
+SharedFrame *SharedFrame::create(const uint8_t *buf, size_t len) {
+    uint8_t *copy = (uint8_t*)(psramFound()?ps_malloc(len):malloc(len));
+    if(!copy) return nullptr;
+
+    memcpy(copy, buf, len);
+    return new SharedFrame(copy, len);
+}
+
+void SharedFrame::release() {
+    if(--refs > 0) return;
+    free(buf);
+    delete this;
+}
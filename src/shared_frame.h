@@ -0,0 +1,34 @@
+#ifndef shared_frame_h
+#define shared_frame_h
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @brief Copy of a JPEG frame shared by several consumers
+ * The frame is copied once out of the camera buffer (into PSRAM if available), and each consumer which
+ * keeps it takes a reference. The last release() frees it.
+ *
+ */
+class SharedFrame {
+    public:
+        /// @brief copies the frame
+        /// @return the copy, holding one reference, or nullptr if out of memory
+        static SharedFrame *create(const uint8_t *buf, size_t len);
+
+        void retain() {refs++;};
+        void release();
+        int getRefCount() {return refs.load();};
+
+        const uint8_t *getBuffer() {return buf;};
+        size_t getSize() {return len;};
+
+    private:
+        SharedFrame(uint8_t *buf, size_t len) : buf(buf), len(len) {};
+
+        uint8_t *buf;
+        size_t len;
+        std::atomic<int> refs{1};
+};
+
+#endif
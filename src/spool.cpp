@@ -0,0 +1,307 @@
+#include <esp_rom_crc.h>
+#include "spool.h"
+#include "logger.h"
+
+void CLSpool::segmentPath(char *buf, size_t len, uint32_t segment) {
+    snprintf(buf, len, SPOOL_DIR "/%08lu.log", (unsigned long)segment);
+}
+
+bool CLSpool::readHeader(File &file, SpoolRecordHeader &header) {
+    return file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+           header.magic == SPOOL_MAGIC && header.len > 0 && header.len <= SPOOL_MAX_RECORD &&
+           file.position() + header.len <= file.size();
+}
+
+void CLSpool::scanSegment(uint32_t segment, uint32_t offset, bool last) {
+    char path[32];
+    segmentPath(path, sizeof(path), segment);
+    File file = Storage.open(path, FILE_READ);
+    if(!file) return;
+
+    disk_bytes += file.size();
+    file.seek(offset);
+    SpoolRecordHeader header;
+    while(file.position() < file.size()) {
+        size_t pos = file.position();
+        if(!readHeader(file, header)) {
+            // torn by a power loss; the drain stops here and continues with the next segment
+            Log.warn("Spool: %s is damaged at %u", path, (unsigned)pos);
+            corrupt++;
+            if(last) write_segment = segment + 1;
+            break;
+        }
+        file.seek(header.len, SeekCur);
+        backlog_records++;
+        backlog_bytes += header.len;
+        next_seq = header.seq + 1;
+    }
+    if(last && write_segment == segment) write_size = file.size();
+    file.close();
+}
+
+bool CLSpool::begin(uint32_t max_bytes) {
+    this->max_bytes = max_bytes;
+    enabled = false;
+    backlog_records = 0;
+    backlog_bytes = 0;
+    disk_bytes = 0;
+
+    fs::FS &fs = Storage.getFS();
+    if(!fs.exists(SPOOL_DIR) && !fs.mkdir(SPOOL_DIR)) {
+        Log.error("Spool: cannot create " SPOOL_DIR);
+        return false;
+    }
+
+    // the segments on the storage
+    uint32_t first = UINT32_MAX, last = 0;
+    File dir = fs.open(SPOOL_DIR);
+    File entry;
+    while((entry = dir.openNextFile())) {
+        const char *name = strrchr(entry.name(), '/');
+        name = (name?name + 1:entry.name());
+        unsigned long segment;
+        if(sscanf(name, "%08lu.log", &segment) == 1) {
+            first = min(first, (uint32_t)segment);
+            last = max(last, (uint32_t)segment);
+        }
+        entry.close();
+    }
+    dir.close();
+
+    // the checkpoint; a crash while it was replaced leaves only the new one
+    SpoolCheckpoint cp = {};
+    File file = Storage.open(SPOOL_CHECKPOINT, FILE_READ);
+    if(!file) file = Storage.open(SPOOL_CHECKPOINT_TMP, FILE_READ);
+    if(file) {
+        if(file.read((uint8_t*)&cp, sizeof(cp)) != sizeof(cp) || cp.magic != SPOOL_MAGIC)
+            cp.magic = 0;
+        file.close();
+    }
+
+    if(first == UINT32_MAX) {
+        read_segment = write_segment = (cp.magic == SPOOL_MAGIC?cp.segment:0);
+        read_offset = write_size = 0;
+        next_seq = drained_seq = (cp.magic == SPOOL_MAGIC?cp.seq:0);
+    } else {
+        if(cp.magic == SPOOL_MAGIC && cp.segment >= first && cp.segment <= last) {
+            read_segment = cp.segment;
+            read_offset = cp.offset;
+        } else {
+            read_segment = first;
+            read_offset = 0;
+        }
+        // drained segments left behind by a crash
+        for(uint32_t segment = first; segment < read_segment; segment++) dropSegment(segment);
+
+        write_segment = last;
+        write_size = 0;
+        next_seq = drained_seq = (cp.magic == SPOOL_MAGIC?cp.seq:0);
+        for(uint32_t segment = read_segment; segment <= last; segment++)
+            scanSegment(segment, (segment == read_segment?read_offset:0), segment == last);
+    }
+
+    // the preferences share the storage; on the internal flash a full spool would keep them from being saved
+    uint64_t unit = (Storage.capacityUnits() == STORAGE_UNITS_MB?1024*1024:1);
+    uint64_t total = (uint64_t)Storage.getSize() * unit;
+    uint64_t used = (uint64_t)Storage.getUsed() * unit;
+    uint64_t room = disk_bytes + (total > used + SPOOL_STORAGE_RESERVE?total - used - SPOOL_STORAGE_RESERVE:0);
+    if(room < this->max_bytes) {
+        this->max_bytes = room;
+        Log.warn("Spool: limited to %lu bytes by the free space of the storage", (unsigned long)room);
+    }
+
+    enabled = true;
+    Log.info("Spool: %lu records (%llu bytes) waiting", (unsigned long)backlog_records, backlog_bytes);
+    return true;
+}
+
+int CLSpool::append(uint8_t kind, uint32_t time, const uint8_t *payload, size_t len) {
+    if(!enabled) return OS_FAIL;
+
+    size_t record_len = sizeof(SpoolRecordHeader) + len;
+    if(len == 0 || len > SPOOL_MAX_RECORD || disk_bytes + record_len > max_bytes) {
+        dropped++;
+        return OS_FAIL;
+    }
+
+    if(write_size > 0 && write_size + record_len > SPOOL_SEGMENT_SIZE) {
+        write_segment++;
+        write_size = 0;
+    }
+
+    SpoolRecordHeader header = {};
+    header.magic = SPOOL_MAGIC;
+    header.seq = next_seq;
+    header.time = time;
+    header.kind = kind;
+    header.len = len;
+    header.crc = esp_rom_crc32_le(0, payload, len);
+
+    char path[32];
+    segmentPath(path, sizeof(path), write_segment);
+    File file = Storage.open(path, FILE_APPEND, true);
+    if(!file) {
+        dropped++;
+        return OS_FAIL;
+    }
+    bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.write(payload, len) == len;
+    file.close();
+    if(!ok) {
+        Log.warn("Spool: write to %s failed", path);
+        dropped++;
+        if(write_size == 0) {
+            // nothing else in the segment, the next append starts it again
+            Storage.remove(path);
+            return OS_FAIL;
+        }
+        // the partial record is skipped as damaged; the appends continue in a new segment
+        file = Storage.open(path, FILE_READ);
+        if(file) {
+            disk_bytes += file.size() - min((size_t)file.size(), (size_t)write_size);
+            file.close();
+        }
+        write_segment++;
+        write_size = 0;
+        return OS_FAIL;
+    }
+
+    write_size += record_len;
+    disk_bytes += record_len;
+    next_seq++;
+    appended++;
+    backlog_records++;
+    backlog_bytes += len;
+    return OS_SUCCESS;
+}
+
+int CLSpool::drain(SpoolSendCallback send, void *arg, int max_records, uint32_t rate_bps) {
+    if(!enabled || backlog_records == 0) return 0;
+
+    uint8_t *payload = nullptr;
+    size_t payload_size = 0;
+    int count = 0;
+    bool failed = false;
+    uint64_t batch_bytes = 0;
+    unsigned long start = millis();
+
+    while(count < max_records && !failed && read_segment <= write_segment) {
+        char path[32];
+        segmentPath(path, sizeof(path), read_segment);
+        File file = Storage.open(path, FILE_READ);
+        if(file) file.seek(read_offset);
+
+        SpoolRecordHeader header;
+        bool end_of_segment = !file || file.position() >= file.size();
+        if(!end_of_segment && !readHeader(file, header)) {
+            // the rest of a damaged segment is lost
+            end_of_segment = true;
+        }
+
+        if(end_of_segment) {
+            if(file) file.close();
+            if(read_segment == write_segment) {
+                // nothing after the end of the log, whatever the scan counted
+                backlog_records = 0;
+                backlog_bytes = 0;
+                break;
+            }
+            dropSegment(read_segment);
+            read_segment++;
+            read_offset = 0;
+            continue;
+        }
+
+        if(header.len > payload_size) {
+            free(payload);
+            payload = (uint8_t*)(psramFound()?ps_malloc(header.len):malloc(header.len));
+            payload_size = (payload?header.len:0);
+        }
+        if(!payload || file.read(payload, header.len) != header.len) {
+            file.close();
+            failed = true;
+            break;
+        }
+        file.close();
+
+        size_t record_len = sizeof(header) + header.len;
+        if(esp_rom_crc32_le(0, payload, header.len) != header.crc) {
+            Log.warn("Spool: record %lu is damaged", (unsigned long)header.seq);
+            corrupt++;
+        } else if(!send(header, payload, arg)) {
+            failed = true;
+            break;
+        } else {
+            drained++;
+            drained_bytes += header.len;
+            batch_bytes += header.len;
+            count++;
+        }
+
+        read_offset += record_len;
+        drained_seq = header.seq + 1;
+        backlog_records--;
+        backlog_bytes -= header.len;
+
+        // throttled, so the backlog does not starve the live uploads and the other users of the link
+        if(rate_bps > 0) {
+            unsigned long due = (unsigned long)(batch_bytes * 1000 / rate_bps);
+            unsigned long elapsed = millis() - start;
+            if(due > elapsed) vTaskDelay(pdMS_TO_TICKS(due - elapsed));
+        }
+    }
+    free(payload);
+
+    unsigned long elapsed = millis() - start;
+    if(batch_bytes > 0 && elapsed > 0) last_rate_bps = (uint32_t)(batch_bytes * 1000 / elapsed);
+
+    if(backlog_records == 0 && read_offset > 0) {
+        // fully drained: the log starts over in a new segment
+        dropSegment(read_segment);
+        read_segment = ++write_segment;
+        read_offset = write_size = 0;
+    }
+    if(count > 0 || backlog_records == 0) saveCheckpoint();
+    return (failed?-1:count);
+}
+
+void CLSpool::dropSegment(uint32_t segment) {
+    char path[32];
+    segmentPath(path, sizeof(path), segment);
+    File file = Storage.open(path, FILE_READ);
+    if(!file) return;
+    size_t size = file.size();
+    file.close();
+    if(Storage.remove(path)) disk_bytes -= min((uint64_t)size, disk_bytes);
+}
+
+void CLSpool::saveCheckpoint() {
+    SpoolCheckpoint cp = {SPOOL_MAGIC, read_segment, read_offset, drained_seq};
+
+    // written aside first, so a crash leaves either the old or the new checkpoint
+    File file = Storage.open(SPOOL_CHECKPOINT_TMP, FILE_WRITE);
+    if(!file) return;
+    bool ok = file.write((const uint8_t*)&cp, sizeof(cp)) == sizeof(cp);
+    file.close();
+    if(!ok) return;
+    Storage.remove(SPOOL_CHECKPOINT);
+    Storage.getFS().rename(SPOOL_CHECKPOINT_TMP, SPOOL_CHECKPOINT);
+}
+
+void CLSpool::dumpToJson(JsonObject json) {
+    json["enabled"] = enabled;
+    if(!enabled) return;
+
+    json["backlog"] = backlog_records;
+    json["backlog_bytes"] = backlog_bytes;
+    json["disk_bytes"] = disk_bytes;
+    json["max_bytes"] = max_bytes;
+    json["appended"] = appended;
+    json["drained"] = drained;
+    json["drained_bytes"] = drained_bytes;
+    json["drain_rate_bps"] = last_rate_bps;
+    json["dropped"] = dropped;
+    json["corrupt"] = corrupt;
+}
+
+CLSpool Spool;
@@ -0,0 +1,105 @@
+#ifndef spool_h
+#define spool_h
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "storage.h"
+
+#define SPOOL_DIR               "/spool"
+#define SPOOL_CHECKPOINT        SPOOL_DIR "/checkpoint"
+#define SPOOL_CHECKPOINT_TMP    SPOOL_DIR "/checkpoint.tmp"
+#define SPOOL_SEGMENT_SIZE      (1024*1024)     // a new segment file is started beyond this size
+#define SPOOL_MAGIC             0x4C4F5053      // "SPOL"
+#define SPOOL_MAX_RECORD        (512*1024)
+#define SPOOL_STORAGE_RESERVE   (128*1024)      // left free on the storage for the preferences and the other files
+
+enum SpoolKindEnum {SPOOL_STILL, SPOOL_CLIP};
+
+/**
+ * @brief Header of a spooled record, followed by the payload
+ *
+ */
+struct SpoolRecordHeader {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t time;          // capture time, seconds since the epoch (0 if the clock was not set)
+    uint8_t kind;
+    uint8_t reserved[3];
+    uint32_t len;
+    uint32_t crc;           // CRC32 of the payload
+};
+
+/**
+ * @brief Drained position, saved after each batch
+ *
+ */
+struct SpoolCheckpoint {
+    uint32_t magic;
+    uint32_t segment;
+    uint32_t offset;
+    uint32_t seq;
+};
+
+/// @brief uploads a spooled record; returns true on success
+typedef bool (*SpoolSendCallback)(const SpoolRecordHeader &header, const uint8_t *payload, void *arg);
+
+/**
+ * @brief Store-and-forward queue on the storage (SD card)
+ * Captures which cannot be uploaded are appended to a log of segment files. Once the connection is back,
+ * the log is drained in batches at a limited rate, oldest record first. The drained position is kept in a
+ * checkpoint file, so the queue survives reboots; the drained segments are deleted. A record torn by a
+ * power loss is detected by its length and CRC, the appends continue in a new segment.
+ * The spool never takes more than the free space of the storage minus SPOOL_STORAGE_RESERVE.
+ * Not thread safe: append and drain from one task only.
+ *
+ */
+class CLSpool {
+    public:
+        /// @param max_bytes limit of the spool size on the storage; lowered to the free space
+        bool begin(uint32_t max_bytes);
+        bool isEnabled() {return enabled;};
+
+        /// @brief appends a record to the log
+        /// @return OS_SUCCESS, or OS_FAIL if the spool is full or the write failed
+        int append(uint8_t kind, uint32_t time, const uint8_t *payload, size_t len);
+
+        /// @brief uploads up to max_records records, throttled to rate_bps bytes per second (0 = no limit)
+        /// @return number of records drained, or -1 if the upload failed
+        int drain(SpoolSendCallback send, void *arg, int max_records, uint32_t rate_bps);
+
+        uint32_t getBacklog() {return backlog_records;};
+
+        void dumpToJson(JsonObject json);
+
+    private:
+        void segmentPath(char *buf, size_t len, uint32_t segment);
+        bool readHeader(File &file, SpoolRecordHeader &header);
+        void scanSegment(uint32_t segment, uint32_t offset, bool last);
+        void saveCheckpoint();
+        void dropSegment(uint32_t segment);
+
+        bool enabled = false;
+        uint32_t max_bytes = 0;
+
+        uint32_t read_segment = 0;
+        uint32_t read_offset = 0;
+        uint32_t write_segment = 0;
+        uint32_t write_size = 0;
+        uint32_t next_seq = 0;
+        uint32_t drained_seq = 0;
+
+        // statistics
+        uint32_t backlog_records = 0;
+        uint64_t backlog_bytes = 0;
+        uint64_t disk_bytes = 0;
+        uint32_t appended = 0;
+        uint32_t drained = 0;
+        uint64_t drained_bytes = 0;
+        uint32_t dropped = 0;
+        uint32_t corrupt = 0;
+        uint32_t last_rate_bps = 0;
+};
+
+extern CLSpool Spool;
+
+#endif
@@ -0,0 +1,57 @@
+#include "trace.h"
+#include <inttypes.h>
+#include "logger.h"
+
+bool CLTrace::begin() {
+    if(events) return true;
+    if(psramFound())
+        events = (TraceEvent*)ps_calloc(TRACE_BUFFER_EVENTS, sizeof(TraceEvent));
+    if(!events) 
+        Log.error("Failed to allocate the trace buffer");
+    return isEnabled();
+}
+
+void CLTrace::record(const char *name, char phase) {
+    if(!events || paused.load(std::memory_order_relaxed) > 0) return;
+
+    uint32_t index = head.fetch_add(1, std::memory_order_relaxed) % TRACE_BUFFER_EVENTS;
+    TraceEvent &e = events[index];
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    e.ts = esp_timer_get_time();
+    e.name = name;
+    strncpy(e.task, pcTaskGetTaskName(task), TRACE_TASK_NAME_LEN - 1);
+    e.tid = (uint32_t)task;
+    e.core = xPortGetCoreID();
+    e.phase = phase;
+}
+
+uint32_t CLTrace::first() {
+    uint32_t h = last();
+    return (h > TRACE_BUFFER_EVENTS?h - TRACE_BUFFER_EVENTS:0);
+}
+
+int CLTrace::format(uint32_t index, char *buf, size_t len) {
+    TraceEvent &e = events[index % TRACE_BUFFER_EVENTS];
+    return snprintf(buf, len, "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%" PRId64 ",\"pid\":1,\"tid\":%u,\"args\":{\"core\":%u}}",
+                    (e.name?e.name:"?"), e.phase, e.ts, (unsigned)e.tid, (unsigned)e.core);
+}
+
+int CLTrace::formatTask(uint32_t index, char *buf, size_t len, const uint32_t *known, int nknown, int max_known) {
+    TraceEvent &e = events[index % TRACE_BUFFER_EVENTS];
+    for(int i=0; i < nknown; i++)
+        if(known[i] == e.tid) return 0;
+    if(nknown >= max_known) return 0;
+
+    return snprintf(buf, len, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    (unsigned)e.tid, e.task);
+}
+
+TraceScope::TraceScope(const char *name) : name(name) {
+    Trace.record(name, 'B');
+}
+
+TraceScope::~TraceScope() {
+    Trace.record(name, 'E');
+}
+
+CLTrace Trace;
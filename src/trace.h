@@ -0,0 +1,87 @@
+#ifndef trace_h
+#define trace_h
+
+#include <Arduino.h>
+#include <atomic>
+
+#if __has_include("../myconfig.h")
+#include "../myconfig.h"
+#else
+#include "app_config.h"
+#endif
+
+#define TRACE_TASK_NAME_LEN 12
+
+/**
+ * @brief Trace event. The name must be a string literal (only the pointer is stored).
+ * 
+ */
+struct TraceEvent { const char *name; int64_t ts; uint32_t tid; uint8_t core; char phase; char task[TRACE_TASK_NAME_LEN]; };
+
+/**
+ * @brief Timeline Tracer
+ * Records begin/end events with their core and task into a fixed ring buffer in PSRAM. The events can 
+ * be exported in the Chrome trace format. Use the TRACE_* macros, which compile to nothing unless 
+ * ENABLE_TRACE is defined.
+ * 
+ */
+class CLTrace {
+    public:
+        /// @brief allocates the ring buffer
+        /// @return true if the buffer is available
+        bool begin();
+
+        void record(const char *name, char phase);
+
+        bool isEnabled() {return events != nullptr;};
+
+        /// @brief stops recording while the buffer is being exported; the exports running at the same
+        /// time are counted, recording resumes when the last one ends
+        void pause(bool val) {paused.fetch_add(val?1:-1, std::memory_order_relaxed);};
+
+        /// @brief index of the oldest and the next event in the ring buffer
+        uint32_t first();
+        uint32_t last() {return head.load(std::memory_order_relaxed);};
+
+        /// @brief formats the event as a Chrome trace JSON object
+        /// @return number of characters written (as snprintf)
+        int format(uint32_t index, char *buf, size_t len);
+
+        /// @brief formats the thread name metadata of the task, if not emitted yet. The caller adds
+        /// getTid() to the known tasks once the item is actually written.
+        /// @return number of characters written, or 0 if the task is already known
+        int formatTask(uint32_t index, char *buf, size_t len, const uint32_t *known, int nknown, int max_known);
+
+        uint32_t getTid(uint32_t index) {return events[index % TRACE_BUFFER_EVENTS].tid;};
+
+    private:
+        TraceEvent *events = nullptr;
+        std::atomic<uint32_t> head{0};
+        std::atomic<int> paused{0};
+};
+
+/**
+ * @brief Records the begin event on creation and the end event when going out of scope 
+ * 
+ */
+class TraceScope {
+    public:
+        TraceScope(const char *name);
+        ~TraceScope();
+    private:
+        const char *name;
+};
+
+extern CLTrace Trace;
+
+#ifdef ENABLE_TRACE
+#define TRACE_BEGIN(name)   Trace.record(name, 'B')
+#define TRACE_END(name)     Trace.record(name, 'E')
+#define TRACE_SCOPE(name)   TraceScope _trace_scope(name)
+#else
+#define TRACE_BEGIN(name)   ((void)0)
+#define TRACE_END(name)     ((void)0)
+#define TRACE_SCOPE(name)   ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,224 @@
+#include <climits>
+#include <driver/gpio.h>
+#include "trigger.h"
+#include "app_httpd.h"
+
+static const char * action_names[] = {"still", "burst", "record"};
+
+static void IRAM_ATTR onTriggerInterrupt(void *arg) {
+    Triggers.onEdge((TriggerInput*)arg);
+}
+
+int CLTriggers::parseEdge(const char *name) {
+    if(!strcmp(name, "rising")) return RISING;
+    if(!strcmp(name, "falling")) return FALLING;
+    if(!strcmp(name, "any")) return CHANGE;
+    return -1;
+}
+
+int CLTriggers::parsePull(const char *name) {
+    if(!strcmp(name, "up")) return INPUT_PULLUP;
+    if(!strcmp(name, "down")) return INPUT_PULLDOWN;
+    if(!strcmp(name, "none")) return INPUT;
+    return -1;
+}
+
+int CLTriggers::parseAction(const char *name) {
+    for(int i = 0; i < (int)(sizeof(action_names)/sizeof(action_names[0])); i++)
+        if(!strcmp(name, action_names[i])) return i;
+    return -1;
+}
+
+int CLTriggers::add(uint8_t pin, uint8_t edge, uint8_t pull, TriggerActionEnum action,
+                    int debounce, int count, int duration) {
+    if(task || input_count >= TRIGGER_MAX_INPUTS || !GPIO_IS_VALID_GPIO(pin)) return OS_FAIL;
+    for(int i = 0; i < input_count; i++)
+        if(inputs[i].pin == pin) return OS_FAIL;
+
+    TriggerInput &input = inputs[input_count++];
+    input.pin = pin;
+    input.edge = edge;
+    input.pull = pull;
+    input.action = action;
+    input.debounce = constrain(debounce, 0, 10000);
+    input.count = constrain(count, 1, TRIGGER_MAX_BURST);
+    input.duration = constrain(duration, 1, TRIGGER_MAX_DURATION);
+    return OS_SUCCESS;
+}
+
+bool CLTriggers::begin() {
+    if(task || input_count == 0) return true;
+
+    if(xTaskCreate(triggerTask, "Trigger", TRIGGER_TASK_STACK_SIZE, NULL, TRIGGER_TASK_PRIORITY, &task) != pdPASS)
+        return false;
+
+    for(int i = 0; i < input_count; i++) {
+        pinMode(inputs[i].pin, inputs[i].pull);
+        attachInterruptArg(inputs[i].pin, onTriggerInterrupt, &inputs[i], inputs[i].edge);
+        Log.info("Trigger input on pin %d: %s", inputs[i].pin, action_names[inputs[i].action]);
+    }
+    return true;
+}
+
+void IRAM_ATTR CLTriggers::onEdge(TriggerInput *input) {
+    int64_t now = esp_timer_get_time();
+
+    // the first edge counts, the bounces which follow it are dropped
+    if(now - input->last_edge_us < input->debounce * 1000LL) {
+        input->bounced++;
+        return;
+    }
+    input->last_edge_us = now;
+
+    portENTER_CRITICAL_ISR(&mux);
+    bool waiting = (input->pending_us != 0);
+    if(!waiting) input->pending_us = now;
+    portEXIT_CRITICAL_ISR(&mux);
+    if(waiting) {
+        input->missed++;
+        return;
+    }
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &woken);
+    if(woken) portYIELD_FROM_ISR();
+}
+
+void CLTriggers::offerFrame(const uint8_t *buf, size_t len, int64_t capture_us) {
+    // the trigger task waits for the offer to end before it lets the input go
+    portENTER_CRITICAL(&mux);
+    TriggerInput *input = (frame_wanted?active:nullptr);
+    offering = (input != nullptr);
+    portEXIT_CRITICAL(&mux);
+    if(!input) return;
+
+    if(frames_taken == 0) {
+        uint32_t latency = capture_us - active_edge_us;
+        input->last_latency_us = latency;
+        if(latency > input->max_latency_us) input->max_latency_us = latency;
+        Metrics.trigger_latency_us.observe(latency);
+    }
+    frames_taken++;
+    frames++;
+
+    // one copy of the frame for both of the publishers
+    SharedFrame *frame = SharedFrame::create(buf, len);
+    if(frame) {
+        if(AppPush.queueStill(frame) == OS_SUCCESS) frames_pushed++;
+        if(AppMqtt.publishFrame("trigger/jpeg", frame) == OS_SUCCESS) frames_published++;
+        frame->release();
+    }
+
+    if(--frames_left <= 0) frame_wanted = false;
+    offering = false;
+    if(task) xTaskNotifyGive(task);
+}
+
+void CLTriggers::capture(TriggerInput &input, int64_t edge_us) {
+    input.fired++;
+    Metrics.triggers.inc();
+
+    int64_t deadline = (input.action == TRIGGER_RECORD?edge_us + input.duration * 1000000LL:0);
+    active_edge_us = edge_us;
+    frames_taken = 0;
+    frames_left = (input.action == TRIGGER_STILL?1:(input.action == TRIGGER_BURST?input.count:INT_MAX));
+    active = &input;
+    frame_wanted = true;
+
+    // an idle capture loop would start with a full frame period; the first frame is taken right away instead
+    if(!AppHttpd.isCapturing())
+        AppHttpd.snapStill();
+
+    if(frame_wanted) {
+        AppHttpd.startCapture();
+        unsigned long last_frame = millis();
+        int taken = frames_taken;
+        while(frame_wanted) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+            if(deadline && esp_timer_get_time() >= deadline) break;
+            if(frames_taken != taken) {
+                taken = frames_taken;
+                last_frame = millis();
+            }
+            else if(millis() - last_frame > TRIGGER_FRAME_TIMEOUT) {
+                timeouts++;
+                break;
+            }
+        }
+        frame_wanted = false;
+        AppHttpd.stopCapture();
+    }
+    // a frame of the capture loop may still be on its way
+    portENTER_CRITICAL(&mux);
+    frame_wanted = false;
+    portEXIT_CRITICAL(&mux);
+    while(offering) vTaskDelay(1);
+    active = nullptr;
+
+    Log.info("Trigger on pin %d: %s of %d frame(s), latency %u ms", input.pin, action_names[input.action],
+             frames_taken, (unsigned)(frames_taken?input.last_latency_us / 1000:0));
+
+    JsonDocument event;
+    event["pin"] = input.pin;
+    event["action"] = action_names[input.action];
+    event["frames"] = frames_taken;
+    if(frames_taken) event["latency_ms"] = input.last_latency_us / 1000.0;
+    AppMqtt.publishEvent("trigger", event);
+}
+
+void CLTriggers::run() {
+    while(true) {
+        bool any = false;
+        for(int i = 0; i < input_count; i++) {
+            // an edge during the capture is served after it; more of them are missed
+            portENTER_CRITICAL(&mux);
+            int64_t edge_us = inputs[i].pending_us;
+            inputs[i].pending_us = 0;
+            portEXIT_CRITICAL(&mux);
+            if(!edge_us) continue;
+
+            any = true;
+            capture(inputs[i], edge_us);
+        }
+        if(!any) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void CLTriggers::dumpPrefsToJson(JsonArray json) {
+    for(int i = 0; i < input_count; i++) {
+        TriggerInput &input = inputs[i];
+        JsonObject obj = json.add<JsonObject>();
+        obj["pin"] = input.pin;
+        obj["edge"] = (input.edge == RISING?"rising":(input.edge == FALLING?"falling":"any"));
+        obj["pull"] = (input.pull == INPUT_PULLUP?"up":(input.pull == INPUT_PULLDOWN?"down":"none"));
+        obj["debounce"] = input.debounce;
+        obj["action"] = action_names[input.action];
+        if(input.action == TRIGGER_BURST) obj["count"] = input.count;
+        if(input.action == TRIGGER_RECORD) obj["duration"] = input.duration;
+    }
+}
+
+void CLTriggers::dumpToJson(JsonObject json) {
+    json["frames"] = frames;
+    json["pushed"] = frames_pushed;
+    json["published"] = frames_published;
+    json["timeouts"] = timeouts;
+    JsonArray list = json["inputs"].to<JsonArray>();
+    for(int i = 0; i < input_count; i++) {
+        TriggerInput &input = inputs[i];
+        JsonObject obj = list.add<JsonObject>();
+        obj["pin"] = input.pin;
+        obj["action"] = action_names[input.action];
+        obj["fired"] = input.fired;
+        obj["bounced"] = input.bounced;
+        obj["missed"] = input.missed;
+        obj["latency_ms"] = input.last_latency_us / 1000.0;
+        obj["latency_max_ms"] = input.max_latency_us / 1000.0;
+    }
+}
+
+void triggerTask(void *pvParameters) {
+    Triggers.run();
+}
+
+CLTriggers Triggers;
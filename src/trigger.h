@@ -0,0 +1,110 @@
+#ifndef trigger_h
+#define trigger_h
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <ArduinoJson.h>
+
+#define TRIGGER_MAX_INPUTS          4
+#define TRIGGER_DEFAULT_DEBOUNCE    50      // ms
+#define TRIGGER_DEFAULT_BURST       5       // frames
+#define TRIGGER_MAX_BURST           50
+#define TRIGGER_DEFAULT_DURATION    10      // s of a recording
+#define TRIGGER_MAX_DURATION        300
+#define TRIGGER_FRAME_TIMEOUT       5000    // ms to wait for a frame from the capture loop
+#define TRIGGER_TASK_STACK_SIZE     4096
+#define TRIGGER_TASK_PRIORITY       3
+
+enum TriggerActionEnum {TRIGGER_STILL, TRIGGER_BURST, TRIGGER_RECORD};
+
+/**
+ * @brief GPIO input which starts a capture
+ *
+ */
+struct TriggerInput {
+    uint8_t pin;
+    uint8_t edge;               // RISING, FALLING or CHANGE
+    uint8_t pull;               // INPUT, INPUT_PULLUP or INPUT_PULLDOWN
+    TriggerActionEnum action;
+    uint16_t debounce;          // ms
+    uint16_t count;             // frames of a burst
+    uint16_t duration;          // s of a recording
+
+    // written by the interrupt handler
+    volatile int64_t last_edge_us;
+    volatile int64_t pending_us;    // time of the edge waiting for its capture, 0 if none
+    volatile uint32_t bounced;
+    volatile uint32_t missed;       // edges while a capture of the input was already waiting
+
+    // statistics
+    uint32_t fired;
+    uint32_t last_latency_us;
+    uint32_t max_latency_us;
+};
+
+/**
+ * @brief External trigger inputs
+ * PIR sensors, door contacts and the like wired to spare GPIOs start a still, a burst of frames or a
+ * recording. The interrupt handler only timestamps the edge, drops the bounces within the debounce time
+ * and wakes the trigger task. If the capture loop is idle, the task takes the first frame itself, with the
+ * lamp strobe of a still; otherwise, and for the next frames of a burst or a recording, the frames come from
+ * the running capture loop. The frames are handed to the push publisher in still mode (spooled while
+ * offline) and to MQTT (<topic>/trigger/jpeg), followed by a "trigger" event. The time from the edge to
+ * the capture of the first frame is measured for each input.
+ * Configured in the "triggers" array of /httpd.json.
+ *
+ */
+class CLTriggers {
+    public:
+        /// @brief adds an input; begin() attaches the interrupts
+        /// @return OS_SUCCESS, or OS_FAIL if the pin is not valid or there are too many inputs
+        int add(uint8_t pin, uint8_t edge, uint8_t pull, TriggerActionEnum action,
+                int debounce = TRIGGER_DEFAULT_DEBOUNCE, int count = TRIGGER_DEFAULT_BURST,
+                int duration = TRIGGER_DEFAULT_DURATION);
+        bool begin();
+
+        int getCount() {return input_count;};
+
+        /// @brief true while a triggered capture waits for frames from the capture loop
+        bool isFrameWanted() {return frame_wanted;};
+        /// @brief hands the frame over to the consumers; called from the capture loop
+        void offerFrame(const uint8_t *buf, size_t len, int64_t capture_us);
+
+        void dumpPrefsToJson(JsonArray json);
+        void dumpToJson(JsonObject json);
+
+        static int parseEdge(const char *name);
+        static int parsePull(const char *name);
+        static int parseAction(const char *name);
+
+        void run();
+        void IRAM_ATTR onEdge(TriggerInput *input);
+
+    private:
+        void capture(TriggerInput &input, int64_t edge_us);
+
+        TriggerInput inputs[TRIGGER_MAX_INPUTS] = {};
+        int input_count = 0;
+        TaskHandle_t task = NULL;
+        portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+        // capture in progress
+        TriggerInput *active = nullptr;
+        int64_t active_edge_us = 0;
+        volatile bool frame_wanted = false;
+        volatile bool offering = false;     // the capture loop is in offerFrame()
+        volatile int frames_left = 0;
+        volatile int frames_taken = 0;
+
+        // statistics
+        uint32_t frames = 0;
+        uint32_t frames_pushed = 0;
+        uint32_t frames_published = 0;
+        uint32_t timeouts = 0;
+};
+
+void triggerTask(void *pvParameters);
+
+extern CLTriggers Triggers;
+
+#endif
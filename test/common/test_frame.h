@@ -0,0 +1,306 @@
+#ifndef test_frame_h
+#define test_frame_h
+
+#include <stdint.h>
+
+// 160x120 baseline JPEG, 4:2:2, standard Huffman tables, quality 90; encoded with libjpeg
+static const uint8_t test_frame[] = {
+    0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 0x4A, 0x46, 0x49, 0x46, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x01, 0x00, 0x00, 0xFF, 0xDB, 0x00, 0x43, 0x00, 0x03, 0x02, 0x02, 0x03, 0x02, 0x02, 0x03,
+    0x03, 0x03, 0x03, 0x04, 0x03, 0x03, 0x04, 0x05, 0x08, 0x05, 0x05, 0x04, 0x04, 0x05, 0x0A, 0x07,
+    0x07, 0x06, 0x08, 0x0C, 0x0A, 0x0C, 0x0C, 0x0B, 0x0A, 0x0B, 0x0B, 0x0D, 0x0E, 0x12, 0x10, 0x0D,
+    0x0E, 0x11, 0x0E, 0x0B, 0x0B, 0x10, 0x16, 0x10, 0x11, 0x13, 0x14, 0x15, 0x15, 0x15, 0x0C, 0x0F,
+    0x17, 0x18, 0x16, 0x14, 0x18, 0x12, 0x14, 0x15, 0x14, 0xFF, 0xDB, 0x00, 0x43, 0x01, 0x03, 0x04,
+    0x04, 0x05, 0x04, 0x05, 0x09, 0x05, 0x05, 0x09, 0x14, 0x0D, 0x0B, 0x0D, 0x14, 0x14, 0x14, 0x14,
+    0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+    0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+    0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0xFF, 0xC0,
+    0x00, 0x11, 0x08, 0x00, 0x78, 0x00, 0xA0, 0x03, 0x01, 0x21, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11,
+    0x01, 0xFF, 0xC4, 0x00, 0x1F, 0x00, 0x00, 0x01, 0x05, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+    0x0A, 0x0B, 0xFF, 0xC4, 0x00, 0xB5, 0x10, 0x00, 0x02, 0x01, 0x03, 0x03, 0x02, 0x04, 0x03, 0x05,
+    0x05, 0x04, 0x04, 0x00, 0x00, 0x01, 0x7D, 0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21,
+    0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23,
+    0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17,
+    0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A,
+    0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A,
+    0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A,
+    0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99,
+    0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7,
+    0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5,
+    0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1,
+    0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFF, 0xC4, 0x00, 0x1F, 0x01, 0x00, 0x03,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0xFF, 0xC4, 0x00, 0xB5, 0x11, 0x00,
+    0x02, 0x01, 0x02, 0x04, 0x04, 0x03, 0x04, 0x07, 0x05, 0x04, 0x04, 0x00, 0x01, 0x02, 0x77, 0x00,
+    0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13,
+    0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0, 0x15,
+    0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26, 0x27,
+    0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88,
+    0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6,
+    0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4,
+    0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE2,
+    0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9,
+    0xFA, 0xFF, 0xDA, 0x00, 0x0C, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3F, 0x00, 0xFC,
+    0xC5, 0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D, 0xAB, 0xFA, 0x57, 0xC3, 0x99, 0xFF, 0x00, 0xBD,
+    0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xE6, 0x55, 0xA9, 0xF0, 0xFC, 0xFF, 0x00, 0x43, 0x98, 0x8E,
+    0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D, 0xAB, 0x8F, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB,
+    0x9F, 0xFB, 0x79, 0xF4, 0x75, 0x2A, 0x7C, 0x3F, 0xD7, 0x63, 0x99, 0x8E, 0xD3, 0xDA, 0xBB, 0xA8,
+    0xED, 0x3D, 0xAB, 0x93, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4,
+    0x55, 0x2A, 0x7C, 0x3F, 0x3F, 0xD0, 0xE6, 0x63, 0xB4, 0xF6, 0xAE, 0xEE, 0x3B, 0x4F, 0x6A, 0xE3,
+    0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6, 0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x4A, 0x9F, 0x0F, 0xF5, 0xD8,
+    0xE6, 0x23, 0xB4, 0xF6, 0xAE, 0xEE, 0x3B, 0x4F, 0x6A, 0xE4, 0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6,
+    0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x5A, 0x9F, 0x0F, 0xCF, 0xF4, 0x39, 0x98, 0xED, 0x3D, 0xAB, 0xBA,
+    0x8E, 0xD3, 0xDA, 0xB8, 0xFC, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45,
+    0x52, 0xA7, 0xC3, 0xFD, 0x76, 0x39, 0x98, 0xED, 0x3D, 0xAB, 0xBA, 0x8E, 0xD3, 0xDA, 0xB9, 0x3C,
+    0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x52, 0xA7, 0xC3, 0xF3, 0xFD,
+    0x0E, 0x66, 0x3B, 0x4F, 0x6A, 0xEE, 0xE3, 0xB4, 0xF6, 0xAE, 0x3F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF,
+    0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1, 0x54, 0xA9, 0xF0, 0xFF, 0x00, 0x5D, 0x8E, 0x66, 0x3B, 0x4F,
+    0x6A, 0xEE, 0xA3, 0xB4, 0xF6, 0xAE, 0x4F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF, 0x00, 0x6E, 0x7F, 0xED,
+    0xE7, 0xD1, 0x55, 0xA9, 0xF0, 0xFC, 0xFF, 0x00, 0x43, 0x99, 0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED,
+    0x3D, 0xAB, 0x8F, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55,
+    0x2A, 0x7C, 0x3F, 0xD7, 0x63, 0xE5, 0x88, 0xED, 0x3D, 0xAB, 0x98, 0x8E, 0xD3, 0xDA, 0xBF, 0x59,
+    0xF1, 0x2E, 0x7F, 0xEE, 0x9F, 0xF6, 0xFF, 0x00, 0xFE, 0xD8, 0x7F, 0x97, 0x39, 0x65, 0x4D, 0xFE,
+    0x47, 0x77, 0x1D, 0xA7, 0xB5, 0x73, 0x31, 0xDA, 0x7B, 0x57, 0x1F, 0x89, 0x73, 0xFF, 0x00, 0x74,
+    0xFF, 0x00, 0xB7, 0xFF, 0x00, 0xF6, 0xC3, 0xE8, 0xB2, 0xCA, 0x9F, 0x17, 0xC8, 0xEE, 0xE3, 0xB4,
+    0xF6, 0xAE, 0x62, 0x2B, 0x4F, 0x6A, 0xE4, 0xF1, 0x2E, 0x7F, 0xEE, 0x9F, 0xF6, 0xFF, 0x00, 0xFE,
+    0xD8, 0x7D, 0x1E, 0x59, 0x53, 0x7F, 0x91, 0xDD, 0xC7, 0x69, 0xED, 0x5C, 0xCC, 0x76, 0x9E, 0xD5,
+    0xC7, 0xE2, 0x5C, 0xFF, 0x00, 0xDD, 0x3F, 0xED, 0xFF, 0x00, 0xFD, 0xB0, 0xFA, 0x2C, 0xB2, 0xA7,
+    0xC5, 0xF2, 0x3B, 0xA8, 0xED, 0x3D, 0xAB, 0x99, 0x8E, 0xD3, 0xDA, 0xB9, 0x3C, 0x4B, 0x9F, 0xFB,
+    0xA7, 0xFD, 0xBF, 0xFF, 0x00, 0xB6, 0x1F, 0x45, 0x96, 0x54, 0xDF, 0xE4, 0x77, 0x71, 0xDA, 0x7B,
+    0x57, 0x31, 0x1D, 0xA7, 0xB5, 0x71, 0xF8, 0x97, 0x3F, 0xF7, 0x4F, 0xFB, 0x7F, 0xFF, 0x00, 0x6C,
+    0x3E, 0x8B, 0x2C, 0xA9, 0xF1, 0x7C, 0x8E, 0xEE, 0x3B, 0x4F, 0x6A, 0xE6, 0x23, 0xB4, 0xF6, 0xAE,
+    0x4F, 0x12, 0xE7, 0xFE, 0xE9, 0xFF, 0x00, 0x6F, 0xFF, 0x00, 0xED, 0x87, 0xD1, 0x65, 0x95, 0x37,
+    0xF9, 0x1D, 0xDC, 0x76, 0x9E, 0xD5, 0xCC, 0xC7, 0x69, 0xED, 0x5C, 0x7E, 0x25, 0xCF, 0xFD, 0xD3,
+    0xFE, 0xDF, 0xFF, 0x00, 0xDB, 0x0F, 0xA2, 0xCB, 0x2A, 0x7C, 0x5F, 0x23, 0xBB, 0x8E, 0xD3, 0xDA,
+    0xB9, 0x88, 0xED, 0x3D, 0xAB, 0x93, 0xC4, 0xB9, 0xFF, 0x00, 0xBA, 0x7F, 0xDB, 0xFF, 0x00, 0xFB,
+    0x61, 0xF4, 0x59, 0x65, 0x4D, 0xFE, 0x47, 0x77, 0x1D, 0xA7, 0xB5, 0x73, 0x31, 0xDA, 0x7B, 0x57,
+    0x1F, 0x89, 0x73, 0xFF, 0x00, 0x74, 0xFF, 0x00, 0xB7, 0xFF, 0x00, 0xF6, 0xC3, 0xE8, 0xB2, 0xCA,
+    0x9F, 0x17, 0xC8, 0xF9, 0x62, 0x3B, 0x4F, 0x6A, 0xEE, 0xE2, 0xB4, 0xF6, 0xAF, 0xD6, 0x7C, 0x39,
+    0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0xE5, 0xCD, 0x5A, 0x9F, 0x0F, 0xCF, 0xF4,
+    0x39, 0x88, 0xED, 0x3D, 0xAB, 0xBB, 0x8A, 0xD3, 0xDA, 0xB8, 0xFC, 0x39, 0x9F, 0xFB, 0xDF, 0xFD,
+    0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x52, 0xA7, 0xC3, 0xFD, 0x76, 0x39, 0x98, 0xED, 0x3D, 0xAB,
+    0xBA, 0x8E, 0xD3, 0xDA, 0xB9, 0x3C, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F,
+    0x47, 0x52, 0xA7, 0xC3, 0xF3, 0xFD, 0x0E, 0x66, 0x3B, 0x4F, 0x6A, 0xEE, 0xE3, 0xB4, 0xF6, 0xAE,
+    0x3F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF, 0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1, 0x54, 0xA9, 0xF0, 0xFF,
+    0x00, 0x5D, 0x8E, 0x62, 0x3B, 0x4F, 0x6A, 0xEE, 0xE3, 0xB4, 0xF6, 0xAE, 0x4F, 0x0E, 0x67, 0xFE,
+    0xF7, 0xFF, 0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1, 0x55, 0xA9, 0xF0, 0xFC, 0xFF, 0x00, 0x43, 0x99,
+    0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D, 0xAB, 0x8F, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00,
+    0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x2A, 0x7C, 0x3F, 0xD7, 0x63, 0x98, 0x8E, 0xD3, 0xDA, 0xBB,
+    0xB8, 0xED, 0x3D, 0xAB, 0x93, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79,
+    0xF4, 0x55, 0x2A, 0x7C, 0x3F, 0x3F, 0xD0, 0xE6, 0x23, 0xB4, 0xF6, 0xAE, 0xEE, 0x3B, 0x4F, 0x6A,
+    0xE3, 0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6, 0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x4A, 0x9F, 0x0F, 0xF5,
+    0xD8, 0xE6, 0x63, 0xB4, 0xF6, 0xAE, 0xEA, 0x2B, 0x4F, 0x6A, 0xE4, 0xF0, 0xE6, 0x7F, 0xEF, 0x7F,
+    0xF6, 0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x5A, 0x9F, 0x0F, 0xCF, 0xF4, 0x39, 0x98, 0xED, 0x3D, 0xAB,
+    0xBB, 0x8A, 0xD3, 0xDA, 0xB8, 0xFC, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F,
+    0x45, 0x52, 0xA7, 0xC3, 0xFD, 0x76, 0x3E, 0x58, 0x8E, 0xD3, 0xDA, 0xB9, 0x98, 0xED, 0x3D, 0xAB,
+    0xF5, 0x9F, 0x12, 0xE7, 0xFE, 0xE9, 0xFF, 0x00, 0x6F, 0xFF, 0x00, 0xED, 0x87, 0xF9, 0x75, 0x96,
+    0x54, 0xDF, 0xE4, 0x77, 0x71, 0xDA, 0x7B, 0x57, 0x31, 0x1D, 0xA7, 0xB5, 0x71, 0xF8, 0x97, 0x3F,
+    0xF7, 0x4F, 0xFB, 0x7F, 0xFF, 0x00, 0x6C, 0x3E, 0x8B, 0x2C, 0xA9, 0xF1, 0x7C, 0x8E, 0xEE, 0x3B,
+    0x4F, 0x6A, 0xE6, 0x23, 0xB4, 0xF6, 0xAE, 0x4F, 0x12, 0xE7, 0xFE, 0xE9, 0xFF, 0x00, 0x6F, 0xFF,
+    0x00, 0xED, 0x87, 0xD1, 0x65, 0x95, 0x37, 0xF9, 0x1D, 0xDC, 0x76, 0x9E, 0xD5, 0xCC, 0xC7, 0x69,
+    0xED, 0x5C, 0x7E, 0x25, 0xCF, 0xFD, 0xD3, 0xFE, 0xDF, 0xFF, 0x00, 0xDB, 0x0F, 0xA2, 0xCB, 0x2A,
+    0x7C, 0x5F, 0x23, 0xBB, 0x8E, 0xD3, 0xDA, 0xB9, 0x88, 0xED, 0x3D, 0xAB, 0x93, 0xC4, 0xB9, 0xFF,
+    0x00, 0xBA, 0x7F, 0xDB, 0xFF, 0x00, 0xFB, 0x61, 0xF4, 0x59, 0x65, 0x4D, 0xFE, 0x47, 0x77, 0x1D,
+    0xA7, 0xB5, 0x73, 0x31, 0xDA, 0x7B, 0x57, 0x1F, 0x89, 0x73, 0xFF, 0x00, 0x74, 0xFF, 0x00, 0xB7,
+    0xFF, 0x00, 0xF6, 0xC3, 0xE8, 0xB2, 0xCA, 0x9F, 0x17, 0xC8, 0xEE, 0xA3, 0xB4, 0xF6, 0xAE, 0x66,
+    0x3B, 0x4F, 0x6A, 0xE4, 0xF1, 0x2E, 0x7F, 0xEE, 0x9F, 0xF6, 0xFF, 0x00, 0xFE, 0xD8, 0x7D, 0x16,
+    0x59, 0x53, 0x7F, 0x91, 0xDD, 0xC7, 0x69, 0xED, 0x5C, 0xC4, 0x76, 0x9E, 0xD5, 0xC7, 0xE2, 0x5C,
+    0xFF, 0x00, 0xDD, 0x3F, 0xED, 0xFF, 0x00, 0xFD, 0xB0, 0xFA, 0x2C, 0xB2, 0xA7, 0xC5, 0xF2, 0x3B,
+    0xB8, 0xED, 0x3D, 0xAB, 0x98, 0x8E, 0xD3, 0xDA, 0xB9, 0x3C, 0x4B, 0x9F, 0xFB, 0xA7, 0xFD, 0xBF,
+    0xFF, 0x00, 0xB6, 0x1F, 0x45, 0x96, 0x54, 0xDF, 0xE4, 0x77, 0x71, 0xDA, 0x7B, 0x57, 0x33, 0x1D,
+    0xA7, 0xB5, 0x71, 0xF8, 0x97, 0x3F, 0xF7, 0x4F, 0xFB, 0x7F, 0xFF, 0x00, 0x6C, 0x3E, 0x8B, 0x2C,
+    0xA9, 0xF1, 0x7C, 0x8F, 0x96, 0x23, 0xB4, 0xF6, 0xAE, 0xEE, 0x3B, 0x4F, 0x6A, 0xFD, 0x67, 0xC3,
+    0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xFE, 0x5C, 0xD4, 0xA9, 0xF0, 0xFC,
+    0xFF, 0x00, 0x43, 0x99, 0x8E, 0xD3, 0xDA, 0xBB, 0xA8, 0xED, 0x3D, 0xAB, 0x8F, 0xC3, 0x99, 0xFF,
+    0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x2A, 0x7C, 0x3F, 0xD7, 0x63, 0x99,
+    0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xAD, 0x3D, 0xAB, 0x93, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00,
+    0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x6A, 0x7C, 0x3F, 0x3F, 0xD0, 0xE6, 0x23, 0xB4, 0xF6, 0xAE,
+    0xEE, 0x3B, 0x4F, 0x6A, 0xE3, 0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6, 0xE7, 0xFE, 0xDE, 0x7D, 0x1D,
+    0x4A, 0x9F, 0x0F, 0xF5, 0xD8, 0xE6, 0x63, 0xB4, 0xF6, 0xAE, 0xEA, 0x3B, 0x4F, 0x6A, 0xE4, 0xF0,
+    0xE6, 0x7F, 0xEF, 0x7F, 0xF6, 0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x4A, 0x9F, 0x0F, 0xCF, 0xF4, 0x39,
+    0x98, 0xED, 0x3D, 0xAB, 0xBB, 0x8E, 0xD3, 0xDA, 0xB8, 0xFC, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9,
+    0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x52, 0xA7, 0xC3, 0xFD, 0x76, 0x39, 0x88, 0xED, 0x3D, 0xAB, 0xBB,
+    0x8E, 0xD3, 0xDA, 0xB9, 0x3C, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45,
+    0x56, 0xA7, 0xC3, 0xF3, 0xFD, 0x0E, 0x66, 0x3B, 0x4F, 0x6A, 0xEE, 0xA3, 0xB4, 0xF6, 0xAE, 0x3F,
+    0x0E, 0x67, 0xFE, 0xF7, 0xFF, 0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1, 0x54, 0xA9, 0xF0, 0xFF, 0x00,
+    0x5D, 0x8E, 0x66, 0x3B, 0x4F, 0x6A, 0xEE, 0xE3, 0xB4, 0xF6, 0xAE, 0x4F, 0x0E, 0x67, 0xFE, 0xF7,
+    0xFF, 0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1, 0x54, 0xA9, 0xF0, 0xFC, 0xFF, 0x00, 0x43, 0x98, 0x8E,
+    0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D, 0xAB, 0x8F, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB,
+    0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x2A, 0x7C, 0x3F, 0xD7, 0x63, 0xE5, 0x98, 0xED, 0x3D, 0xAB, 0x98,
+    0x8E, 0xD3, 0xDA, 0xBF, 0x59, 0xF1, 0x2E, 0x7F, 0xEE, 0x9F, 0xF6, 0xFF, 0x00, 0xFE, 0xD8, 0x7F,
+    0x97, 0x39, 0x65, 0x4D, 0xFE, 0x47, 0x77, 0x1D, 0xA7, 0xB5, 0x73, 0x11, 0xDA, 0x7B, 0x57, 0x1F,
+    0x89, 0x73, 0xFF, 0x00, 0x74, 0xFF, 0x00, 0xB7, 0xFF, 0x00, 0xF6, 0xC3, 0xE8, 0xB2, 0xCA, 0x9F,
+    0x17, 0xC8, 0xEE, 0xE3, 0xB4, 0xF6, 0xAE, 0x66, 0x3B, 0x4F, 0x6A, 0xE4, 0xF1, 0x2E, 0x7F, 0xEE,
+    0x9F, 0xF6, 0xFF, 0x00, 0xFE, 0xD8, 0x7D, 0x16, 0x59, 0x53, 0x7F, 0x91, 0xDD, 0xC7, 0x69, 0xED,
+    0x5C, 0xC4, 0x76, 0x9E, 0xD5, 0xC7, 0xE2, 0x5C, 0xFF, 0x00, 0xDD, 0x3F, 0xED, 0xFF, 0x00, 0xFD,
+    0xB0, 0xFA, 0x2C, 0xB2, 0xA7, 0xC5, 0xF2, 0x3B, 0xB8, 0xED, 0x3D, 0xAB, 0x98, 0x8A, 0xD3, 0xDA,
+    0xB9, 0x3C, 0x4B, 0x9F, 0xFB, 0xA7, 0xFD, 0xBF, 0xFF, 0x00, 0xB6, 0x1F, 0x47, 0x96, 0x54, 0xDF,
+    0xE4, 0x77, 0x71, 0xDA, 0x7B, 0x57, 0x33, 0x1D, 0xA7, 0xB5, 0x71, 0xF8, 0x97, 0x3F, 0xF7, 0x4F,
+    0xFB, 0x7F, 0xFF, 0x00, 0x6C, 0x3E, 0x8B, 0x2C, 0xA9, 0xF1, 0x7C, 0x8E, 0xEE, 0x3B, 0x4F, 0x6A,
+    0xE6, 0x23, 0xB4, 0xF6, 0xAE, 0x4F, 0x12, 0xE7, 0xFE, 0xE9, 0xFF, 0x00, 0x6F, 0xFF, 0x00, 0xED,
+    0x87, 0xD1, 0x65, 0x95, 0x37, 0xF9, 0x1D, 0xDC, 0x76, 0x9E, 0xD5, 0xCC, 0x47, 0x69, 0xED, 0x5C,
+    0x7E, 0x25, 0xCF, 0xFD, 0xD3, 0xFE, 0xDF, 0xFF, 0x00, 0xDB, 0x0F, 0xA2, 0xCB, 0x2A, 0x7C, 0x5F,
+    0x23, 0xBB, 0x8E, 0xD3, 0xDA, 0xB9, 0x98, 0xED, 0x3D, 0xAB, 0x93, 0xC4, 0xB9, 0xFF, 0x00, 0xBA,
+    0x7F, 0xDB, 0xFF, 0x00, 0xFB, 0x61, 0xF4, 0x59, 0x65, 0x4D, 0xFE, 0x47, 0x77, 0x1D, 0xA7, 0xB5,
+    0x73, 0x11, 0xDA, 0x7B, 0x57, 0x27, 0x89, 0x73, 0xFF, 0x00, 0x74, 0xFF, 0x00, 0xB7, 0xFF, 0x00,
+    0xF6, 0xC3, 0xE8, 0xB2, 0xCA, 0x9F, 0x17, 0xC8, 0xF9, 0x66, 0x3B, 0x4F, 0x6A, 0xEE, 0xA3, 0xB4,
+    0xF6, 0xAF, 0xD6, 0x3C, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0xE5, 0xD5,
+    0x4A, 0x9F, 0x0F, 0xCF, 0xF4, 0x39, 0x98, 0xED, 0x3D, 0xAB, 0xBB, 0x8E, 0xD3, 0xDA, 0xB8, 0xFC,
+    0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x52, 0xA7, 0xC3, 0xFD, 0x76,
+    0x39, 0x88, 0xED, 0x3D, 0xAB, 0xBB, 0x8E, 0xD3, 0xDA, 0xB9, 0x3C, 0x39, 0x9F, 0xFB, 0xDF, 0xFD,
+    0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x56, 0xA7, 0xC3, 0xF3, 0xFD, 0x0E, 0x62, 0x3B, 0x4F, 0x6A,
+    0xEE, 0xE3, 0xB4, 0xF6, 0xAE, 0x3F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF, 0x00, 0x6E, 0x7F, 0xED, 0xE7,
+    0xD1, 0x54, 0xA9, 0xF0, 0xFF, 0x00, 0x5D, 0x8E, 0x66, 0x3B, 0x4F, 0x6A, 0xEE, 0xE3, 0xB4, 0xF6,
+    0xAE, 0x4F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF, 0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1, 0x54, 0xA9, 0xF0,
+    0xFC, 0xFF, 0x00, 0x43, 0x98, 0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D, 0xAB, 0x8F, 0xC3, 0x99,
+    0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x2A, 0x7C, 0x3F, 0xD7, 0x63,
+    0x98, 0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D, 0xAB, 0x93, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF,
+    0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x6A, 0x7C, 0x3F, 0x3F, 0xD0, 0xE6, 0x63, 0xB4, 0xF6,
+    0xAE, 0xEE, 0x3B, 0x4F, 0x6A, 0xE3, 0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6, 0xE7, 0xFE, 0xDE, 0x7D,
+    0x15, 0x4A, 0x9F, 0x0F, 0xF5, 0xD8, 0xE6, 0x23, 0xB4, 0xF6, 0xAE, 0xEE, 0x3B, 0x4F, 0x6A, 0xE4,
+    0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6, 0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x4A, 0x9F, 0x0F, 0xCF, 0xF4,
+    0x39, 0x98, 0xED, 0x3D, 0xAB, 0xBA, 0x8E, 0xD3, 0xDA, 0xB8, 0xFC, 0x39, 0x9F, 0xFB, 0xDF, 0xFD,
+    0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x52, 0xA7, 0xC3, 0xFD, 0x76, 0x3E, 0x59, 0x8E, 0xD3, 0xDA,
+    0xB9, 0x88, 0xED, 0x3D, 0xAB, 0xF5, 0x9F, 0x12, 0xE7, 0xFE, 0xE9, 0xFF, 0x00, 0x6F, 0xFF, 0x00,
+    0xED, 0x87, 0xF9, 0x75, 0x96, 0x54, 0xDF, 0xE4, 0x77, 0x71, 0xDA, 0x7B, 0x57, 0x33, 0x1D, 0xA7,
+    0xB5, 0x71, 0xF8, 0x97, 0x3F, 0xF7, 0x4F, 0xFB, 0x7F, 0xFF, 0x00, 0x6C, 0x3E, 0x8B, 0x2C, 0xA9,
+    0xF1, 0x7C, 0x8E, 0xEA, 0x3B, 0x4F, 0x6A, 0xE6, 0x62, 0xB4, 0xF6, 0xAE, 0x4F, 0x12, 0xE7, 0xFE,
+    0xE9, 0xFF, 0x00, 0x6F, 0xFF, 0x00, 0xED, 0x87, 0xD1, 0x65, 0x95, 0x37, 0xF9, 0x1D, 0xDC, 0x56,
+    0x9E, 0xD5, 0xCC, 0x47, 0x69, 0xED, 0x5C, 0x7E, 0x25, 0xCF, 0xFD, 0xD3, 0xFE, 0xDF, 0xFF, 0x00,
+    0xDB, 0x0F, 0xA2, 0xCB, 0x2A, 0x7C, 0x5F, 0x23, 0xBB, 0x8E, 0xD3, 0xDA, 0xB9, 0x98, 0xED, 0x3D,
+    0xAB, 0x93, 0xC4, 0xB9, 0xFF, 0x00, 0xBA, 0x7F, 0xDB, 0xFF, 0x00, 0xFB, 0x61, 0xF4, 0x59, 0x65,
+    0x4D, 0xFE, 0x47, 0x75, 0x1D, 0xA7, 0xB5, 0x73, 0x31, 0xDA, 0x7B, 0x57, 0x1F, 0x89, 0x73, 0xFF,
+    0x00, 0x74, 0xFF, 0x00, 0xB7, 0xFF, 0x00, 0xF6, 0xC3, 0xE8, 0xB2, 0xCA, 0x9F, 0x17, 0xC8, 0xEE,
+    0xE3, 0xB4, 0xF6, 0xAE, 0x62, 0x3B, 0x4F, 0x6A, 0xE4, 0xF1, 0x2E, 0x7F, 0xEE, 0x9F, 0xF6, 0xFF,
+    0x00, 0xFE, 0xD8, 0x7D, 0x16, 0x59, 0x53, 0x7F, 0x91, 0xDD, 0xC7, 0x69, 0xED, 0x5C, 0xCC, 0x76,
+    0x9E, 0xD5, 0xC7, 0xE2, 0x5C, 0xFF, 0x00, 0xDD, 0x3F, 0xED, 0xFF, 0x00, 0xFD, 0xB0, 0xFA, 0x2C,
+    0xB2, 0xA7, 0xC5, 0xF2, 0x3B, 0xB8, 0xED, 0x3D, 0xAB, 0x98, 0x8E, 0xD3, 0xDA, 0xB9, 0x3C, 0x4B,
+    0x9F, 0xFB, 0xA7, 0xFD, 0xBF, 0xFF, 0x00, 0xB6, 0x1F, 0x45, 0x96, 0x54, 0xDF, 0xE4, 0x77, 0x71,
+    0xDA, 0x7B, 0x57, 0x31, 0x1D, 0xA7, 0xB5, 0x71, 0xF8, 0x97, 0x3F, 0xF7, 0x4F, 0xFB, 0x7F, 0xFF,
+    0x00, 0x6C, 0x3E, 0x8B, 0x2C, 0xA9, 0xF1, 0x7C, 0x8F, 0x96, 0x63, 0xB4, 0xF6, 0xAE, 0xEA, 0x3B,
+    0x4F, 0x6A, 0xFD, 0x67, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xFE,
+    0x5C, 0xD5, 0xA9, 0xF0, 0xFC, 0xFF, 0x00, 0x43, 0x99, 0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D,
+    0xAB, 0x8F, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x2A,
+    0x7C, 0x3F, 0xD7, 0x63, 0x98, 0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D, 0xAB, 0x93, 0xC3, 0x99,
+    0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x2A, 0x7C, 0x3F, 0x3F, 0xD0,
+    0xE6, 0x63, 0xB4, 0xF6, 0xAE, 0xEE, 0x3B, 0x4F, 0x6A, 0xE3, 0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6,
+    0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x4A, 0x9F, 0x0F, 0xF5, 0xD8, 0xE6, 0x23, 0xB4, 0xF6, 0xAE, 0xEE,
+    0x3B, 0x4F, 0x6A, 0xE4, 0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6, 0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x5A,
+    0x9F, 0x0F, 0xCF, 0xF4, 0x39, 0x88, 0xAD, 0x3D, 0xAB, 0xBB, 0x8E, 0xD3, 0xDA, 0xB8, 0xFC, 0x39,
+    0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x52, 0xA7, 0xC3, 0xFD, 0x76, 0x39,
+    0x98, 0xED, 0x3D, 0xAB, 0xBA, 0x8E, 0xD3, 0xDA, 0xB9, 0x3C, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9,
+    0xFF, 0x00, 0xB7, 0x9F, 0x47, 0x52, 0xA7, 0xC3, 0xF3, 0xFD, 0x0E, 0x66, 0x3B, 0x4F, 0x6A, 0xEE,
+    0xE3, 0xB4, 0xF6, 0xAE, 0x3F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF, 0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1,
+    0x54, 0xA9, 0xF0, 0xFF, 0x00, 0x5D, 0x8E, 0x62, 0x3B, 0x4F, 0x6A, 0xEE, 0xE3, 0xB4, 0xF6, 0xAE,
+    0x4F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF, 0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1, 0x55, 0xA9, 0xF0, 0xFC,
+    0xFF, 0x00, 0x43, 0x99, 0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D, 0xAB, 0x8F, 0xC3, 0x99, 0xFF,
+    0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x2A, 0x7C, 0x3F, 0xD7, 0x63, 0xE5,
+    0x88, 0xED, 0x3D, 0xAB, 0x98, 0x8E, 0xD3, 0xDA, 0xBF, 0x58, 0xF1, 0x2E, 0x7F, 0xEE, 0x9F, 0xF6,
+    0xFF, 0x00, 0xFE, 0xD8, 0x7F, 0x97, 0x59, 0x65, 0x4D, 0xFE, 0x47, 0x77, 0x1D, 0xA7, 0xB5, 0x73,
+    0x31, 0xDA, 0x7B, 0x57, 0x27, 0x89, 0x73, 0xFF, 0x00, 0x74, 0xFF, 0x00, 0xB7, 0xFF, 0x00, 0xF6,
+    0xC3, 0xE8, 0xB2, 0xCA, 0x9F, 0x17, 0xC8, 0xEE, 0xE3, 0xB4, 0xF6, 0xAE, 0x62, 0x3B, 0x4F, 0x6A,
+    0xE4, 0xF1, 0x2E, 0x7F, 0xEE, 0x9F, 0xF6, 0xFF, 0x00, 0xFE, 0xD8, 0x7D, 0x16, 0x59, 0x53, 0x7F,
+    0x91, 0xDD, 0xC7, 0x69, 0xED, 0x5C, 0xC4, 0x76, 0x9E, 0xD5, 0xC7, 0xE2, 0x5C, 0xFF, 0x00, 0xDD,
+    0x3F, 0xED, 0xFF, 0x00, 0xFD, 0xB0, 0xFA, 0x2C, 0xB2, 0xA7, 0xC5, 0xF2, 0x3B, 0xB8, 0xED, 0x3D,
+    0xAB, 0x99, 0x8E, 0xD3, 0xDA, 0xB9, 0x3C, 0x4B, 0x9F, 0xFB, 0xA7, 0xFD, 0xBF, 0xFF, 0x00, 0xB6,
+    0x1F, 0x45, 0x96, 0x54, 0xDF, 0xE4, 0x77, 0x71, 0xDA, 0x7B, 0x57, 0x31, 0x1D, 0xA7, 0xB5, 0x71,
+    0xF8, 0x97, 0x3F, 0xF7, 0x4F, 0xFB, 0x7F, 0xFF, 0x00, 0x6C, 0x3E, 0x8B, 0x2C, 0xA9, 0xF1, 0x7C,
+    0x8E, 0xEE, 0x3B, 0x4F, 0x6A, 0xE6, 0x23, 0xB4, 0xF6, 0xAE, 0x3F, 0x12, 0xE7, 0xFE, 0xE9, 0xFF,
+    0x00, 0x6F, 0xFF, 0x00, 0xED, 0x87, 0xD1, 0x65, 0x95, 0x37, 0xF9, 0x1D, 0xDC, 0x76, 0x9E, 0xD5,
+    0xCC, 0xC7, 0x69, 0xED, 0x5C, 0x9E, 0x25, 0xCF, 0xFD, 0xD3, 0xFE, 0xDF, 0xFF, 0x00, 0xDB, 0x0F,
+    0xA2, 0xCB, 0x2A, 0x7C, 0x5F, 0x23, 0xBB, 0x8E, 0xD3, 0xDA, 0xB9, 0x88, 0xED, 0x3D, 0xAB, 0x93,
+    0xC4, 0xB9, 0xFF, 0x00, 0xBA, 0x7F, 0xDB, 0xFF, 0x00, 0xFB, 0x61, 0xF4, 0x59, 0x65, 0x4D, 0xFE,
+    0x47, 0x77, 0x1D, 0xA7, 0xB5, 0x73, 0x31, 0xDA, 0x7B, 0x57, 0x1F, 0x89, 0x73, 0xFF, 0x00, 0x74,
+    0xFF, 0x00, 0xB7, 0xFF, 0x00, 0xF6, 0xC3, 0xE8, 0xB2, 0xCA, 0x9F, 0x17, 0xC8, 0xF9, 0x62, 0x3B,
+    0x4F, 0x6A, 0xEE, 0xE3, 0xB4, 0xF6, 0xAF, 0xD6, 0x7C, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF,
+    0x00, 0xB7, 0x9F, 0xE5, 0xD5, 0x5A, 0x9F, 0x0F, 0xCF, 0xF4, 0x39, 0x88, 0xED, 0x3D, 0xAB, 0xBB,
+    0x8E, 0xD3, 0xDA, 0xB8, 0xFC, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45,
+    0x52, 0xA7, 0xC3, 0xFD, 0x76, 0x39, 0x98, 0xED, 0x3D, 0xAB, 0xBA, 0x8E, 0xD3, 0xDA, 0xB9, 0x3C,
+    0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x52, 0xA7, 0xC3, 0xF3, 0xFD,
+    0x0E, 0x66, 0x3B, 0x4F, 0x6A, 0xEE, 0xE3, 0xB4, 0xF6, 0xAE, 0x3F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF,
+    0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1, 0x54, 0xA9, 0xF0, 0xFF, 0x00, 0x5D, 0x8E, 0x62, 0x3B, 0x4A,
+    0xEE, 0xE3, 0xB4, 0xF6, 0xAE, 0x3F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF, 0x00, 0x6E, 0x7F, 0xED, 0xE7,
+    0xD1, 0x55, 0xA9, 0xF0, 0xFC, 0xFF, 0x00, 0x43, 0x99, 0x8E, 0xD3, 0xDA, 0xBB, 0xA8, 0xED, 0x3D,
+    0xAB, 0x93, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x2A,
+    0x7C, 0x3F, 0xD7, 0x63, 0x99, 0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D, 0xAB, 0x93, 0xC3, 0x99,
+    0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x2A, 0x7C, 0x3F, 0x3F, 0xD0,
+    0xE6, 0x23, 0xB4, 0xF6, 0xAE, 0xEE, 0x3B, 0x4F, 0x6A, 0xE3, 0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6,
+    0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x4A, 0x9F, 0x0F, 0xF5, 0xD8, 0xE6, 0x63, 0xB4, 0xF6, 0xAE, 0xEA,
+    0x3B, 0x4F, 0x6A, 0xE4, 0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6, 0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x5A,
+    0x9F, 0x0F, 0xCF, 0xF4, 0x39, 0x98, 0xED, 0x3D, 0xAB, 0xBB, 0x8E, 0xD3, 0xDA, 0xB8, 0xFC, 0x39,
+    0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x52, 0xA7, 0xC3, 0xFD, 0x76, 0x3E,
+    0x58, 0x8E, 0xD3, 0xDA, 0xB9, 0x98, 0xED, 0x3D, 0xAB, 0xF5, 0x9F, 0x12, 0xE7, 0xFE, 0xE9, 0xFF,
+    0x00, 0x6F, 0xFF, 0x00, 0xED, 0x87, 0xF9, 0x75, 0x96, 0x54, 0xDF, 0xE4, 0x77, 0x71, 0xDA, 0x7B,
+    0x57, 0x31, 0x1D, 0xA7, 0xB5, 0x71, 0xF8, 0x97, 0x3F, 0xF7, 0x4F, 0xFB, 0x7F, 0xFF, 0x00, 0x6C,
+    0x3E, 0x8B, 0x2C, 0xA9, 0xF1, 0x7C, 0x8E, 0xEE, 0x3B, 0x4F, 0x6A, 0xE6, 0x23, 0xB4, 0xF6, 0xAE,
+    0x3F, 0x12, 0xE7, 0xFE, 0xE9, 0xFF, 0x00, 0x6F, 0xFF, 0x00, 0xED, 0x87, 0xD1, 0x65, 0x95, 0x37,
+    0xF9, 0x1D, 0xDC, 0x76, 0x9E, 0xD5, 0xCC, 0xC7, 0x69, 0xED, 0x5C, 0x9E, 0x25, 0xCF, 0xFD, 0xD3,
+    0xFE, 0xDF, 0xFF, 0x00, 0xDB, 0x0F, 0xA2, 0xCB, 0x2A, 0x7C, 0x5F, 0x23, 0xBB, 0x8E, 0xD3, 0xDA,
+    0xB9, 0x88, 0xED, 0x3D, 0xAB, 0x8F, 0xC4, 0xB9, 0xFF, 0x00, 0xBA, 0x7F, 0xDB, 0xFF, 0x00, 0xFB,
+    0x61, 0xF4, 0x59, 0x65, 0x4D, 0xFE, 0x47, 0x77, 0x1D, 0xA7, 0xB5, 0x73, 0x11, 0xDA, 0x7B, 0x57,
+    0x27, 0x89, 0x73, 0xFF, 0x00, 0x74, 0xFF, 0x00, 0xB7, 0xFF, 0x00, 0xF6, 0xC3, 0xE8, 0xB2, 0xCA,
+    0x9F, 0x17, 0xC8, 0xEE, 0xE3, 0xB4, 0xF6, 0xAE, 0x66, 0x3B, 0x4F, 0x6A, 0xE4, 0xF1, 0x2E, 0x7F,
+    0xEE, 0x9F, 0xF6, 0xFF, 0x00, 0xFE, 0xD8, 0x7D, 0x16, 0x59, 0x53, 0x7F, 0x91, 0xDD, 0xC7, 0x69,
+    0xED, 0x5C, 0xC4, 0x76, 0x9E, 0xD5, 0xC7, 0xE2, 0x5C, 0xFF, 0x00, 0xDD, 0x3F, 0xED, 0xFF, 0x00,
+    0xFD, 0xB0, 0xFA, 0x2C, 0xB2, 0xA7, 0xC5, 0xF2, 0x3B, 0xB8, 0xED, 0x3D, 0xAB, 0x98, 0x8E, 0xD3,
+    0xDA, 0xB8, 0xFC, 0x4B, 0x9F, 0xFB, 0xA7, 0xFD, 0xBF, 0xFF, 0x00, 0xB6, 0x1F, 0x45, 0x96, 0x54,
+    0xDF, 0xE4, 0x77, 0x71, 0xDA, 0x7B, 0x57, 0x33, 0x1D, 0xA7, 0xB5, 0x72, 0x78, 0x97, 0x3F, 0xF7,
+    0x4F, 0xFB, 0x7F, 0xFF, 0x00, 0x6C, 0x3E, 0x8B, 0x2C, 0xA9, 0xF1, 0x7C, 0x8F, 0x96, 0x23, 0xB4,
+    0xF6, 0xAE, 0xEE, 0x3B, 0x4F, 0x6A, 0xFD, 0x63, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB,
+    0x9F, 0xFB, 0x79, 0xFE, 0x5C, 0xD4, 0xA9, 0xF0, 0xFC, 0xFF, 0x00, 0x43, 0x99, 0x8E, 0xD3, 0xDA,
+    0xBB, 0xA8, 0xED, 0x3D, 0xAB, 0x93, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB,
+    0x79, 0xF4, 0x55, 0x2A, 0x7C, 0x3F, 0xD7, 0x63, 0x99, 0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D,
+    0xAB, 0x8F, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x6A,
+    0x7C, 0x3F, 0x3F, 0xD0, 0xE6, 0x23, 0xB4, 0xF6, 0xAE, 0xEE, 0x3B, 0x4F, 0x6A, 0xE4, 0xF0, 0xE6,
+    0x7F, 0xEF, 0x7F, 0xF6, 0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x4A, 0x9F, 0x0F, 0xF5, 0xD8, 0xE6, 0x63,
+    0xB4, 0xF6, 0xAE, 0xEA, 0x3B, 0x4F, 0x6A, 0xE4, 0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6, 0xE7, 0xFE,
+    0xDE, 0x7D, 0x15, 0x4A, 0x9F, 0x0F, 0xCF, 0xF4, 0x39, 0x98, 0xED, 0x3D, 0xAB, 0xBB, 0x8E, 0xD3,
+    0xDA, 0xB8, 0xFC, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x52, 0xA7,
+    0xC3, 0xFD, 0x76, 0x39, 0x88, 0xED, 0x3D, 0xAB, 0xBB, 0x8E, 0xD3, 0xDA, 0xB8, 0xFC, 0x39, 0x9F,
+    0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x56, 0xA7, 0xC3, 0xF3, 0xFD, 0x0E, 0x66,
+    0x3B, 0x4F, 0x6A, 0xEE, 0xA3, 0xB4, 0xF6, 0xAE, 0x4F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF, 0x00, 0x6E,
+    0x7F, 0xED, 0xE7, 0xD1, 0x54, 0xA9, 0xF0, 0xFF, 0x00, 0x5D, 0x8E, 0x66, 0x3B, 0x4F, 0x6A, 0xEE,
+    0xE3, 0xB4, 0xF6, 0xAE, 0x4F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF, 0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1,
+    0xD4, 0xA9, 0xF0, 0xFC, 0xFF, 0x00, 0x43, 0x98, 0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED, 0x3D, 0xAB,
+    0x8F, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55, 0x2A, 0x7C,
+    0x3F, 0xD7, 0x63, 0xE5, 0x98, 0xED, 0x3D, 0xAB, 0x98, 0x8E, 0xD3, 0xDA, 0xBF, 0x58, 0xF1, 0x2E,
+    0x7F, 0xEE, 0x9F, 0xF6, 0xFF, 0x00, 0xFE, 0xD8, 0x7F, 0x97, 0x59, 0x65, 0x4D, 0xFE, 0x47, 0x77,
+    0x1D, 0xA7, 0xB5, 0x73, 0x11, 0xDA, 0x7B, 0x57, 0x27, 0x89, 0x73, 0xFF, 0x00, 0x74, 0xFF, 0x00,
+    0xB7, 0xFF, 0x00, 0xF6, 0xC3, 0xE8, 0xB2, 0xCA, 0x9F, 0x17, 0xC8, 0xEE, 0xE3, 0xB4, 0xF6, 0xAE,
+    0x66, 0x3B, 0x4F, 0x6A, 0xE3, 0xF1, 0x2E, 0x7F, 0xEE, 0x9F, 0xF6, 0xFF, 0x00, 0xFE, 0xD8, 0x7D,
+    0x16, 0x59, 0x53, 0x7F, 0x91, 0xDD, 0x47, 0x69, 0xED, 0x5C, 0xCC, 0x76, 0x9E, 0xD5, 0xC9, 0xE2,
+    0x5C, 0xFF, 0x00, 0xDD, 0x3F, 0xED, 0xFF, 0x00, 0xFD, 0xB0, 0xFA, 0x2C, 0xB2, 0xA7, 0xC5, 0xF2,
+    0x3B, 0xB8, 0xED, 0x3D, 0xAB, 0x98, 0x8A, 0xD3, 0xDA, 0xB8, 0xFC, 0x4B, 0x9F, 0xFB, 0xA7, 0xFD,
+    0xBF, 0xFF, 0x00, 0xB6, 0x1F, 0x45, 0x96, 0x54, 0xDF, 0xE4, 0x77, 0x71, 0xDA, 0x7B, 0x57, 0x33,
+    0x1D, 0xA7, 0xB5, 0x72, 0x78, 0x97, 0x3F, 0xF7, 0x4F, 0xFB, 0x7F, 0xFF, 0x00, 0x6C, 0x3E, 0x8B,
+    0x2C, 0xA9, 0xF1, 0x7C, 0x8E, 0xEA, 0x3B, 0x4F, 0x6A, 0xE6, 0x63, 0xB4, 0xF6, 0xAE, 0x3F, 0x12,
+    0xE7, 0xFE, 0xE9, 0xFF, 0x00, 0x6F, 0xFF, 0x00, 0xED, 0x87, 0xD1, 0x65, 0x95, 0x37, 0xF9, 0x1D,
+    0xDC, 0x76, 0x9E, 0xD5, 0xCC, 0x47, 0x69, 0xED, 0x5C, 0x9E, 0x25, 0xCF, 0xFD, 0xD3, 0xFE, 0xDF,
+    0xFF, 0x00, 0xDB, 0x0F, 0xA2, 0xCB, 0x2A, 0x7C, 0x5F, 0x23, 0xBB, 0x8E, 0xD3, 0xDA, 0xB9, 0x98,
+    0xED, 0x3D, 0xAB, 0x93, 0xC4, 0xB9, 0xFF, 0x00, 0xBA, 0x7F, 0xDB, 0xFF, 0x00, 0xFB, 0x61, 0xF4,
+    0x59, 0x65, 0x4D, 0xFE, 0x47, 0x75, 0x1D, 0xA7, 0xB5, 0x73, 0x31, 0xDA, 0x7B, 0x57, 0x1F, 0x89,
+    0x73, 0xFF, 0x00, 0x74, 0xFF, 0x00, 0xB7, 0xFF, 0x00, 0xF6, 0xC3, 0xE8, 0xB2, 0xCA, 0x9F, 0x17,
+    0xC8, 0xF9, 0x62, 0x3B, 0x4F, 0x6A, 0xEE, 0xE3, 0xB4, 0xF6, 0xAF, 0xD6, 0x3C, 0x39, 0x9F, 0xFB,
+    0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0xE5, 0xD5, 0x4A, 0x9F, 0x0F, 0xCF, 0xF4, 0x39, 0x98,
+    0xED, 0x3D, 0xAB, 0xBB, 0x8E, 0xD3, 0xDA, 0xB9, 0x3C, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF,
+    0x00, 0xB7, 0x9F, 0x45, 0x52, 0xA7, 0xC3, 0xFD, 0x76, 0x39, 0x88, 0xED, 0x3D, 0xAB, 0xBB, 0x8A,
+    0xD3, 0xDA, 0xB8, 0xFC, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x56,
+    0xA7, 0xC3, 0xF3, 0xFD, 0x0E, 0x62, 0x3B, 0x4F, 0x6A, 0xEE, 0xE2, 0xB4, 0xF6, 0xAE, 0x4F, 0x0E,
+    0x67, 0xFE, 0xF7, 0xFF, 0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1, 0x54, 0xA9, 0xF0, 0xFF, 0x00, 0x5D,
+    0x8E, 0x66, 0x3B, 0x4F, 0x6A, 0xEE, 0xE3, 0xB4, 0xF6, 0xAE, 0x3F, 0x0E, 0x67, 0xFE, 0xF7, 0xFF,
+    0x00, 0x6E, 0x7F, 0xED, 0xE7, 0xD1, 0x54, 0xA9, 0xF0, 0xFC, 0xFF, 0x00, 0x43, 0x98, 0x8E, 0xD3,
+    0xDA, 0xBB, 0xB8, 0xED, 0x3D, 0xAB, 0x93, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F,
+    0xFB, 0x79, 0xF4, 0x55, 0x2A, 0x7C, 0x3F, 0xD7, 0x63, 0x98, 0x8E, 0xD3, 0xDA, 0xBB, 0xB8, 0xED,
+    0x3D, 0xAB, 0x93, 0xC3, 0x99, 0xFF, 0x00, 0xBD, 0xFF, 0x00, 0xDB, 0x9F, 0xFB, 0x79, 0xF4, 0x55,
+    0x6A, 0x7C, 0x3F, 0x3F, 0xD0, 0xE6, 0x63, 0xB4, 0xF6, 0xAE, 0xEE, 0x3B, 0x4F, 0x6A, 0xE3, 0xF0,
+    0xE6, 0x7F, 0xEF, 0x7F, 0xF6, 0xE7, 0xFE, 0xDE, 0x7D, 0x15, 0x4A, 0x9F, 0x0F, 0xF5, 0xD8, 0xE6,
+    0x23, 0xB4, 0xF6, 0xAE, 0xEE, 0x3B, 0x4F, 0x6A, 0xE4, 0xF0, 0xE6, 0x7F, 0xEF, 0x7F, 0xF6, 0xE7,
+    0xFE, 0xDE, 0x7D, 0x15, 0x4A, 0x9F, 0x0F, 0xCF, 0xF4, 0x39, 0x88, 0xED, 0x3D, 0xAB, 0xBB, 0x8E,
+    0xD3, 0xDA, 0xB8, 0xFC, 0x39, 0x9F, 0xFB, 0xDF, 0xFD, 0xB9, 0xFF, 0x00, 0xB7, 0x9F, 0x45, 0x52,
+    0xA7, 0xC3, 0xFD, 0x76, 0x3F, 0xFF, 0xD9,
+};
+
+#endif
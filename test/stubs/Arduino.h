@@ -0,0 +1,52 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+// host build of the hardware independent modules: the parts of the Arduino core they use
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+#include <esp_system.h>
+
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define IRAM_ATTR
+
+// the host tests run on a single thread
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+typedef std::string String;
+
+/// @brief clock of the host build, set by the tests
+inline unsigned long &stubMillis() {static unsigned long now = 0; return now;}
+inline unsigned long millis() {return stubMillis();}
+
+inline bool psramFound() {return false;}
+inline void *ps_malloc(size_t size) {return malloc(size);}
+
+class IPAddress {
+    public:
+        IPAddress(uint32_t addr = 0) : addr(addr) {};
+        String toString() const {
+            char buf[16];
+            snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (unsigned)(addr & 0xFF), (unsigned)((addr >> 8) & 0xFF),
+                     (unsigned)((addr >> 16) & 0xFF), (unsigned)(addr >> 24));
+            return buf;
+        }
+        bool operator==(const IPAddress &other) const {return addr == other.addr;};
+
+    private:
+        uint32_t addr;
+};
+
+#endif
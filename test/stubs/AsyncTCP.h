@@ -0,0 +1,39 @@
+#ifndef AsyncTCP_h
+#define AsyncTCP_h
+
+#include <Arduino.h>
+#include <vector>
+
+#define ASYNC_WRITEFLAG_COPY    0x01
+
+/**
+ * @brief Connection of the host tests: keeps what is sent, the test opens the TCP window with ack()
+ *
+ */
+class AsyncClient {
+    public:
+        bool connected() {return is_connected;};
+        size_t space() {return window;};
+        size_t add(const char *data, size_t size, uint8_t apiflags = ASYNC_WRITEFLAG_COPY) {
+            size_t n = min(size, window);
+            output.insert(output.end(), data, data + n);
+            window -= n;
+            adds++;
+            return n;
+        }
+        bool send() {sends++; return true;};
+        void close(bool now = false) {is_connected = false;};
+
+        IPAddress remoteIP() {return IPAddress(0x0100007F);};
+        uint16_t remotePort() {return 50000;};
+
+        void ack(size_t len) {window += len;};
+
+        std::vector<uint8_t> output;
+        size_t window = 5744;
+        bool is_connected = true;
+        int adds = 0;
+        int sends = 0;
+};
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef esp32_hal_ledc_h
+#define esp32_hal_ledc_h
+
+// the host tests only use the declarations of esp32pwm.h, not the LEDC driver
+
+#endif
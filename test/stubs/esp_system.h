@@ -0,0 +1,10 @@
+#ifndef esp_system_h
+#define esp_system_h
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// host build of the hardware independent modules
+static inline uint32_t esp_random() {return ((uint32_t)rand() << 16) ^ (uint32_t)rand();}
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef semphr_h
+#define semphr_h
+
+// the host tests run on one thread
+typedef void *SemaphoreHandle_t;
+
+#define portMAX_DELAY                       0xFFFFFFFF
+#define xSemaphoreCreateMutex()             ((SemaphoreHandle_t)1)
+#define vSemaphoreDelete(sem)               ((void)(sem))
+#define xSemaphoreTake(sem, ticks)          ((void)(sem), 1)
+#define xSemaphoreGive(sem)                 ((void)(sem), 1)
+
+#endif
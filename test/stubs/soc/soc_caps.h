@@ -0,0 +1,9 @@
+#ifndef soc_caps_h
+#define soc_caps_h
+
+// ESP32
+#define SOC_GPIO_PIN_COUNT              40
+#define SOC_LEDC_CHANNEL_NUM            8
+#define SOC_LEDC_TIMER_BIT_WIDE_NUM     20
+
+#endif
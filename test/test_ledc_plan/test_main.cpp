@@ -0,0 +1,155 @@
+#include <unity.h>
+#include "ledc_plan.h"
+
+#define SERVO_FREQ      50
+#define SERVO_BITS      16
+#define LAMP_FREQ       50000
+#define LAMP_BITS       10
+
+// the outputs on one timer share its frequency and resolution, and no channel is given twice
+static void checkPlan(CLLedcPlanner &planner, const uint32_t *freqs, const uint8_t *bits, int count,
+                      bool camera_reserved) {
+    for(int i = 0; i < count; i++) {
+        int a = planner.getChannel(i);
+        if(a < 0) continue;
+        TEST_ASSERT_TRUE(a < NUM_PWM);
+        if(camera_reserved) TEST_ASSERT_TRUE(a / LEDC_TIMER_CHANNELS != LEDC_CAMERA_TIMER);
+        for(int j = i + 1; j < count; j++) {
+            int b = planner.getChannel(j);
+            if(b < 0) continue;
+            TEST_ASSERT_TRUE(a != b);
+            if(a / LEDC_TIMER_CHANNELS == b / LEDC_TIMER_CHANNELS) {
+                TEST_ASSERT_EQUAL_UINT32(freqs[i], freqs[j]);
+                TEST_ASSERT_EQUAL(bits[i], bits[j]);
+            }
+        }
+    }
+}
+
+void test_servos_and_lamp() {
+    // in the order of the config: a servo, the lamp, more servos
+    static const uint32_t freqs[] = {SERVO_FREQ, LAMP_FREQ, SERVO_FREQ, SERVO_FREQ, SERVO_FREQ};
+    static const uint8_t bits[] = {SERVO_BITS, LAMP_BITS, SERVO_BITS, SERVO_BITS, SERVO_BITS};
+    CLLedcPlanner planner;
+    for(int i = 0; i < 5; i++) TEST_ASSERT_EQUAL(i, planner.add(freqs[i], bits[i]));
+
+    TEST_ASSERT_EQUAL(0, planner.plan());
+    checkPlan(planner, freqs, bits, 5, false);
+    // the pairs of servos fill a timer each, the lamp gets the next one
+    TEST_ASSERT_EQUAL(0, planner.getChannel(0));
+    TEST_ASSERT_EQUAL(1, planner.getChannel(2));
+    TEST_ASSERT_EQUAL(2, planner.getChannel(3));
+    TEST_ASSERT_EQUAL(3, planner.getChannel(4));
+    TEST_ASSERT_EQUAL(4, planner.getChannel(1));
+}
+
+void test_camera_timer() {
+    // the lamp and six servos next to the camera clock on high speed timer 0
+    static const uint32_t freqs[] = {LAMP_FREQ, SERVO_FREQ, SERVO_FREQ, SERVO_FREQ, SERVO_FREQ, SERVO_FREQ, SERVO_FREQ};
+    static const uint8_t bits[] = {LAMP_BITS, SERVO_BITS, SERVO_BITS, SERVO_BITS, SERVO_BITS, SERVO_BITS, SERVO_BITS};
+    CLLedcPlanner planner;
+    planner.reserveTimer(LEDC_CAMERA_TIMER);
+    for(int i = 0; i < 7; i++) planner.add(freqs[i], bits[i]);
+
+    TEST_ASSERT_EQUAL(0, planner.plan());
+    checkPlan(planner, freqs, bits, 7, true);
+    for(int i = 1; i < 7; i++) TEST_ASSERT_EQUAL(i + 1, planner.getChannel(i));
+    TEST_ASSERT_EQUAL(8, planner.getChannel(0));
+
+    // planning again gives the same channels
+    TEST_ASSERT_EQUAL(0, planner.plan());
+    TEST_ASSERT_EQUAL(8, planner.getChannel(0));
+    TEST_ASSERT_EQUAL(2, planner.getChannel(1));
+}
+
+void test_overflow() {
+    // 7 free timers: 7 other frequencies and 7 servos need 4 timers more
+    uint32_t freqs[14];
+    uint8_t bits[14];
+    CLLedcPlanner planner;
+    planner.reserveTimer(LEDC_CAMERA_TIMER);
+    for(int i = 0; i < 7; i++) {
+        freqs[i] = 1000 * (i + 1);
+        bits[i] = 8;
+        freqs[7 + i] = SERVO_FREQ;
+        bits[7 + i] = SERVO_BITS;
+    }
+    for(int i = 0; i < 14; i++) TEST_ASSERT_EQUAL(i, planner.add(freqs[i], bits[i]));
+
+    TEST_ASSERT_EQUAL(4, planner.plan());
+    checkPlan(planner, freqs, bits, 14, true);
+    int placed = 0;
+    for(int i = 0; i < 14; i++)
+        if(planner.getChannel(i) >= 0) placed++;
+    TEST_ASSERT_EQUAL(10, placed);
+    // the pairs of servos come first
+    for(int i = 7; i < 13; i++) TEST_ASSERT_TRUE(planner.getChannel(i) >= 0);
+
+    TEST_ASSERT_EQUAL(0, planner.getCapacity(SERVO_FREQ, SERVO_BITS));
+    TEST_ASSERT_EQUAL(-1, planner.allocate(SERVO_FREQ, SERVO_BITS));
+}
+
+void test_impossible() {
+    CLLedcPlanner planner;
+    // 50 kHz leaves 10 bits of resolution at the 80 MHz clock
+    TEST_ASSERT_EQUAL(-1, planner.add(LAMP_FREQ, 12));
+    TEST_ASSERT_EQUAL(-1, planner.add(0, 8));
+    TEST_ASSERT_EQUAL(-1, planner.add(SERVO_FREQ, 21));
+    TEST_ASSERT_EQUAL(0, planner.add(LAMP_FREQ, LAMP_BITS));
+    TEST_ASSERT_EQUAL(0, planner.getCapacity(LAMP_FREQ, 12));
+    TEST_ASSERT_EQUAL(-1, planner.getChannel(1));
+    TEST_ASSERT_EQUAL(-1, planner.getChannel(-1));
+}
+
+void test_allocate_after_plan() {
+    CLLedcPlanner planner;
+    planner.reserveTimer(LEDC_CAMERA_TIMER);
+    planner.add(LAMP_FREQ, LAMP_BITS);
+    for(int i = 0; i < 6; i++) planner.add(SERVO_FREQ, SERVO_BITS);
+    TEST_ASSERT_EQUAL(0, planner.plan());
+
+    // the lamp timer has a free channel, the servo timers are full
+    TEST_ASSERT_EQUAL(7, planner.getCapacity(LAMP_FREQ, LAMP_BITS));
+    TEST_ASSERT_EQUAL(6, planner.getCapacity(SERVO_FREQ, SERVO_BITS));
+    TEST_ASSERT_EQUAL(6, planner.getCapacity(1000, 8));
+
+    TEST_ASSERT_EQUAL(9, planner.allocate(LAMP_FREQ, LAMP_BITS));
+    TEST_ASSERT_EQUAL(10, planner.allocate(SERVO_FREQ, SERVO_BITS));
+    TEST_ASSERT_EQUAL(11, planner.allocate(SERVO_FREQ, SERVO_BITS));
+    // the planned channels did not move
+    TEST_ASSERT_EQUAL(8, planner.getChannel(0));
+    for(int i = 1; i < 7; i++) TEST_ASSERT_EQUAL(i + 1, planner.getChannel(i));
+
+    TEST_ASSERT_EQUAL(4, planner.getCapacity(LAMP_FREQ, LAMP_BITS));
+    TEST_ASSERT_EQUAL(12, planner.allocate(1000, 8));
+    TEST_ASSERT_EQUAL(14, planner.allocate(2000, 8));
+    // no free timer left for a third frequency, but a channel next to the 1 kHz output
+    TEST_ASSERT_EQUAL(-1, planner.allocate(3000, 8));
+    TEST_ASSERT_EQUAL(13, planner.allocate(1000, 8));
+    TEST_ASSERT_EQUAL(1, planner.getCapacity(2000, 8));
+    TEST_ASSERT_EQUAL(0, planner.getCapacity(SERVO_FREQ, SERVO_BITS));
+}
+
+void test_capacity_limit() {
+    // the free channels, but no more than the outputs left
+    CLLedcPlanner planner;
+    TEST_ASSERT_EQUAL(NUM_PWM, planner.getCapacity(SERVO_FREQ, SERVO_BITS));
+    for(int i = 0; i < NUM_PWM; i++) planner.add(SERVO_FREQ, SERVO_BITS);
+    TEST_ASSERT_EQUAL(0, planner.plan());
+    TEST_ASSERT_EQUAL(0, planner.getCapacity(SERVO_FREQ, SERVO_BITS));
+    TEST_ASSERT_EQUAL(-1, planner.add(SERVO_FREQ, SERVO_BITS));
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_servos_and_lamp);
+    RUN_TEST(test_camera_timer);
+    RUN_TEST(test_overflow);
+    RUN_TEST(test_impossible);
+    RUN_TEST(test_allocate_after_plan);
+    RUN_TEST(test_capacity_limit);
+    return UNITY_END();
+}
@@ -0,0 +1,119 @@
+#include <string.h>
+#include <unity.h>
+#include "mqtt_message.h"
+
+static const uint8_t jpeg[] = {0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00, 0xFF, 0xD9};
+
+// /status of the camera, before and after a change of the quality, one second later
+static const char status_before[] =
+    "{\"framesize\":8,\"quality\":12,\"lamp\":0,\"local_time\":\"2023-01-07 19:20:31\",\"up_time\":\"0d 00:03:36\","
+    "\"pwm\":[{\"pin\":4,\"freq\":50000}],\"streams\":0}";
+static const char status_after[] =
+    "{\"framesize\":8,\"quality\":10,\"lamp\":0,\"local_time\":\"2023-01-07 19:20:32\",\"up_time\":\"0d 00:03:37\","
+    "\"pwm\":[{\"pin\":4,\"freq\":50000}],\"streams\":0}";
+
+void test_controls() {
+    // the image and the lamp
+    TEST_ASSERT_TRUE(isMqttControl("framesize"));
+    TEST_ASSERT_TRUE(isMqttControl("quality"));
+    TEST_ASSERT_TRUE(isMqttControl("frame_rate"));
+    TEST_ASSERT_TRUE(isMqttControl("lamp"));
+    TEST_ASSERT_TRUE(isMqttControl("flashlamp"));
+
+    // not the network, the credentials, the system or the outputs
+    TEST_ASSERT_FALSE(isMqttControl("ssid"));
+    TEST_ASSERT_FALSE(isMqttControl("password"));
+    TEST_ASSERT_FALSE(isMqttControl("ota_password"));
+    TEST_ASSERT_FALSE(isMqttControl("reboot"));
+    TEST_ASSERT_FALSE(isMqttControl("save_prefs"));
+    TEST_ASSERT_FALSE(isMqttControl("cmdout"));
+
+    // whole names only
+    TEST_ASSERT_FALSE(isMqttControl(""));
+    TEST_ASSERT_FALSE(isMqttControl("lam"));
+    TEST_ASSERT_FALSE(isMqttControl("lamps"));
+    TEST_ASSERT_FALSE(isMqttControl("Quality"));
+}
+
+void test_status_delta() {
+    JsonDocument before, after, delta;
+    deserializeJson(before, status_before);
+    deserializeJson(after, status_after);
+
+    // the first status after connecting is complete, the clock included
+    TEST_ASSERT_EQUAL(7, buildStatusDelta(before.as<JsonObjectConst>(), JsonObjectConst(), delta, true));
+    TEST_ASSERT_TRUE(delta["local_time"].is<const char*>());
+
+    // nothing changed but the clock
+    JsonDocument ticked;
+    deserializeJson(ticked, status_before);
+    ticked["up_time"] = "0d 00:03:37";
+    TEST_ASSERT_EQUAL(0, buildStatusDelta(ticked.as<JsonObjectConst>(), before.as<JsonObjectConst>(), delta, false));
+
+    // only the changed value
+    TEST_ASSERT_EQUAL(1, buildStatusDelta(after.as<JsonObjectConst>(), before.as<JsonObjectConst>(), delta, false));
+    TEST_ASSERT_EQUAL(10, delta["quality"].as<int>());
+
+    // a new value, and a change deep in an array
+    after["streams"] = 1;
+    after["pwm"][0]["freq"] = 1000;
+    after["rssi"] = -60;
+    TEST_ASSERT_EQUAL(4, buildStatusDelta(after.as<JsonObjectConst>(), before.as<JsonObjectConst>(), delta, false));
+    TEST_ASSERT_EQUAL(1000, delta["pwm"][0]["freq"].as<int>());
+    TEST_ASSERT_EQUAL(-60, delta["rssi"].as<int>());
+}
+
+void test_payload_ownership() {
+    MqttMessage msg = {"event/test", nullptr, 0, false, false, false, nullptr};
+    msg.payload = strdup("{\"a\":1}");
+    msg.len = 7;
+    TEST_ASSERT_EQUAL_PTR(msg.payload, msg.getData());
+
+    // the payload is freed once; a released message is empty
+    msg.release();
+    TEST_ASSERT_NULL(msg.getData());
+    TEST_ASSERT_EQUAL(0, msg.len);
+    msg.release();
+
+    // a wake up message has nothing to free
+    MqttMessage wake = {"", nullptr, 0, false, false, false, nullptr};
+    TEST_ASSERT_NULL(wake.getData());
+    wake.release();
+}
+
+void test_shared_frame() {
+    SharedFrame *frame = SharedFrame::create(jpeg, sizeof(jpeg));
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_EQUAL(1, frame->getRefCount());
+
+    // each queued message holds its own reference to the single copy
+    MqttMessage first = {"trigger/jpeg", nullptr, 0, false, true, false, nullptr};
+    MqttMessage second = first;
+    first.setFrame(frame);
+    second.setFrame(frame);
+    TEST_ASSERT_EQUAL(3, frame->getRefCount());
+    TEST_ASSERT_EQUAL(sizeof(jpeg), first.len);
+    TEST_ASSERT_EQUAL_PTR(frame->getBuffer(), first.getData());
+    TEST_ASSERT_EQUAL_MEMORY(jpeg, second.getData(), sizeof(jpeg));
+
+    // the producer lets its reference go; the frame lives on until the last message is published
+    frame->release();
+    first.release();
+    TEST_ASSERT_NULL(first.getData());
+    TEST_ASSERT_EQUAL(1, frame->getRefCount());
+    TEST_ASSERT_EQUAL_MEMORY(jpeg, second.getData(), sizeof(jpeg));
+    second.release();
+    TEST_ASSERT_NULL(second.getData());
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_controls);
+    RUN_TEST(test_status_delta);
+    RUN_TEST(test_payload_ownership);
+    RUN_TEST(test_shared_frame);
+    return UNITY_END();
+}
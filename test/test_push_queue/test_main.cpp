@@ -0,0 +1,214 @@
+#include <string.h>
+#include <string>
+#include <unity.h>
+#include "push_queue.h"
+
+#define SLOT_SIZE 64
+
+static const uint8_t jpeg[] = {0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00, 0xFF, 0xD9};
+
+/// @brief frame of the test: its bytes all hold its number
+static void pushNumbered(PushQueue &queue, uint8_t number, size_t len = 16) {
+    uint8_t frame[SLOT_SIZE];
+    memset(frame, number, len);
+    TEST_ASSERT_EQUAL(OS_SUCCESS, queue.push(frame, len));
+}
+
+static uint8_t takeNumbered(PushQueue &queue) {
+    int slot = queue.take();
+    TEST_ASSERT_TRUE(slot >= 0);
+    uint8_t number = queue.getSlot(slot).data[0];
+    queue.release(slot);
+    return number;
+}
+
+void test_drop_oldest() {
+    static PushQueue queue;
+    TEST_ASSERT_EQUAL(3, queue.begin(3, SLOT_SIZE));
+
+    for(uint8_t i = 1; i <= 5; i++) pushNumbered(queue, i);
+    // the frames 1 and 2 made room for 4 and 5
+    TEST_ASSERT_EQUAL(2, queue.getDropped());
+    TEST_ASSERT_EQUAL(3, queue.getQueued());
+
+    TEST_ASSERT_EQUAL(3, takeNumbered(queue));
+    TEST_ASSERT_EQUAL(4, takeNumbered(queue));
+    TEST_ASSERT_EQUAL(5, takeNumbered(queue));
+    TEST_ASSERT_EQUAL(-1, queue.take());
+}
+
+void test_sending_kept() {
+    static PushQueue queue;
+    queue.begin(2, SLOT_SIZE);
+
+    pushNumbered(queue, 1);
+    pushNumbered(queue, 2);
+    int sending = queue.take();
+    TEST_ASSERT_EQUAL(1, queue.getSlot(sending).data[0]);
+
+    // the frame being sent is not dropped, the queued one is
+    pushNumbered(queue, 3);
+    TEST_ASSERT_EQUAL(1, queue.getDropped());
+    TEST_ASSERT_EQUAL(1, queue.getSlot(sending).data[0]);
+
+    // nothing can make room while both are sent
+    int other = queue.take();
+    TEST_ASSERT_EQUAL(3, queue.getSlot(other).data[0]);
+    uint8_t frame[16] = {4};
+    TEST_ASSERT_EQUAL(OS_FAIL, queue.push(frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(2, queue.getDropped());
+
+    queue.release(sending);
+    queue.release(other);
+    TEST_ASSERT_EQUAL(0, queue.getQueued());
+}
+
+void test_oversize() {
+    static PushQueue queue;
+    queue.begin(2, SLOT_SIZE);
+
+    uint8_t frame[SLOT_SIZE + 1] = {0};
+    TEST_ASSERT_EQUAL(OS_FAIL, queue.push(frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(1, queue.getOversize());
+    TEST_ASSERT_EQUAL(0, queue.getDropped());
+    TEST_ASSERT_EQUAL(0, queue.getQueued());
+
+    // a shared frame is not copied into the slot
+    SharedFrame *shared = SharedFrame::create(frame, sizeof(frame));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, queue.push(shared->getBuffer(), shared->getSize(), shared));
+    shared->release();
+    int slot = queue.take();
+    TEST_ASSERT_EQUAL(SLOT_SIZE + 1, queue.getSlot(slot).len);
+    queue.release(slot);
+}
+
+void test_shared_frame() {
+    static PushQueue queue;
+    queue.begin(2, SLOT_SIZE);
+
+    SharedFrame *frame = SharedFrame::create(jpeg, sizeof(jpeg));
+    TEST_ASSERT_EQUAL(OS_SUCCESS, queue.push(frame->getBuffer(), frame->getSize(), frame));
+    TEST_ASSERT_EQUAL(2, frame->getRefCount());
+
+    int slot = queue.take();
+    TEST_ASSERT_EQUAL_PTR(frame->getBuffer(), queue.getSlot(slot).data);
+    TEST_ASSERT_EQUAL(sizeof(jpeg), queue.getSlot(slot).len);
+
+    // a failed upload keeps the reference
+    queue.release(slot, true);
+    TEST_ASSERT_EQUAL(2, frame->getRefCount());
+    TEST_ASSERT_EQUAL(1, queue.getQueued());
+
+    slot = queue.take();
+    queue.release(slot);
+    TEST_ASSERT_EQUAL(1, frame->getRefCount());
+    TEST_ASSERT_NULL(queue.getSlot(slot).frame);
+
+    // a dropped frame gives its reference back
+    queue.push(frame->getBuffer(), frame->getSize(), frame);
+    pushNumbered(queue, 1);
+    pushNumbered(queue, 2);
+    TEST_ASSERT_EQUAL(1, queue.getDropped());
+    TEST_ASSERT_EQUAL(1, frame->getRefCount());
+    TEST_ASSERT_EQUAL(1, takeNumbered(queue));
+    TEST_ASSERT_EQUAL(2, takeNumbered(queue));
+    frame->release();
+}
+
+void test_requeue() {
+    static PushQueue queue;
+    queue.begin(3, SLOT_SIZE);
+
+    pushNumbered(queue, 1);
+    pushNumbered(queue, 2);
+    int slot = queue.take();
+    queue.release(slot, true);
+    // the frame which failed goes out first again
+    TEST_ASSERT_EQUAL(1, takeNumbered(queue));
+    TEST_ASSERT_EQUAL(2, takeNumbered(queue));
+}
+
+void test_reset() {
+    static PushQueue queue;
+    queue.begin(3, SLOT_SIZE);
+
+    SharedFrame *frame = SharedFrame::create(jpeg, sizeof(jpeg));
+    pushNumbered(queue, 1);
+    int sending = queue.take();
+    queue.push(frame->getBuffer(), frame->getSize(), frame);
+    pushNumbered(queue, 2);
+
+    queue.reset();
+    TEST_ASSERT_EQUAL(0, queue.getQueued());
+    TEST_ASSERT_EQUAL(1, frame->getRefCount());
+    TEST_ASSERT_EQUAL(-1, queue.take());
+    // the frame being sent is left to the sender
+    TEST_ASSERT_EQUAL(SLOT_SENDING, queue.getSlot(sending).state);
+    queue.release(sending);
+    frame->release();
+}
+
+/// @brief appends a frame of the stream as sendStreamFrame writes it
+static void writeStreamFrame(std::string &out, const uint8_t *frame, size_t len) {
+    char head[PUSH_STREAM_HEAD_SIZE];
+    size_t head_len = formatStreamHead(head, sizeof(head), len);
+    TEST_ASSERT_TRUE(head_len > 0);
+    out.append(head, head_len);
+    out.append((const char*)frame, len);
+    out.append("\r\n\r\n");
+}
+
+/// @brief decodes a chunked body, as the ingest server does
+static std::string dechunk(const std::string &in) {
+    std::string body;
+    size_t pos = 0;
+    while(pos < in.size()) {
+        size_t eol = in.find("\r\n", pos);
+        TEST_ASSERT_TRUE(eol != std::string::npos);
+        size_t len = strtoul(in.substr(pos, eol - pos).c_str(), nullptr, 16);
+        pos = eol + 2;
+        TEST_ASSERT_TRUE(pos + len + 2 <= in.size());
+        body.append(in, pos, len);
+        pos += len;
+        TEST_ASSERT_EQUAL_STRING("\r\n", in.substr(pos, 2).c_str());
+        pos += 2;
+    }
+    return body;
+}
+
+void test_stream_framing() {
+    uint8_t big[300];
+    for(size_t i = 0; i < sizeof(big); i++) big[i] = (uint8_t)i;
+
+    std::string stream;
+    writeStreamFrame(stream, jpeg, sizeof(jpeg));
+    writeStreamFrame(stream, big, sizeof(big));
+    // the first chunk: part header, frame and its CRLF
+    TEST_ASSERT_EQUAL(0, stream.compare(0, 4, "50\r\n"));
+
+    std::string part = "--" PUSH_BOUNDARY "\r\nContent-Type: image/jpeg\r\nContent-Length: ";
+    std::string expected = part + "13\r\n\r\n" + std::string((const char*)jpeg, sizeof(jpeg)) + "\r\n" +
+                           part + "300\r\n\r\n" + std::string((const char*)big, sizeof(big)) + "\r\n";
+    std::string body = dechunk(stream);
+    TEST_ASSERT_EQUAL(expected.size(), body.size());
+    TEST_ASSERT_EQUAL_MEMORY(expected.data(), body.data(), expected.size());
+
+    // a head which does not fit is not sent cut
+    char small[16];
+    TEST_ASSERT_EQUAL(0, formatStreamHead(small, sizeof(small), sizeof(jpeg)));
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_drop_oldest);
+    RUN_TEST(test_sending_kept);
+    RUN_TEST(test_oversize);
+    RUN_TEST(test_shared_frame);
+    RUN_TEST(test_requeue);
+    RUN_TEST(test_reset);
+    RUN_TEST(test_stream_framing);
+    return UNITY_END();
+}
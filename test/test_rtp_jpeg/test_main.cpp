@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <unity.h>
+#include "rtp_jpeg.h"
+#include "test_frame.h"
+
+#define FRAME_WIDTH         160
+#define FRAME_HEIGHT        120
+#define FRAME_SCAN_START    623     // after the SOS segment
+#define FRAME_SCAN_LEN      4102    // without the EOI marker
+#define FRAME_SOF_Y_SAMPLING 169    // sampling factors of the Y component in the SOF0 segment
+
+/**
+ * @brief Keeps the packets of the frames for the checks; fails the packets listed in fail_at
+ *
+ */
+class CaptureSink : public RtpSink {
+    public:
+        bool sendPacket(const uint8_t *packet, size_t len) {
+            int index = calls++;
+            if(index == fail_at) return false;
+            packets.push_back(std::vector<uint8_t>(packet, packet + len));
+            return true;
+        }
+        void describe(char *buf, size_t len) {snprintf(buf, len, "capture");}
+
+        std::vector<std::vector<uint8_t>> packets;
+        int calls = 0;
+        int fail_at = -1;
+};
+
+static uint16_t seqOf(const std::vector<uint8_t> &p) {return (p[2] << 8) | p[3];}
+static uint32_t timestampOf(const std::vector<uint8_t> &p) {return ((uint32_t)p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7];}
+static uint32_t ssrcOf(const std::vector<uint8_t> &p) {return ((uint32_t)p[8] << 24) | (p[9] << 16) | (p[10] << 8) | p[11];}
+static uint32_t offsetOf(const std::vector<uint8_t> &p) {return (p[13] << 16) | (p[14] << 8) | p[15];}
+static bool markerOf(const std::vector<uint8_t> &p) {return p[1] & 0x80;}
+
+static const size_t jpeg_header = RTP_HEADER_SIZE + RTP_JPEG_HEADER_SIZE;
+
+void test_parse_baseline() {
+    JpegFrameInfo info;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, RtpJpeg::parse(test_frame, sizeof(test_frame), info));
+    TEST_ASSERT_EQUAL(0, info.type);
+    TEST_ASSERT_EQUAL(FRAME_WIDTH, info.width);
+    TEST_ASSERT_EQUAL(FRAME_HEIGHT, info.height);
+    TEST_ASSERT_NOT_NULL(info.qtables[0]);
+    TEST_ASSERT_NOT_NULL(info.qtables[1]);
+    TEST_ASSERT_EQUAL_PTR(test_frame + FRAME_SCAN_START, info.scan);
+    TEST_ASSERT_EQUAL(FRAME_SCAN_LEN, info.scan_len);
+}
+
+void test_parse_420() {
+    std::vector<uint8_t> frame(test_frame, test_frame + sizeof(test_frame));
+    TEST_ASSERT_EQUAL_HEX8(0x21, frame[FRAME_SOF_Y_SAMPLING]);
+    frame[FRAME_SOF_Y_SAMPLING] = 0x22;
+
+    JpegFrameInfo info;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, RtpJpeg::parse(frame.data(), frame.size(), info));
+    TEST_ASSERT_EQUAL(1, info.type);
+}
+
+void test_parse_rejects() {
+    JpegFrameInfo info;
+    std::vector<uint8_t> frame(test_frame, test_frame + sizeof(test_frame));
+
+    // no SOI
+    TEST_ASSERT_EQUAL(OS_FAIL, RtpJpeg::parse(frame.data() + 2, frame.size() - 2, info));
+    // cut before the scan
+    TEST_ASSERT_EQUAL(OS_FAIL, RtpJpeg::parse(frame.data(), FRAME_SCAN_START - 20, info));
+
+    // restart interval in front of the SOF0 segment
+    static const uint8_t dri[] = {0xFF, 0xDD, 0x00, 0x04, 0x00, 0x10};
+    std::vector<uint8_t> restart(frame);
+    restart.insert(restart.begin() + 2, dri, dri + sizeof(dri));
+    TEST_ASSERT_EQUAL(OS_FAIL, RtpJpeg::parse(restart.data(), restart.size(), info));
+
+    // 16 bit quantization table
+    std::vector<uint8_t> precision(frame);
+    TEST_ASSERT_EQUAL_HEX8(0xDB, precision[21]);
+    precision[24] |= 0x10;
+    TEST_ASSERT_EQUAL(OS_FAIL, RtpJpeg::parse(precision.data(), precision.size(), info));
+}
+
+void test_packets() {
+    JpegFrameInfo info;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, RtpJpeg::parse(test_frame, sizeof(test_frame), info));
+
+    RtpSession session = {};
+    session.seq = 0xFFFE;       // wraps within the frame
+    session.ssrc = 0x12345678;
+    CaptureSink sink;
+    uint32_t ts = RtpJpeg::timestamp(1000000);
+    TEST_ASSERT_EQUAL_UINT32(90000, ts);
+
+    int sent = RtpJpeg::sendFrame(info, ts, session, sink);
+    TEST_ASSERT_EQUAL(4, sent);
+    TEST_ASSERT_EQUAL(4, (int)sink.packets.size());
+    TEST_ASSERT_EQUAL_UINT32(4, session.packets);
+    TEST_ASSERT_EQUAL_UINT32(0, session.errors);
+    TEST_ASSERT_EQUAL_UINT16(2, session.seq);
+
+    std::vector<uint8_t> scan;
+    for(size_t i = 0; i < sink.packets.size(); i++) {
+        const std::vector<uint8_t> &p = sink.packets[i];
+        TEST_ASSERT_TRUE(p.size() <= RTP_MAX_PACKET);
+
+        // RTP header
+        TEST_ASSERT_EQUAL_HEX8(0x80, p[0]);
+        TEST_ASSERT_EQUAL(RTP_PAYLOAD_JPEG, p[1] & 0x7F);
+        TEST_ASSERT_EQUAL(i == sink.packets.size() - 1, markerOf(p));
+        TEST_ASSERT_EQUAL_UINT16((uint16_t)(0xFFFE + i), seqOf(p));
+        TEST_ASSERT_EQUAL_UINT32(ts, timestampOf(p));
+        TEST_ASSERT_EQUAL_HEX32(0x12345678, ssrcOf(p));
+
+        // JPEG header
+        TEST_ASSERT_EQUAL(0, p[12]);
+        TEST_ASSERT_EQUAL_UINT32(scan.size(), offsetOf(p));
+        TEST_ASSERT_EQUAL(0, p[16]);
+        TEST_ASSERT_EQUAL(255, p[17]);
+        TEST_ASSERT_EQUAL(FRAME_WIDTH / 8, p[18]);
+        TEST_ASSERT_EQUAL(FRAME_HEIGHT / 8, p[19]);
+
+        size_t payload = jpeg_header;
+        if(i == 0) {
+            // the tables come with the first fragment only
+            static const uint8_t quant[] = {0, 0, 0, 128};
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(quant, &p[payload], sizeof(quant));
+            payload += RTP_QUANT_HEADER_SIZE;
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(info.qtables[0], &p[payload], 64);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(info.qtables[1], &p[payload + 64], 64);
+            payload += 128;
+            TEST_ASSERT_EQUAL(RTP_MAX_PACKET, p.size());
+        }
+        scan.insert(scan.end(), p.begin() + payload, p.end());
+    }
+
+    TEST_ASSERT_EQUAL(FRAME_SCAN_LEN, scan.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(test_frame + FRAME_SCAN_START, scan.data(), FRAME_SCAN_LEN);
+}
+
+void test_frame_sequence() {
+    JpegFrameInfo info;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, RtpJpeg::parse(test_frame, sizeof(test_frame), info));
+
+    RtpSession session;
+    RtpJpeg::initSession(session);
+    uint16_t first_seq = session.seq;
+    CaptureSink sink;
+
+    // 10 fps
+    RtpJpeg::sendFrame(info, RtpJpeg::timestamp(5000000), session, sink);
+    RtpJpeg::sendFrame(info, RtpJpeg::timestamp(5100000), session, sink);
+    TEST_ASSERT_EQUAL(8, (int)sink.packets.size());
+
+    for(size_t i = 0; i < sink.packets.size(); i++) {
+        TEST_ASSERT_EQUAL_UINT16((uint16_t)(first_seq + i), seqOf(sink.packets[i]));
+        TEST_ASSERT_EQUAL_HEX32(session.ssrc, ssrcOf(sink.packets[i]));
+        TEST_ASSERT_EQUAL(i == 3 || i == 7, markerOf(sink.packets[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT32(9000, timestampOf(sink.packets[4]) - timestampOf(sink.packets[0]));
+    TEST_ASSERT_EQUAL_UINT32(timestampOf(sink.packets[4]), timestampOf(sink.packets[7]));
+}
+
+void test_lost_packet() {
+    JpegFrameInfo info;
+    TEST_ASSERT_EQUAL(OS_SUCCESS, RtpJpeg::parse(test_frame, sizeof(test_frame), info));
+
+    RtpSession session = {};
+    CaptureSink sink;
+    sink.fail_at = 1;
+
+    // the lost packet leaves a gap in the sequence numbers, so the receiver drops the frame
+    TEST_ASSERT_EQUAL(3, RtpJpeg::sendFrame(info, 0, session, sink));
+    TEST_ASSERT_EQUAL_UINT32(1, session.errors);
+    TEST_ASSERT_EQUAL_UINT16(4, session.seq);
+    TEST_ASSERT_EQUAL_UINT16(0, seqOf(sink.packets[0]));
+    TEST_ASSERT_EQUAL_UINT16(2, seqOf(sink.packets[1]));
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_baseline);
+    RUN_TEST(test_parse_420);
+    RUN_TEST(test_parse_rejects);
+    RUN_TEST(test_packets);
+    RUN_TEST(test_frame_sequence);
+    RUN_TEST(test_lost_packet);
+    return UNITY_END();
+}
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <unity.h>
+#include "rtp_tcp.h"
+#include "test_frame.h"
+
+/**
+ * @brief What an RTSP client reads from the interleaved connection
+ *
+ */
+struct Received {
+    std::vector<std::vector<uint8_t>> packets;      // RTP packets, in order
+    std::vector<uint8_t> channels;
+    std::vector<std::string> replies;
+    std::vector<size_t> reply_after;                // number of packets received before each response
+};
+
+// splits the stream as a client does; fails on anything which is neither a whole packet nor a whole response
+static void demux(const std::vector<uint8_t> &stream, Received &rx) {
+    size_t pos = 0;
+    while(pos < stream.size()) {
+        if(stream[pos] == '$') {
+            TEST_ASSERT_TRUE(pos + RTSP_INTERLEAVED_HEADER <= stream.size());
+            size_t len = (stream[pos+2] << 8) | stream[pos+3];
+            TEST_ASSERT_TRUE(pos + RTSP_INTERLEAVED_HEADER + len <= stream.size());
+            TEST_ASSERT_EQUAL_HEX8(0x80, stream[pos + RTSP_INTERLEAVED_HEADER]);
+            rx.channels.push_back(stream[pos+1]);
+            rx.packets.push_back(std::vector<uint8_t>(stream.begin() + pos + RTSP_INTERLEAVED_HEADER,
+                                                      stream.begin() + pos + RTSP_INTERLEAVED_HEADER + len));
+            pos += RTSP_INTERLEAVED_HEADER + len;
+        }
+        else {
+            TEST_ASSERT_TRUE(stream.size() - pos >= 8);
+            TEST_ASSERT_EQUAL(0, memcmp(&stream[pos], "RTSP/1.0", 8));
+            std::string rest(stream.begin() + pos, stream.end());
+            size_t end = rest.find("\r\n\r\n");
+            TEST_ASSERT_TRUE(end != std::string::npos);
+            rx.replies.push_back(rest.substr(0, end + 4));
+            rx.reply_after.push_back(rx.packets.size());
+            pos += end + 4;
+        }
+    }
+}
+
+// reassembles the scan data of the frames; checks the fragment offsets and the sequence numbers on the way
+static std::vector<std::vector<uint8_t>> reassemble(const Received &rx) {
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<uint8_t> scan;
+    for(size_t i = 0; i < rx.packets.size(); i++) {
+        const std::vector<uint8_t> &p = rx.packets[i];
+        if(i > 0) TEST_ASSERT_EQUAL_UINT16(((rx.packets[i-1][2] << 8) | rx.packets[i-1][3]) + 1, (p[2] << 8) | p[3]);
+        size_t offset = (p[13] << 16) | (p[14] << 8) | p[15];
+        TEST_ASSERT_EQUAL(scan.size(), offset);
+        size_t payload = RTP_HEADER_SIZE + RTP_JPEG_HEADER_SIZE + (offset == 0?RTP_QUANT_HEADER_SIZE + 128:0);
+        scan.insert(scan.end(), p.begin() + payload, p.end());
+        if(p[1] & 0x80) {
+            frames.push_back(scan);
+            scan.clear();
+        }
+    }
+    TEST_ASSERT_EQUAL(0, scan.size());
+    return frames;
+}
+
+static JpegFrameInfo frame_info;
+static RtpSession session;
+
+static bool sendFrame(RtpTcpSink &sink, uint32_t timestamp) {
+    if(!sink.beginFrame(frame_info.scan_len)) return false;
+    RtpJpeg::sendFrame(frame_info, timestamp, session, sink);
+    sink.endFrame();
+    return true;
+}
+
+static std::string response(int cseq) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "RTSP/1.0 200 OK\r\nCSeq: %d\r\n\r\n", cseq);
+    return buf;
+}
+
+void test_reply_when_idle() {
+    AsyncClient client;
+    RtpTcpSink sink(&client, 0);
+    TEST_ASSERT_TRUE(sink.isReady());
+
+    std::string r = response(1);
+    TEST_ASSERT_TRUE(sink.queueReply(r.c_str(), r.size()));
+    TEST_ASSERT_EQUAL(r.size(), client.output.size());
+    TEST_ASSERT_EQUAL(0, memcmp(client.output.data(), r.c_str(), r.size()));
+    TEST_ASSERT_EQUAL(0, sink.getStallTime());
+}
+
+void test_reply_between_packets() {
+    AsyncClient client;
+    client.window = 100;            // the first packet is cut by the window
+    RtpTcpSink sink(&client, 0);
+    TEST_ASSERT_TRUE(sendFrame(sink, 1000));
+    TEST_ASSERT_EQUAL(100, client.output.size());
+
+    // a keep-alive answered while the packet is half sent waits for its end
+    std::string r = response(7);
+    TEST_ASSERT_TRUE(sink.queueReply(r.c_str(), r.size()));
+    TEST_ASSERT_EQUAL(100, client.output.size());
+
+    while(client.output.size() < 100000) {
+        size_t before = client.output.size();
+        client.ack(333);
+        sink.drain();
+        if(client.output.size() == before) break;
+    }
+
+    Received rx;
+    demux(client.output, rx);
+    TEST_ASSERT_EQUAL(4, rx.packets.size());
+    TEST_ASSERT_EQUAL(1, rx.replies.size());
+    TEST_ASSERT_EQUAL_STRING(r.c_str(), rx.replies[0].c_str());
+    TEST_ASSERT_EQUAL(1, rx.reply_after[0]);
+
+    std::vector<std::vector<uint8_t>> frames = reassemble(rx);
+    TEST_ASSERT_EQUAL(1, frames.size());
+    TEST_ASSERT_EQUAL(frame_info.scan_len, frames[0].size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame_info.scan, frames[0].data(), frame_info.scan_len);
+}
+
+void test_skip_busy_frame() {
+    AsyncClient client;
+    client.window = 0;
+    RtpTcpSink sink(&client, 0);
+    TEST_ASSERT_TRUE(sendFrame(sink, 0));
+    // the frame has not left yet, the next one is skipped
+    TEST_ASSERT_FALSE(sendFrame(sink, 9000));
+
+    client.ack(100000);
+    sink.drain();
+    TEST_ASSERT_TRUE(sendFrame(sink, 18000));
+
+    Received rx;
+    demux(client.output, rx);
+    TEST_ASSERT_EQUAL(2, reassemble(rx).size());
+}
+
+void test_channel() {
+    AsyncClient client;
+    client.window = 100000;
+    RtpTcpSink sink(&client, 0);
+    TEST_ASSERT_TRUE(sendFrame(sink, 0));
+    // SETUP again with other channels
+    sink.setChannel(2);
+    TEST_ASSERT_TRUE(sendFrame(sink, 9000));
+
+    Received rx;
+    demux(client.output, rx);
+    TEST_ASSERT_EQUAL(8, rx.channels.size());
+    for(size_t i = 0; i < rx.channels.size(); i++)
+        TEST_ASSERT_EQUAL(i < 4?0:2, rx.channels[i]);
+}
+
+void test_stall_time() {
+    AsyncClient client;
+    client.window = 0;
+    RtpTcpSink sink(&client, 0);
+
+    stubMillis() = 1000;
+    TEST_ASSERT_EQUAL(0, sink.getStallTime());
+    TEST_ASSERT_TRUE(sendFrame(sink, 0));
+    stubMillis() = 6000;
+    TEST_ASSERT_EQUAL(5000, sink.getStallTime());
+
+    // the client reads a part of the frame
+    client.ack(1000);
+    sink.drain();
+    TEST_ASSERT_EQUAL(0, sink.getStallTime());
+    stubMillis() = 8000;
+    TEST_ASSERT_EQUAL(2000, sink.getStallTime());
+
+    client.ack(100000);
+    sink.drain();
+    stubMillis() = 100000;
+    TEST_ASSERT_EQUAL(0, sink.getStallTime());
+}
+
+void test_reply_overflow() {
+    AsyncClient client;
+    client.window = 0;
+    RtpTcpSink sink(&client, 0);
+
+    std::string r(RTSP_MAX_RESPONSE - 1, 'x');
+    TEST_ASSERT_TRUE(sink.queueReply(r.c_str(), r.size()));
+    TEST_ASSERT_TRUE(sink.queueReply(r.c_str(), r.size()));
+    TEST_ASSERT_FALSE(sink.queueReply(r.c_str(), r.size()));
+}
+
+void test_stream() {
+    // a player reading a stream of synthetic frames through a window which opens irregularly,
+    // with keep-alive responses coming in between
+    AsyncClient client;
+    client.window = 1500;
+    RtpTcpSink sink(&client, 0);
+    srand(1);
+
+    int frames = 0, replies = 0;
+    for(int tick = 0; tick < 400; tick++) {
+        if(tick % 4 == 0 && sendFrame(sink, tick * 900)) frames++;
+        if(tick % 13 == 0) {
+            std::string r = response(replies++);
+            TEST_ASSERT_TRUE(sink.queueReply(r.c_str(), r.size()));
+        }
+        client.ack(rand() % 3000);
+        sink.drain();
+    }
+    client.ack(1000000);
+    sink.drain();
+
+    Received rx;
+    demux(client.output, rx);
+    TEST_ASSERT_TRUE(frames > 10);
+    TEST_ASSERT_EQUAL(replies, rx.replies.size());
+    for(int i = 0; i < replies; i++)
+        TEST_ASSERT_EQUAL_STRING(response(i).c_str(), rx.replies[i].c_str());
+
+    std::vector<std::vector<uint8_t>> received = reassemble(rx);
+    TEST_ASSERT_EQUAL(frames, received.size());
+    for(size_t i = 0; i < received.size(); i++) {
+        TEST_ASSERT_EQUAL(frame_info.scan_len, received[i].size());
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(frame_info.scan, received[i].data(), frame_info.scan_len);
+    }
+}
+
+void setUp() {
+    RtpJpeg::parse(test_frame, sizeof(test_frame), frame_info);
+    RtpJpeg::initSession(session);
+    stubMillis() = 0;
+}
+
+void tearDown() {}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_reply_when_idle);
+    RUN_TEST(test_reply_between_packets);
+    RUN_TEST(test_skip_busy_frame);
+    RUN_TEST(test_channel);
+    RUN_TEST(test_stall_time);
+    RUN_TEST(test_reply_overflow);
+    RUN_TEST(test_stream);
+    return UNITY_END();
+}
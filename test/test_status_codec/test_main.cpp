@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <unity.h>
+#include <ArduinoJson.h>
+
+#define ENCODE_RUNS         2000
+
+// full /status of a camera with a lamp and two servos, as sent to the web UI
+static const char status_json[] =
+    "{\"cam_name\":\"ESP32 CAM Web Server\",\"code_ver\":\"Jan  7 2023 @ 19:16:55\",\"lamp\":0,\"autolamp\":false,"
+    "\"flashlamp\":0,\"rotate\":0,\"xclk\":8,\"frame_rate\":12,\"framesize\":8,\"quality\":12,\"brightness\":0,"
+    "\"contrast\":0,\"saturation\":0,\"sharpness\":0,\"denoise\":0,\"special_effect\":0,\"wb_mode\":0,\"awb\":1,"
+    "\"awb_gain\":1,\"aec\":1,\"aec2\":0,\"ae_level\":0,\"aec_value\":204,\"agc\":1,\"agc_gain\":0,\"gainceiling\":0,"
+    "\"bpc\":0,\"wpc\":1,\"raw_gma\":1,\"lenc\":1,\"vflip\":0,\"hmirror\":0,\"dcw\":1,\"colorbar\":0,\"cam_pid\":38,"
+    "\"cam_ver\":66,\"debug_mode\":false,\"lamp_gamma\":2.2,\"local_time\":\"2023-01-07 19:20:31\","
+    "\"up_time\":\"0d 00:03:36\",\"rssi\":-61,\"esp_temp\":47.8,\"storage_size\":1024,\"storage_used\":388,"
+    "\"streams\":1,\"pwm\":[{\"pin\":4,\"freq\":50000,\"resolution\":9,\"default\":0,\"fade\":300},"
+    "{\"pin\":14,\"freq\":50,\"resolution\":16,\"default\":4915},{\"pin\":15,\"freq\":50,\"resolution\":16,"
+    "\"default\":4915}]}";
+
+static JsonDocument status;
+static char json_buf[2048];
+static char msgpack_buf[2048];
+
+template<typename F> static double timeEncode(F encode) {
+    auto start = std::chrono::steady_clock::now();
+    size_t total = 0;
+    for(int i = 0; i < ENCODE_RUNS; i++) total += encode();
+    auto end = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(total > 0);
+    return std::chrono::duration<double, std::micro>(end - start).count() / ENCODE_RUNS;
+}
+
+void test_sizes() {
+    size_t json_len = serializeJson(status, json_buf, sizeof(json_buf));
+    size_t msgpack_len = serializeMsgPack(status, msgpack_buf, sizeof(msgpack_buf));
+    TEST_ASSERT_EQUAL(measureJson(status), json_len);
+    TEST_ASSERT_EQUAL(measureMsgPack(status), msgpack_len);
+
+    // the keys are the same; MessagePack saves the quotes, separators and the digits of the numbers
+    TEST_ASSERT_TRUE(msgpack_len < json_len);
+    char msg[96];
+    snprintf(msg, sizeof(msg), "status: JSON %u bytes, MessagePack %u bytes (%.0f%%)", (unsigned)json_len,
+             (unsigned)msgpack_len, msgpack_len * 100.0 / json_len);
+    TEST_MESSAGE(msg);
+}
+
+void test_round_trip() {
+    // a client decoding the MessagePack gets the same document as from the JSON
+    size_t msgpack_len = serializeMsgPack(status, msgpack_buf, sizeof(msgpack_buf));
+    JsonDocument decoded;
+    TEST_ASSERT_TRUE(deserializeMsgPack(decoded, (const char*)msgpack_buf, msgpack_len) == DeserializationError::Ok);
+
+    char decoded_json[sizeof(json_buf)];
+    serializeJson(status, json_buf, sizeof(json_buf));
+    serializeJson(decoded, decoded_json, sizeof(decoded_json));
+    TEST_ASSERT_EQUAL_STRING(json_buf, decoded_json);
+    TEST_ASSERT_EQUAL(3, decoded["pwm"].size());
+    TEST_ASSERT_EQUAL(4915, decoded["pwm"][1]["default"].as<int>());
+}
+
+void test_encode_time() {
+    double json_us = timeEncode([]() {return serializeJson(status, json_buf, sizeof(json_buf));});
+    double msgpack_us = timeEncode([]() {return serializeMsgPack(status, msgpack_buf, sizeof(msgpack_buf));});
+
+    // host timings, only the ratio carries over to the ESP32
+    char msg[96];
+    snprintf(msg, sizeof(msg), "status encode: JSON %.2f us, MessagePack %.2f us (%.0f%%)", json_us, msgpack_us,
+             msgpack_us * 100.0 / json_us);
+    TEST_MESSAGE(msg);
+}
+
+void setUp() {
+    status.clear();
+    TEST_ASSERT_TRUE(deserializeJson(status, status_json) == DeserializationError::Ok);
+}
+
+void tearDown() {}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sizes);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_encode_time);
+    return UNITY_END();
+}